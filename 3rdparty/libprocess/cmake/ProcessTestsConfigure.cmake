@@ -70,7 +70,9 @@ set(PROCESS_TEST_INCLUDE_DIRS
   ${PROCESS_INCLUDE_DIRS}
   ${GMOCK_ROOT}/include
   ${GTEST_SRC}/include
+  ${PROTOBUF_LIB}/include
   src
+  ${CMAKE_BINARY_DIR}/3rdparty/libprocess/src # includes, e.g., metrics.pb.h
   )
 
 # DEFINE THIRD-PARTY LIB INSTALL DIRECTORIES. Used to tell the compiler
@@ -82,6 +84,7 @@ set(PROCESS_TEST_LIB_DIRS
   ${PROCESS_LIB_DIRS}
   ${GMOCK_ROOT}-build/lib/.libs
   ${GMOCK_ROOT}-build/gtest/lib/.libs
+  ${PROTOBUF_LIB}/lib
   )
 
 # DEFINE THIRD-PARTY LIBS. Used to generate flags that the linker uses to
@@ -92,4 +95,5 @@ set(PROCESS_TEST_LIBS
   ${PROCESS_LIBS}
   gmock
   gtest
+  protobuf
   )
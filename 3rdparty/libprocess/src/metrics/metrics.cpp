@@ -15,6 +15,7 @@
 #include <glog/logging.h>
 
 #include <list>
+#include <map>
 #include <string>
 
 #include <process/collect.hpp>
@@ -27,8 +28,12 @@
 
 #include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/strings.hpp>
+
+#include "metrics/metrics.pb.h"
 
 using std::list;
+using std::map;
 using std::string;
 
 namespace process {
@@ -77,7 +82,10 @@ string MetricsProcess::help()
           "amount of time the endpoint will take to respond. If the timeout ",
           "is exceeded, some metrics may not be included in the response.",
           "",
-          "The key is the metric name, and the value is a double-type."));
+          "The key is the metric name, and the value is a double-type.",
+          "",
+          "Requests that accept 'application/x-protobuf' are served a ",
+          "serialized 'process.metrics.Snapshot' message instead of JSON."));
 }
 
 
@@ -159,13 +167,37 @@ list<Future<double> > MetricsProcess::_snapshotTimeout(
 }
 
 
+// Returns true if the request prefers a protobuf response, i.e., if
+// its 'Accept' header lists 'application/x-protobuf' before any
+// 'application/json'.
+static bool acceptsProtobuf(const http::Request& request)
+{
+  Option<string> accept = request.headers.get("Accept");
+
+  if (accept.isSome()) {
+    foreach (const string& range, strings::tokenize(accept.get(), ",")) {
+      // Ignore the parameters of the media range (e.g., 'q=0.5').
+      const string type = strings::trim(strings::split(range, ";")[0]);
+
+      if (type == "application/x-protobuf") {
+        return true;
+      } else if (type == "application/json") {
+        return false;
+      }
+    }
+  }
+
+  return false;
+}
+
+
 Future<http::Response> MetricsProcess::__snapshot(
     const http::Request& request,
     const Option<Duration>& timeout,
     const hashmap<string, Future<double> >& metrics,
     const hashmap<string, Option<Statistics<double> > >& statistics)
 {
-  JSON::Object object;
+  map<string, double> values;
 
   foreachpair (const string& key, const Future<double>& value, metrics) {
     // TODO(dhamon): Maybe add the failure message for this metric to the
@@ -175,24 +207,44 @@ Future<http::Response> MetricsProcess::__snapshot(
       VLOG(1) << "Exceeded timeout of " << timeout.get() << " when attempting "
               << "to get metric '" << key << "'";
     } else if (value.isReady()) {
-      object.values[key] = value.get();
+      values[key] = value.get();
     }
 
     Option<Statistics<double> > statistics_ = statistics.get(key).get();
 
     if (statistics_.isSome()) {
-      object.values[key + "/count"] = statistics_.get().count;
-      object.values[key + "/min"] = statistics_.get().min;
-      object.values[key + "/max"] = statistics_.get().max;
-      object.values[key + "/p50"] = statistics_.get().p50;
-      object.values[key + "/p90"] = statistics_.get().p90;
-      object.values[key + "/p95"] = statistics_.get().p95;
-      object.values[key + "/p99"] = statistics_.get().p99;
-      object.values[key + "/p999"] = statistics_.get().p999;
-      object.values[key + "/p9999"] = statistics_.get().p9999;
+      values[key + "/count"] = statistics_.get().count;
+      values[key + "/min"] = statistics_.get().min;
+      values[key + "/max"] = statistics_.get().max;
+      values[key + "/p50"] = statistics_.get().p50;
+      values[key + "/p90"] = statistics_.get().p90;
+      values[key + "/p95"] = statistics_.get().p95;
+      values[key + "/p99"] = statistics_.get().p99;
+      values[key + "/p999"] = statistics_.get().p999;
+      values[key + "/p9999"] = statistics_.get().p9999;
     }
   }
 
+  if (acceptsProtobuf(request)) {
+    Snapshot snapshot;
+
+    foreachpair (const string& key, double value, values) {
+      Snapshot::Metric* metric = snapshot.add_metrics();
+      metric->set_name(key);
+      metric->set_value(value);
+    }
+
+    http::OK ok(snapshot.SerializeAsString());
+    ok.headers["Content-Type"] = "application/x-protobuf";
+    return ok;
+  }
+
+  JSON::Object object;
+
+  foreachpair (const string& key, double value, values) {
+    object.values[key] = value;
+  }
+
   return http::OK(object, request.query.get("jsonp"));
 }
 
@@ -18,7 +18,9 @@
 #include <string>
 
 #include <stout/duration.hpp>
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
+#include <stout/hashmap.hpp>
 
 #include <process/clock.hpp>
 #include <process/future.hpp>
@@ -33,6 +35,8 @@
 #include <process/metrics/metrics.hpp>
 #include <process/metrics/timer.hpp>
 
+#include "metrics/metrics.pb.h"
+
 using namespace process;
 
 using process::http::BadRequest;
@@ -229,6 +233,62 @@ TEST(MetricsTest, Snapshot)
 }
 
 
+// Ensures that the snapshot is served as a protobuf message to the
+// requests that accept it.
+TEST(MetricsTest, SnapshotProtobuf)
+{
+  ASSERT_TRUE(GTEST_IS_THREADSAFE);
+
+  UPID upid("metrics", process::address());
+
+  Clock::pause();
+
+  Counter counter("test/counter");
+
+  AWAIT_READY(metrics::add(counter));
+
+  counter += 3;
+
+  // Advance the clock to avoid rate limit.
+  Clock::advance(Seconds(1));
+
+  hashmap<string, string> headers;
+  headers["Accept"] = "application/x-protobuf";
+
+  Future<Response> response = http::get(upid, "snapshot", None(), headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(
+      "application/x-protobuf",
+      "Content-Type",
+      response);
+
+  metrics::Snapshot snapshot;
+  ASSERT_TRUE(snapshot.ParseFromString(response.get().body));
+
+  map<string, double> values;
+  foreach (const metrics::Snapshot::Metric& metric, snapshot.metrics()) {
+    values[metric.name()] = metric.value();
+  }
+
+  EXPECT_EQ(1u, values.count("test/counter"));
+  EXPECT_FLOAT_EQ(3.0, values["test/counter"]);
+
+  // Requests that prefer JSON are still served JSON.
+  headers["Accept"] = "application/json, application/x-protobuf";
+
+  // Advance the clock to avoid rate limit.
+  Clock::advance(Seconds(1));
+
+  response = http::get(upid, "snapshot", None(), headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  ASSERT_SOME(JSON::parse<JSON::Object>(response.get().body));
+
+  AWAIT_READY(metrics::remove(counter));
+}
+
+
 TEST(MetricsTest, SnapshotTimeout)
 {
   ASSERT_TRUE(GTEST_IS_THREADSAFE);
@@ -146,6 +146,11 @@ public:
   // offers for those resources the master invokes this callback.
   virtual void reviveOffers(
       const FrameworkID& frameworkId) = 0;
+
+  // Whenever a framework does not want any offers until it revives
+  // them (see above) the master invokes this callback.
+  virtual void suppressOffers(
+      const FrameworkID& frameworkId) = 0;
 };
 
 } // namespace allocator {
@@ -158,6 +158,13 @@ public:
 
   Resources(const Resources& that) : resources(that.resources) {}
 
+  // NOTE: 'RepeatedPtrField' is not movable in the protobuf version
+  // we use, but swapping is cheap and leaves 'that' valid.
+  Resources(Resources&& that)
+  {
+    resources.Swap(&that.resources);
+  }
+
   Resources& operator = (const Resources& that)
   {
     if (this != &that) {
@@ -166,6 +173,14 @@ public:
     return *this;
   }
 
+  Resources& operator = (Resources&& that)
+  {
+    if (this != &that) {
+      resources.Swap(&that.resources);
+    }
+    return *this;
+  }
+
   bool empty() const { return resources.size() == 0; }
 
   // Checks if this Resources is a superset of the given Resources.
@@ -174,25 +189,37 @@ public:
   // Checks if this Resources contains the given Resource.
   bool contains(const Resource& that) const;
 
+  // NOTE: The functions below that return a subset of or otherwise
+  // transform these Resources have an overload for rvalues (e.g.,
+  // temporaries), which works in place rather than copying each
+  // Resource object.
+
   // Filter resources based on the given predicate.
   Resources filter(
-      const lambda::function<bool(const Resource&)>& predicate) const;
+      const lambda::function<bool(const Resource&)>& predicate) const &;
+
+  Resources filter(
+      const lambda::function<bool(const Resource&)>& predicate) &&;
 
   // Returns the reserved resources, by role.
   hashmap<std::string, Resources> reserved() const;
 
   // Returns the reserved resources for the role. Note that the "*"
   // role represents unreserved resources, and will be ignored.
-  Resources reserved(const std::string& role) const;
+  Resources reserved(const std::string& role) const &;
+  Resources reserved(const std::string& role) &&;
 
   // Returns the unreserved resources.
-  Resources unreserved() const;
+  Resources unreserved() const &;
+  Resources unreserved() &&;
 
   // Returns the persistent volumes.
-  Resources persistentVolumes() const;
+  Resources persistentVolumes() const &;
+  Resources persistentVolumes() &&;
 
   // Returns the revocable resources.
-  Resources revocable() const;
+  Resources revocable() const &;
+  Resources revocable() &&;
 
   // Returns a Resources object with the same amount of each resource
   // type as these Resources, but with all Resource objects marked as
@@ -203,7 +230,11 @@ public:
   // 'reservation' field is cleared.
   Resources flatten(
       const std::string& role = "*",
-      const Option<Resource::ReservationInfo>& reservation = None()) const;
+      const Option<Resource::ReservationInfo>& reservation = None()) const &;
+
+  Resources flatten(
+      const std::string& role = "*",
+      const Option<Resource::ReservationInfo>& reservation = None()) &&;
 
   // Finds a Resources object with the same amount of each resource
   // type as "targets" from these Resources. The roles specified in
@@ -249,7 +280,8 @@ public:
   Resources get(const std::string& name) const;
 
   // Get all the resources that are scalars.
-  Resources scalars() const;
+  Resources scalars() const &;
+  Resources scalars() &&;
 
   // Get the set of unique resource names.
   std::set<std::string> names() const;
@@ -297,13 +329,23 @@ public:
   // doing subtraction), the semantics is as though the second operand
   // was actually just an empty resource (as though you didn't do the
   // operation at all).
-  Resources operator + (const Resource& that) const;
-  Resources operator + (const Resources& that) const;
+  //
+  // The overloads for rvalues update the left operand in place (e.g.,
+  // 'a + b + c' only copies 'a') and take over the Resource objects
+  // of the right operand rather than copying them.
+  Resources operator + (const Resource& that) const &;
+  Resources operator + (const Resource& that) &&;
+  Resources operator + (const Resources& that) const &;
+  Resources operator + (const Resources& that) &&;
   Resources& operator += (const Resource& that);
+  Resources& operator += (Resource&& that);
   Resources& operator += (const Resources& that);
+  Resources& operator += (Resources&& that);
 
-  Resources operator - (const Resource& that) const;
-  Resources operator - (const Resources& that) const;
+  Resources operator - (const Resource& that) const &;
+  Resources operator - (const Resource& that) &&;
+  Resources operator - (const Resources& that) const &;
+  Resources operator - (const Resources& that) &&;
   Resources& operator -= (const Resource& that);
   Resources& operator -= (const Resources& that);
 
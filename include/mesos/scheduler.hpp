@@ -273,6 +273,13 @@ public:
   // those filtered slaves.
   virtual Status reviveOffers() = 0;
 
+  // Tells the master to stop sending offers to the framework, e.g.,
+  // when it has no work to do. Offers are sent again once the
+  // framework calls reviveOffers() (or re-registers). Unlike
+  // declining offers with a filter, this does not depend on the
+  // slaves or the duration of the filter.
+  virtual Status suppressOffers() = 0;
+
   // Acknowledges the status update. This should only be called
   // once the status update is processed durably by the scheduler.
   // Not that explicit acknowledgements must be requested via the
@@ -421,6 +428,8 @@ public:
 
   virtual Status reviveOffers();
 
+  virtual Status suppressOffers();
+
   virtual Status acknowledgeStatusUpdate(
       const TaskStatus& status);
 
@@ -27,6 +27,7 @@
 #include <stout/foreach.hpp>
 #include <stout/protobuf.hpp>
 #include <stout/stringify.hpp>
+#include <stout/strings.hpp>
 
 #include "common/attributes.hpp"
 #include "common/http.hpp"
@@ -45,6 +46,27 @@ const char APPLICATION_JSON[] = "application/json";
 const char APPLICATION_PROTOBUF[] = "application/x-protobuf";
 
 
+ContentType negotiate(const process::http::Request& request)
+{
+  Option<string> accept = request.headers.get("Accept");
+
+  if (accept.isSome()) {
+    foreach (const string& range, strings::tokenize(accept.get(), ",")) {
+      // Ignore the parameters of the media range (e.g., 'q=0.5').
+      const string type = strings::trim(strings::split(range, ";")[0]);
+
+      if (type == APPLICATION_PROTOBUF) {
+        return ContentType::PROTOBUF;
+      } else if (type == APPLICATION_JSON) {
+        return ContentType::JSON;
+      }
+    }
+  }
+
+  return ContentType::JSON;
+}
+
+
 // TODO(bmahler): Kill these in favor of automatic Proto->JSON
 // Conversion (when it becomes available).
 
@@ -148,48 +170,7 @@ JSON::Object model(const TaskStatus& status)
 // TODO(bmahler): Expose the executor name / source.
 JSON::Object model(const Task& task)
 {
-  JSON::Object object;
-  object.values["id"] = task.task_id().value();
-  object.values["name"] = task.name();
-  object.values["framework_id"] = task.framework_id().value();
-
-  if (task.has_executor_id()) {
-    object.values["executor_id"] = task.executor_id().value();
-  } else {
-    object.values["executor_id"] = "";
-  }
-
-  object.values["slave_id"] = task.slave_id().value();
-  object.values["state"] = TaskState_Name(task.state());
-  object.values["resources"] = model(task.resources());
-
-  {
-    JSON::Array array;
-    array.values.reserve(task.statuses().size()); // MESOS-2353.
-
-    foreach (const TaskStatus& status, task.statuses()) {
-      array.values.push_back(model(status));
-    }
-    object.values["statuses"] = std::move(array);
-  }
-
-  {
-    JSON::Array array;
-    if (task.has_labels()) {
-      array.values.reserve(task.labels().labels().size()); // MESOS-2353.
-
-      foreach (const Label& label, task.labels().labels()) {
-        array.values.push_back(JSON::Protobuf(label));
-      }
-    }
-    object.values["labels"] = std::move(array);
-  }
-
-  if (task.has_discovery()) {
-    object.values["discovery"] = JSON::Protobuf(task.discovery());
-  }
-
-  return object;
+  return model(task, Projection());
 }
 
 
@@ -304,5 +285,198 @@ JSON::Object model(
 }
 
 
+Projection::Projection(const string& fields)
+  : paths(vector<vector<string>>())
+{
+  foreach (const string& field, strings::tokenize(fields, ",")) {
+    vector<string> path = strings::tokenize(field, ".");
+    if (!path.empty()) {
+      paths.get().push_back(path);
+    }
+  }
+}
+
+
+bool Projection::includes(const string& field) const
+{
+  if (paths.isNone()) {
+    return true;
+  }
+
+  foreach (const vector<string>& path, paths.get()) {
+    if (path.front() == field) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+Projection Projection::nested(const string& field) const
+{
+  if (paths.isNone()) {
+    return *this;
+  }
+
+  Projection projection;
+  projection.paths = vector<vector<string>>();
+
+  foreach (const vector<string>& path, paths.get()) {
+    if (path.front() != field) {
+      continue;
+    }
+
+    // Selecting the field itself selects everything nested in it.
+    if (path.size() == 1) {
+      return Projection();
+    }
+
+    projection.paths.get().push_back(
+        vector<string>(path.begin() + 1, path.end()));
+  }
+
+  return projection;
+}
+
+
+JSON::Object Projection::apply(const JSON::Object& object) const
+{
+  if (paths.isNone()) {
+    return object;
+  }
+
+  JSON::Object result;
+
+  foreachpair (const string& name, const JSON::Value& value, object.values) {
+    if (includes(name)) {
+      result.values[name] = nested(name).apply(value);
+    }
+  }
+
+  return result;
+}
+
+
+JSON::Value Projection::apply(const JSON::Value& value) const
+{
+  if (paths.isNone()) {
+    return value;
+  }
+
+  if (value.is<JSON::Object>()) {
+    return apply(value.as<JSON::Object>());
+  }
+
+  if (value.is<JSON::Array>()) {
+    JSON::Array array;
+    array.values.reserve(value.as<JSON::Array>().values.size());
+
+    foreach (const JSON::Value& element, value.as<JSON::Array>().values) {
+      array.values.push_back(apply(element));
+    }
+
+    return array;
+  }
+
+  return value;
+}
+
+
+JSON::Object Projection::apply(JSON::Object&& object) const
+{
+  if (paths.isNone()) {
+    return std::move(object);
+  }
+
+  return apply(static_cast<const JSON::Object&>(object));
+}
+
+
+JSON::Value Projection::apply(JSON::Value&& value) const
+{
+  if (paths.isNone()) {
+    return std::move(value);
+  }
+
+  return apply(static_cast<const JSON::Value&>(value));
+}
+
+
+JSON::Object model(const Task& task, const Projection& fields)
+{
+  JSON::Object object;
+
+  if (fields.includes("id")) {
+    object.values["id"] = task.task_id().value();
+  }
+
+  if (fields.includes("name")) {
+    object.values["name"] = task.name();
+  }
+
+  if (fields.includes("framework_id")) {
+    object.values["framework_id"] = task.framework_id().value();
+  }
+
+  if (fields.includes("executor_id")) {
+    if (task.has_executor_id()) {
+      object.values["executor_id"] = task.executor_id().value();
+    } else {
+      object.values["executor_id"] = "";
+    }
+  }
+
+  if (fields.includes("slave_id")) {
+    object.values["slave_id"] = task.slave_id().value();
+  }
+
+  if (fields.includes("state")) {
+    object.values["state"] = TaskState_Name(task.state());
+  }
+
+  // The nested fields are projected once they have been modeled.
+  if (fields.includes("resources")) {
+    object.values["resources"] =
+      fields.nested("resources").apply(model(task.resources()));
+  }
+
+  if (fields.includes("statuses")) {
+    JSON::Array array;
+    array.values.reserve(task.statuses().size()); // MESOS-2353.
+
+    const Projection nested = fields.nested("statuses");
+
+    foreach (const TaskStatus& status, task.statuses()) {
+      array.values.push_back(nested.apply(model(status)));
+    }
+    object.values["statuses"] = std::move(array);
+  }
+
+  if (fields.includes("labels")) {
+    JSON::Array array;
+    if (task.has_labels()) {
+      array.values.reserve(task.labels().labels().size()); // MESOS-2353.
+
+      const Projection nested = fields.nested("labels");
+
+      foreach (const Label& label, task.labels().labels()) {
+        array.values.push_back(
+            nested.apply(JSON::Object(JSON::Protobuf(label))));
+      }
+    }
+    object.values["labels"] = std::move(array);
+  }
+
+  if (task.has_discovery() && fields.includes("discovery")) {
+    object.values["discovery"] =
+      fields.nested("discovery").apply(
+          JSON::Object(JSON::Protobuf(task.discovery())));
+  }
+
+  return object;
+}
+
+
 }  // namespace internal {
 }  // namespace mesos {
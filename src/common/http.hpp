@@ -19,12 +19,16 @@
 #ifndef __COMMON_HTTP_HPP__
 #define __COMMON_HTTP_HPP__
 
+#include <string>
 #include <vector>
 
 #include <mesos/mesos.hpp>
 
+#include <process/http.hpp>
+
 #include <stout/hashmap.hpp>
 #include <stout/json.hpp>
+#include <stout/option.hpp>
 
 namespace mesos {
 
@@ -46,6 +50,14 @@ enum class ContentType
   JSON
 };
 
+
+// Returns the content-type to respond to the request with, based on
+// the order of the media types in its 'Accept' header. Defaults to
+// JSON unless 'application/x-protobuf' is accepted before
+// 'application/json'.
+ContentType negotiate(const process::http::Request& request);
+
+
 JSON::Object model(const Resources& resources);
 JSON::Object model(const hashmap<std::string, Resources>& roleResources);
 JSON::Object model(const Attributes& attributes);
@@ -61,6 +73,46 @@ JSON::Object model(
     const TaskState& state,
     const std::vector<TaskStatus>& statuses);
 
+
+// A selection of the (possibly nested) fields of JSON objects, used
+// to only include the fields requested by clients of the HTTP
+// endpoints (e.g., '/master/tasks.json?fields=id,state').
+class Projection
+{
+public:
+  // Selects all fields.
+  Projection() {}
+
+  // Selects the fields in a comma separated list of dot separated
+  // paths, e.g., "id,slaves.hostname".
+  explicit Projection(const std::string& fields);
+
+  // Returns true if the field (or a field nested in it) is selected.
+  bool includes(const std::string& field) const;
+
+  // Returns the selection of the fields nested in 'field'.
+  Projection nested(const std::string& field) const;
+
+  // Returns the selected fields of the object. The projection is
+  // applied to each element of arrays.
+  JSON::Object apply(const JSON::Object& object) const;
+  JSON::Value apply(const JSON::Value& value) const;
+
+  // As above, but moves the object or value if all fields are
+  // selected rather than copying it.
+  JSON::Object apply(JSON::Object&& object) const;
+  JSON::Value apply(JSON::Value&& value) const;
+
+private:
+  // The selected paths, none if all fields are selected.
+  Option<std::vector<std::vector<std::string>>> paths;
+};
+
+
+// Models only the selected fields of the task, so that the fields
+// that are not selected are never modeled.
+JSON::Object model(const Task& task, const Projection& fields);
+
 } // namespace internal {
 } // namespace mesos {
 
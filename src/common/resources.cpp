@@ -20,8 +20,11 @@
 
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <boost/functional/hash.hpp>
+
 #include <glog/logging.h>
 
 #include <mesos/resources.hpp>
@@ -257,6 +260,119 @@ static bool contains(const Resource& left, const Resource& right)
 }
 
 
+// Returns a hash of everything that 'addable' and 'subtractable'
+// compare, i.e., of everything but the value of the resource.
+// Resource objects that can be added or subtracted thus have the same
+// identity hash.
+static size_t identity(const Resource& resource)
+{
+  size_t seed = 0;
+
+  boost::hash_combine(seed, resource.name());
+  boost::hash_combine(seed, resource.type());
+  boost::hash_combine(seed, resource.role());
+
+  boost::hash_combine(seed, resource.has_reservation());
+  if (resource.has_reservation()) {
+    boost::hash_combine(seed, resource.reservation().principal());
+  }
+
+  boost::hash_combine(seed, resource.has_disk());
+  if (resource.has_disk() && resource.disk().has_persistence()) {
+    boost::hash_combine(seed, resource.disk().persistence().id());
+  }
+
+  boost::hash_combine(seed, resource.has_revocable());
+
+  return seed;
+}
+
+
+// For operations on fewer Resource objects than this, a linear scan
+// is cheaper than building an 'IdentityIndex'.
+static const int INDEX_THRESHOLD = 16;
+
+
+// Maps the identity hash of each Resource object in a repeated field
+// to its positions, so that the Resource object that another one can
+// be added to or subtracted from is found without comparing against
+// all of them. This makes arithmetic between two Resources linear
+// rather than quadratic in their sizes.
+//
+// Resource objects are only appended or marked as removed while the
+// index is in use, so positions stay valid until 'compact()'.
+class IdentityIndex
+{
+public:
+  explicit IdentityIndex(google::protobuf::RepeatedPtrField<Resource>* _resources)
+    : resources(_resources),
+      removed(_resources->size(), false)
+  {
+    for (int i = 0; i < resources->size(); i++) {
+      positions[identity(resources->Get(i))].push_back(i);
+    }
+  }
+
+  // Returns the position of the first Resource object that is not
+  // removed and satisfies the predicate with the given one, in the
+  // order they appear in the repeated field. Only Resource objects
+  // with the same identity hash are considered.
+  template <typename Predicate>
+  Option<int> find(const Resource& that, Predicate predicate) const
+  {
+    hashmap<size_t, vector<int>>::const_iterator it =
+      positions.find(identity(that));
+
+    if (it != positions.end()) {
+      foreach (int i, it->second) {
+        if (!removed[i] && predicate(resources->Get(i), that)) {
+          return i;
+        }
+      }
+    }
+
+    return None();
+  }
+
+  void add(const Resource& that)
+  {
+    positions[identity(that)].push_back(resources->size());
+    resources->Add()->CopyFrom(that);
+    removed.push_back(false);
+  }
+
+  // Marks the Resource object as removed, see 'compact()'.
+  void remove(int position)
+  {
+    removed[position] = true;
+  }
+
+  // Deletes the removed Resource objects, keeping the order of the
+  // remaining ones. The index must not be used afterwards.
+  void compact()
+  {
+    int size = 0;
+    for (int i = 0; i < resources->size(); i++) {
+      if (!removed[i]) {
+        if (i != size) {
+          resources->SwapElements(i, size);
+        }
+        size++;
+      }
+    }
+
+    if (size < resources->size()) {
+      resources->DeleteSubrange(size, resources->size() - size);
+    }
+  }
+
+private:
+  google::protobuf::RepeatedPtrField<Resource>* resources;
+  hashmap<size_t, vector<int>> positions;
+  vector<bool> removed;
+};
+
+
 Resource& operator += (Resource& left, const Resource& right)
 {
   if (left.type() == Value::SCALAR) {
@@ -392,7 +508,7 @@ Try<Resources> Resources::parse(
       nameTypes[name] = resource.get().type();
     }
 
-    resources += resource.get();
+    resources += std::move(resource.get());
   }
 
   return resources;
@@ -578,6 +694,72 @@ Resources::Resources(
 
 bool Resources::contains(const Resources& that) const
 {
+  // Resource objects are kept combined, so each Resource object in
+  // 'that' can only be subtracted from a different Resource object
+  // here, unless they are persistent volumes (equal volumes are not
+  // combined). In that case it suffices to check each Resource
+  // object, which avoids copying (and allocating) these Resources.
+  bool volumes = false;
+  foreach (const Resource& resource, that.resources) {
+    if (isPersistentVolume(resource)) {
+      volumes = true;
+      break;
+    }
+  }
+
+  const bool indexed = resources.size() >= INDEX_THRESHOLD &&
+    that.resources.size() >= INDEX_THRESHOLD;
+
+  if (!volumes) {
+    if (!indexed) {
+      foreach (const Resource& resource, that.resources) {
+        if (!_contains(resource)) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    // NOTE: The index is only used to find Resource objects here, so
+    // it does not modify 'resources'.
+    IdentityIndex index(
+        const_cast<google::protobuf::RepeatedPtrField<Resource>*>(
+            &resources));
+
+    foreach (const Resource& resource, that.resources) {
+      if (index.find(resource, mesos::contains).isNone()) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  if (indexed) {
+    google::protobuf::RepeatedPtrField<Resource> remaining = resources;
+    IdentityIndex index(&remaining);
+
+    foreach (const Resource& resource, that.resources) {
+      // NOTE: Like '-=', we subtract from the first subtractable
+      // Resource object, so that is the one that has to contain it.
+      Option<int> position = index.find(resource, subtractable);
+      if (position.isNone() ||
+          !mesos::contains(remaining.Get(position.get()), resource)) {
+        return false;
+      }
+
+      Resource* left = remaining.Mutable(position.get());
+      *left -= resource;
+
+      if (validate(*left).isSome() || isEmpty(*left)) {
+        index.remove(position.get());
+      }
+    }
+
+    return true;
+  }
+
   Resources remaining = *this;
 
   foreach (const Resource& resource, that.resources) {
@@ -605,7 +787,7 @@ bool Resources::contains(const Resource& that) const
 
 
 Resources Resources::filter(
-    const lambda::function<bool(const Resource&)>& predicate) const
+    const lambda::function<bool(const Resource&)>& predicate) const &
 {
   Resources result;
   foreach (const Resource& resource, resources) {
@@ -617,6 +799,29 @@ Resources Resources::filter(
 }
 
 
+Resources Resources::filter(
+    const lambda::function<bool(const Resource&)>& predicate) &&
+{
+  // NOTE: A subset of valid and combined Resource objects is valid
+  // and combined, so we only need to drop the others (in order).
+  int size = 0;
+  for (int i = 0; i < resources.size(); i++) {
+    if (predicate(resources.Get(i))) {
+      if (i != size) {
+        resources.SwapElements(i, size);
+      }
+      size++;
+    }
+  }
+
+  if (size < resources.size()) {
+    resources.DeleteSubrange(size, resources.size() - size);
+  }
+
+  return std::move(*this);
+}
+
+
 hashmap<string, Resources> Resources::reserved() const
 {
   hashmap<string, Resources> result;
@@ -631,44 +836,78 @@ hashmap<string, Resources> Resources::reserved() const
 }
 
 
-Resources Resources::reserved(const string& role) const
+Resources Resources::reserved(const string& role) const &
 {
   return filter(lambda::bind(isReserved, lambda::_1, role));
 }
 
 
-Resources Resources::unreserved() const
+Resources Resources::reserved(const string& role) &&
+{
+  return std::move(*this).filter(lambda::bind(isReserved, lambda::_1, role));
+}
+
+
+Resources Resources::unreserved() const &
 {
   return filter(isUnreserved);
 }
 
 
-Resources Resources::persistentVolumes() const
+Resources Resources::unreserved() &&
+{
+  return std::move(*this).filter(isUnreserved);
+}
+
+
+Resources Resources::persistentVolumes() const &
 {
   return filter(isPersistentVolume);
 }
 
 
-Resources Resources::revocable() const
+Resources Resources::persistentVolumes() &&
+{
+  return std::move(*this).filter(isPersistentVolume);
+}
+
+
+Resources Resources::revocable() const &
 {
   return filter(isRevocable);
 }
 
 
+Resources Resources::revocable() &&
+{
+  return std::move(*this).filter(isRevocable);
+}
+
+
 Resources Resources::flatten(
     const string& role,
-    const Option<Resource::ReservationInfo>& reservation) const
+    const Option<Resource::ReservationInfo>& reservation) const &
+{
+  return Resources(*this).flatten(role, reservation);
+}
+
+
+Resources Resources::flatten(
+    const string& role,
+    const Option<Resource::ReservationInfo>& reservation) &&
 {
   Resources flattened;
 
-  foreach (Resource resource, resources) {
+  // NOTE: Flattened Resource objects may become addable, so we need
+  // to combine them again rather than flattening in place.
+  foreach (Resource& resource, resources) {
     resource.set_role(role);
     if (reservation.isNone()) {
       resource.clear_reservation();
     } else {
       resource.mutable_reservation()->CopyFrom(reservation.get());
     }
-    flattened += resource;
+    flattened += std::move(resource);
   }
 
   return flattened;
@@ -949,11 +1188,22 @@ Resources Resources::get(const string& name) const
 }
 
 
-Resources Resources::scalars() const
+// Tests if the given Resource object is a scalar.
+static bool isScalar(const Resource& resource)
 {
-  return filter([=](const Resource& resource) {
-    return resource.type() == Value::SCALAR;
-  });
+  return resource.type() == Value::SCALAR;
+}
+
+
+Resources Resources::scalars() const &
+{
+  return filter(isScalar);
+}
+
+
+Resources Resources::scalars() &&
+{
+  return std::move(*this).filter(isScalar);
 }
 
 
@@ -1069,7 +1319,7 @@ bool Resources::operator != (const Resources& that) const
 }
 
 
-Resources Resources::operator + (const Resource& that) const
+Resources Resources::operator + (const Resource& that) const &
 {
   Resources result = *this;
   result += that;
@@ -1077,7 +1327,14 @@ Resources Resources::operator + (const Resource& that) const
 }
 
 
-Resources Resources::operator + (const Resources& that) const
+Resources Resources::operator + (const Resource& that) &&
+{
+  *this += that;
+  return std::move(*this);
+}
+
+
+Resources Resources::operator + (const Resources& that) const &
 {
   Resources result = *this;
   result += that;
@@ -1085,6 +1342,13 @@ Resources Resources::operator + (const Resources& that) const
 }
 
 
+Resources Resources::operator + (const Resources& that) &&
+{
+  *this += that;
+  return std::move(*this);
+}
+
+
 Resources& Resources::operator += (const Resource& that)
 {
   if (validate(that).isNone() && !isEmpty(that)) {
@@ -1107,17 +1371,82 @@ Resources& Resources::operator += (const Resource& that)
 }
 
 
+Resources& Resources::operator += (Resource&& that)
+{
+  if (validate(that).isNone() && !isEmpty(that)) {
+    foreach (Resource& resource, resources) {
+      if (addable(resource, that)) {
+        resource += that;
+        return *this;
+      }
+    }
+
+    // Cannot be combined with any existing Resource object, so we
+    // take it over rather than copying it.
+    resources.Add()->Swap(&that);
+  }
+
+  return *this;
+}
+
+
 Resources& Resources::operator += (const Resources& that)
 {
+  // NOTE: Unlike for subtraction, we need the index if only 'that' is
+  // large, since these Resources grow as it gets added.
+  if (that.resources.size() < INDEX_THRESHOLD || this == &that) {
+    foreach (const Resource& resource, that.resources) {
+      *this += resource;
+    }
+
+    return *this;
+  }
+
+  // Same as adding each Resource object, but the one to add it to is
+  // looked up by identity rather than by scanning.
+  IdentityIndex index(&resources);
+
   foreach (const Resource& resource, that.resources) {
-    *this += resource;
+    if (validate(resource).isNone() && !isEmpty(resource)) {
+      Option<int> position = index.find(resource, addable);
+      if (position.isSome()) {
+        *resources.Mutable(position.get()) += resource;
+      } else {
+        index.add(resource);
+      }
+    }
+  }
+
+  return *this;
+}
+
+
+Resources& Resources::operator += (Resources&& that)
+{
+  if (this == &that) {
+    return *this += static_cast<const Resources&>(that);
+  }
+
+  // NOTE: Resources are always valid and combined, so we can take
+  // them over as a whole when we are empty (e.g., when summing up).
+  if (empty()) {
+    resources.Swap(&that.resources);
+    return *this;
+  }
+
+  if (that.resources.size() >= INDEX_THRESHOLD) {
+    return *this += static_cast<const Resources&>(that);
+  }
+
+  foreach (Resource& resource, that.resources) {
+    *this += std::move(resource);
   }
 
   return *this;
 }
 
 
-Resources Resources::operator - (const Resource& that) const
+Resources Resources::operator - (const Resource& that) const &
 {
   Resources result = *this;
   result -= that;
@@ -1125,7 +1454,14 @@ Resources Resources::operator - (const Resource& that) const
 }
 
 
-Resources Resources::operator - (const Resources& that) const
+Resources Resources::operator - (const Resource& that) &&
+{
+  *this -= that;
+  return std::move(*this);
+}
+
+
+Resources Resources::operator - (const Resources& that) const &
 {
   Resources result = *this;
   result -= that;
@@ -1133,6 +1469,13 @@ Resources Resources::operator - (const Resources& that) const
 }
 
 
+Resources Resources::operator - (const Resources& that) &&
+{
+  *this -= that;
+  return std::move(*this);
+}
+
+
 Resources& Resources::operator -= (const Resource& that)
 {
   if (validate(that).isNone() && !isEmpty(that)) {
@@ -1160,10 +1503,38 @@ Resources& Resources::operator -= (const Resource& that)
 
 Resources& Resources::operator -= (const Resources& that)
 {
+  if (resources.size() < INDEX_THRESHOLD ||
+      that.resources.size() < INDEX_THRESHOLD ||
+      this == &that) {
+    foreach (const Resource& resource, that.resources) {
+      *this -= resource;
+    }
+
+    return *this;
+  }
+
+  // Same as subtracting each Resource object, but the one to
+  // subtract it from is looked up by identity rather than by
+  // scanning. Resource objects that become invalid or zero are
+  // removed at the end, which keeps positions in the index valid.
+  IdentityIndex index(&resources);
+
   foreach (const Resource& resource, that.resources) {
-    *this -= resource;
+    if (validate(resource).isNone() && !isEmpty(resource)) {
+      Option<int> position = index.find(resource, subtractable);
+      if (position.isSome()) {
+        Resource* left = resources.Mutable(position.get());
+        *left -= resource;
+
+        if (validate(*left).isSome() || isEmpty(*left)) {
+          index.remove(position.get());
+        }
+      }
+    }
   }
 
+  index.compact();
+
   return *this;
 }
 
@@ -19,6 +19,7 @@
 #include <stdint.h>
 
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include <glog/logging.h>
@@ -30,10 +31,9 @@
 
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
+#include <stout/interval.hpp>
 #include <stout/strings.hpp>
 
-using std::max;
-using std::min;
 using std::ostream;
 using std::string;
 using std::vector;
@@ -179,115 +179,74 @@ Value::Scalar& operator -= (Value::Scalar& left, const Value::Scalar& right)
   return left;
 }
 
-namespace ranges {
 
-static void add(Value::Ranges* result, int64_t begin, int64_t end)
+// The largest value of a range.
+static const uint64_t RANGE_MAX = std::numeric_limits<uint64_t>::max();
+
+
+// The values of 'Value::Ranges' as an interval set. The intervals
+// of the set are right-open, so a range ending at the largest value
+// ('RANGE_MAX') cannot be stored with its exclusive upper bound, which
+// would overflow. Instead that value is tracked by 'max'.
+struct RangeSet
 {
-  if (begin > end) {
-    return;
-  }
-  Value::Range* range = result->add_range();
-  range->set_begin(begin);
-  range->set_end(end);
-}
+  RangeSet() : max(false) {}
 
-} // namespace ranges {
+  IntervalSet<uint64_t> intervals;
+  bool max; // Whether 'RANGE_MAX' is included.
+};
 
 
-// Coalesce the given 'range' into already coalesced 'ranges'.
-static void coalesce(Value::Ranges* ranges, const Value::Range& range)
+// Converts the (possibly un-coalesced) 'ranges' into a range set,
+// which coalesces overlapping and adjacent ranges as they are added.
+// Each insertion is logarithmic in the number of intervals, so
+// arithmetic on ranges is O(n log n) rather than quadratic.
+static RangeSet intervals(const Value::Ranges& ranges)
 {
-  // Note that we assume that ranges has already been coalesced.
+  RangeSet set;
 
-  Value::Ranges result;
-  Value::Range temp = range;
-
-  for (int i = 0; i < ranges->range_size(); i++) {
-    const Value::Range& current = ranges->range(i);
-
-    // Check if current and range overlap. Note, we only need to
-    // compare with range and not with temp to check for overlap
-    // because we expect ranges to be coalesced to begin with!
-    if (current.begin() <= range.end() + 1 &&
-        current.end() >= range.begin() - 1) {
-      // current:   |   |
-      // range:       |   |
-      // range:   |   |
-      // Update temp with new boundaries.
-      temp.set_begin(min(temp.begin(), min(range.begin(), current.begin())));
-      temp.set_end(max(temp.end(), max(range.end(), current.end())));
-    } else { // No overlap.
-      result.add_range()->MergeFrom(current);
+  for (int i = 0; i < ranges.range_size(); i++) {
+    const Value::Range& range = ranges.range(i);
+
+    if (range.end() == RANGE_MAX) {
+      set.max = true;
+      set.intervals += (Bound<uint64_t>::closed(range.begin()),
+                        Bound<uint64_t>::open(RANGE_MAX));
+    } else {
+      set.intervals += (Bound<uint64_t>::closed(range.begin()),
+                        Bound<uint64_t>::closed(range.end()));
     }
   }
 
-  result.add_range()->MergeFrom(temp);
-  *ranges = result;
+  return set;
 }
 
 
-// Coalesce the given un-coalesced 'uranges' into already coalesced 'ranges'.
-static void coalesce(Value::Ranges* ranges, const Value::Ranges& uranges)
+// Converts the range set back into coalesced 'Value::Ranges',
+// ordered by their beginning.
+static Value::Ranges ranges(const RangeSet& set)
 {
-  // Note that we assume that ranges has already been coalesced.
+  Value::Ranges result;
 
-  for (int i = 0; i < uranges.range_size(); i++) {
-    coalesce(ranges, uranges.range(i));
+  foreach (const Interval<uint64_t>& interval, set.intervals) {
+    Value::Range* range = result.add_range();
+    range->set_begin(interval.lower());
+    range->set_end(interval.upper() - 1); // Upper bound is exclusive.
   }
-}
-
-
-static void remove(Value::Ranges* ranges, const Value::Range& range)
-{
-  // Note that we assume that ranges has already been coalesced.
 
-  Value::Ranges result;
-
-  for (int i = 0; i < ranges->range_size(); i++) {
-    const Value::Range& current = ranges->range(i);
-
-    // Note that these if/else if conditionals are in a particular
-    // order. In particular, the last two assume that the "subsumes"
-    // checks have already occurred.
-    if (range.begin() <= current.begin() && range.end() >= current.end()) {
-      // Range subsumes current.
-      // current:  |     |
-      // range:  |         |
-      // range:  |       |
-      // range:    |       |
-      // range:    |     |
-    } else if (range.begin() >= current.begin() &&
-               range.end() <= current.end()) {
-      // Range is subsumed by current.
-      // current:  |     |
-      // range:      | |
-      // range:    |   |
-      // range:      |   |
-      ranges::add(&result, current.begin(), range.begin() - 1);
-      ranges::add(&result, range.end() + 1, current.end());
-    } else if (range.begin() <= current.begin() &&
-               range.end() >= current.begin()) {
-      // Range overlaps to the left.
-      // current:  |     |
-      // range:  |     |
-      // range:  | |
-      ranges::add(&result, range.end() + 1, current.end());
-    } else if (range.begin() <= current.end() && range.end() >= current.end()) {
-      // Range overlaps to the right.
-      // current:  |     |
-      // range:      |      |
-      // range:          |  |
-      ranges::add(&result, current.begin(), range.begin() - 1);
+  if (set.max) {
+    // Extend the last range if it is adjacent to 'RANGE_MAX'.
+    int last = result.range_size() - 1;
+    if (last >= 0 && result.range(last).end() == RANGE_MAX - 1) {
+      result.mutable_range(last)->set_end(RANGE_MAX);
     } else {
-      // Range doesn't overlap current.
-      // current:        |   |
-      // range:   |   |
-      // range:                |   |
-      ranges::add(&result, current.begin(), current.end());
+      Value::Range* range = result.add_range();
+      range->set_begin(RANGE_MAX);
+      range->set_end(RANGE_MAX);
     }
   }
 
-  *ranges = result;
+  return result;
 }
 
 
@@ -305,118 +264,59 @@ ostream& operator << (ostream& stream, const Value::Ranges& ranges)
 }
 
 
-bool operator == (const Value::Ranges& _left, const Value::Ranges& _right)
+bool operator == (const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges left;
-  coalesce(&left, _left);
-
-  Value::Ranges right;
-  coalesce(&right, _right);
-
-  if (left.range_size() == right.range_size()) {
-    for (int i = 0; i < left.range_size(); i++) {
-      // Make sure this range is equal to a range in the right.
-      bool found = false;
-      for (int j = 0; j < right.range_size(); j++) {
-        if (left.range(i).begin() == right.range(j).begin() &&
-            left.range(i).end() == right.range(j).end()) {
-          found = true;
-          break;
-        }
-      }
-
-      if (!found) {
-        return false;
-      }
-    }
+  const RangeSet left_ = intervals(left);
+  const RangeSet right_ = intervals(right);
 
-    return true;
-  }
-
-  return false;
+  return left_.max == right_.max && left_.intervals == right_.intervals;
 }
 
 
-bool operator <= (const Value::Ranges& _left, const Value::Ranges& _right)
+bool operator <= (const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges left;
-  coalesce(&left, _left);
-
-  Value::Ranges right;
-  coalesce(&right, _right);
-
-  for (int i = 0; i < left.range_size(); i++) {
-    // Make sure this range is a subset of a range in right.
-    bool matched = false;
-    for (int j = 0; j < right.range_size(); j++) {
-      if (left.range(i).begin() >= right.range(j).begin() &&
-          left.range(i).end() <= right.range(j).end()) {
-        matched = true;
-        break;
-      }
-    }
-    if (!matched) {
-      return false;
-    }
-  }
+  const RangeSet left_ = intervals(left);
+  const RangeSet right_ = intervals(right);
 
-  return true;
+  return (!left_.max || right_.max) &&
+    right_.intervals.contains(left_.intervals);
 }
 
 
 Value::Ranges operator + (const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges result;
+  RangeSet result = intervals(left);
+  const RangeSet right_ = intervals(right);
 
-  coalesce(&result, left);
-  coalesce(&result, right);
+  result.intervals += right_.intervals;
+  result.max = result.max || right_.max;
 
-  return result;
+  return ranges(result);
 }
 
 
 Value::Ranges operator - (const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges result;
-
-  coalesce(&result, left);
-  coalesce(&result, right);
+  RangeSet result = intervals(left);
+  const RangeSet right_ = intervals(right);
 
-  for (int i = 0; i < right.range_size(); i++) {
-    remove(&result, right.range(i));
-  }
+  result.intervals -= right_.intervals;
+  result.max = result.max && !right_.max;
 
-  return result;
+  return ranges(result);
 }
 
 
 Value::Ranges& operator += (Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges temp;
-
-  coalesce(&temp, left);
-
-  left = temp;
-
-  coalesce(&left, right);
-
+  left = left + right;
   return left;
 }
 
 
 Value::Ranges& operator -= (Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges temp;
-
-  coalesce(&temp, left);
-  coalesce(&temp, right);
-
-  left = temp;
-
-  for (int i = 0; i < right.range_size(); i++) {
-    remove(&left, right.range(i));
-  }
-
+  left = left - right;
   return left;
 }
 
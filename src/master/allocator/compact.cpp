@@ -0,0 +1,444 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include <boost/functional/hash.hpp>
+
+#include <glog/logging.h>
+
+#include <stout/foreach.hpp>
+
+#include "master/allocator/compact.hpp"
+
+using std::ostream;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+// Tests if the two scalar resources only differ by their value, i.e.,
+// compares everything that 'addable()' in common/resources.cpp looks
+// at for scalars that are not persistent volumes.
+static bool identical(const Resource& left, const Resource& right)
+{
+  if (left.name() != right.name() || left.role() != right.role()) {
+    return false;
+  }
+
+  if (left.has_reservation() != right.has_reservation()) {
+    return false;
+  }
+
+  if (left.has_reservation() &&
+      left.reservation().principal() != right.reservation().principal()) {
+    return false;
+  }
+
+  return left.has_disk() == right.has_disk() &&
+         left.has_revocable() == right.has_revocable();
+}
+
+
+size_t CompactResources::Index::slot(const Resource& resource)
+{
+  CHECK_EQ(Value::SCALAR, resource.type());
+  CHECK(!Resources::isPersistentVolume(resource));
+
+  // We hash the fields that 'identical()' compares rather than
+  // building a key from them, since this is called for every scalar
+  // resource that gets converted.
+  size_t hash = 0;
+  boost::hash_combine(hash, resource.name());
+  boost::hash_combine(hash, resource.role());
+  boost::hash_combine(hash, resource.has_reservation());
+  if (resource.has_reservation()) {
+    boost::hash_combine(hash, resource.reservation().principal());
+  }
+  boost::hash_combine(hash, resource.has_disk());
+  boost::hash_combine(hash, resource.has_revocable());
+
+  std::vector<size_t>& bucket = slots[hash];
+
+  foreach (size_t slot, bucket) {
+    if (identical(entries[slot].prototype, resource)) {
+      return slot;
+    }
+  }
+
+  Slot entry;
+  entry.prototype.CopyFrom(resource);
+  entry.prototype.mutable_scalar()->set_value(0);
+  entry.name = name(resource.name());
+  entry.unreserved = Resources::isUnreserved(resource);
+  entry.revocable = Resources::isRevocable(resource);
+
+  entries.push_back(entry);
+  bucket.push_back(entries.size() - 1);
+
+  return entries.size() - 1;
+}
+
+
+size_t CompactResources::Index::name(const string& name)
+{
+  Option<size_t> id = ids.get(name);
+  if (id.isSome()) {
+    return id.get();
+  }
+
+  const size_t size = ids.size();
+  ids[name] = size;
+  return size;
+}
+
+
+CompactResources::CompactResources(Index* _index, const Resources& resources)
+  : index(CHECK_NOTNULL(_index))
+{
+  foreach (const Resource& resource, resources) {
+    if (resource.type() != Value::SCALAR ||
+        Resources::isPersistentVolume(resource)) {
+      others += resource;
+      continue;
+    }
+
+    // NOTE: 'Resources' combines addable resources, so each slot
+    // appears at most once here.
+    scalars.push_back(std::make_pair(
+        index->slot(resource),
+        resource.scalar().value()));
+  }
+
+  std::sort(scalars.begin(), scalars.end());
+}
+
+
+Resources CompactResources::resources() const
+{
+  Resources result = others;
+
+  foreach (const Scalars::value_type& scalar, scalars) {
+    Resource resource = index->entries[scalar.first].prototype;
+    resource.mutable_scalar()->set_value(scalar.second);
+    result += resource;
+  }
+
+  return result;
+}
+
+
+bool CompactResources::contains(const CompactResources& that) const
+{
+  Scalars::const_iterator it = scalars.begin();
+
+  foreach (const Scalars::value_type& scalar, that.scalars) {
+    while (it != scalars.end() && it->first < scalar.first) {
+      ++it;
+    }
+
+    if (it == scalars.end() ||
+        it->first != scalar.first ||
+        it->second < scalar.second) {
+      return false;
+    }
+  }
+
+  return others.contains(that.others);
+}
+
+
+template <typename Predicate>
+CompactResources CompactResources::filter(
+    Predicate predicate,
+    const Resources& others) const
+{
+  CompactResources result;
+  result.index = index;
+  result.others = others;
+
+  foreach (const Scalars::value_type& scalar, scalars) {
+    if (predicate(index->entries[scalar.first])) {
+      result.scalars.push_back(scalar);
+    }
+  }
+
+  return result;
+}
+
+
+CompactResources CompactResources::unreserved() const
+{
+  return filter(
+      [](const Index::Slot& slot) { return slot.unreserved; },
+      others.unreserved());
+}
+
+
+CompactResources CompactResources::reserved(const string& role) const
+{
+  return filter(
+      [&role](const Index::Slot& slot) {
+        return !slot.unreserved && slot.prototype.role() == role;
+      },
+      others.reserved(role));
+}
+
+
+CompactResources CompactResources::revocable() const
+{
+  return filter(
+      [](const Index::Slot& slot) { return slot.revocable; },
+      others.revocable());
+}
+
+
+Option<double> CompactResources::get(const string& name) const
+{
+  double total = 0;
+  bool found = false;
+
+  foreach (const Scalars::value_type& scalar, scalars) {
+    if (index->entries[scalar.first].prototype.name() == name) {
+      total += scalar.second;
+      found = true;
+    }
+  }
+
+  foreach (const Resource& resource, others) {
+    if (resource.name() == name && resource.type() == Value::SCALAR) {
+      total += resource.scalar().value();
+      found = true;
+    }
+  }
+
+  if (found) {
+    return total;
+  }
+
+  return None();
+}
+
+
+Option<double> CompactResources::cpus() const
+{
+  return get("cpus");
+}
+
+
+Option<Bytes> CompactResources::mem() const
+{
+  Option<double> value = get("mem");
+  if (value.isSome()) {
+    return Megabytes(static_cast<uint64_t>(value.get()));
+  } else {
+    return None();
+  }
+}
+
+
+// Adds 'value' to the quantity of the resource name with the given
+// id, see 'CompactResources::sum()'.
+static void add(vector<double>* quantities, size_t name, double value)
+{
+  if (name >= quantities->size()) {
+    quantities->resize(name + 1, 0.0);
+  }
+
+  (*quantities)[name] += value;
+}
+
+
+// Adds the quantities of the scalar resources that are kept as
+// 'Resources' (i.e., persistent volumes), multiplied by 'factor'.
+static void add(
+    vector<double>* quantities,
+    CompactResources::Index* index,
+    const Resources& resources,
+    double factor)
+{
+  foreach (const Resource& resource, resources) {
+    if (resource.type() != Value::SCALAR) {
+      continue;
+    }
+
+    CHECK_NOTNULL(index);
+
+    add(quantities, index->name(resource.name()),
+        factor * resource.scalar().value());
+  }
+}
+
+
+void CompactResources::sum(vector<double>* quantities) const
+{
+  foreach (const Scalars::value_type& scalar, scalars) {
+    add(quantities, index->entries[scalar.first].name, scalar.second);
+  }
+
+  // Persistent volumes are kept as 'Resources' but still count.
+  add(quantities, index, others, 1.0);
+}
+
+
+bool CompactResources::operator == (const CompactResources& that) const
+{
+  return scalars == that.scalars && others == that.others;
+}
+
+
+bool CompactResources::operator != (const CompactResources& that) const
+{
+  return !(*this == that);
+}
+
+
+CompactResources CompactResources::operator + (
+    const CompactResources& that) const
+{
+  CompactResources result = *this;
+  result += that;
+  return result;
+}
+
+
+CompactResources CompactResources::operator - (
+    const CompactResources& that) const
+{
+  CompactResources result = *this;
+  result -= that;
+  return result;
+}
+
+
+CompactResources& CompactResources::operator += (const CompactResources& that)
+{
+  adopt(that);
+
+  if (!that.scalars.empty()) {
+    Scalars result;
+    result.reserve(scalars.size() + that.scalars.size());
+
+    Scalars::const_iterator left = scalars.begin();
+    Scalars::const_iterator right = that.scalars.begin();
+
+    while (left != scalars.end() || right != that.scalars.end()) {
+      if (right == that.scalars.end() ||
+          (left != scalars.end() && left->first < right->first)) {
+        result.push_back(*left++);
+      } else if (left == scalars.end() || right->first < left->first) {
+        result.push_back(*right++);
+      } else {
+        result.push_back(
+            std::make_pair(left->first, left->second + right->second));
+        ++left;
+        ++right;
+      }
+    }
+
+    scalars.swap(result);
+  }
+
+  others += that.others;
+
+  return *this;
+}
+
+
+CompactResources& CompactResources::operator -= (const CompactResources& that)
+{
+  subtract(that, NULL);
+  return *this;
+}
+
+
+void CompactResources::subtract(
+    const CompactResources& that,
+    vector<double>* quantities)
+{
+  adopt(that);
+
+  if (!scalars.empty() && !that.scalars.empty()) {
+    Scalars::iterator out = scalars.begin();
+    Scalars::const_iterator right = that.scalars.begin();
+
+    for (Scalars::iterator left = scalars.begin();
+         left != scalars.end();
+         ++left) {
+      while (right != that.scalars.end() && right->first < left->first) {
+        ++right;
+      }
+
+      double value = left->second;
+      if (right != that.scalars.end() && right->first == left->first) {
+        value -= right->second;
+      }
+
+      // Like 'Resources', we drop scalars that become zero or
+      // negative.
+      if (value < 0) {
+        value = 0;
+      }
+
+      if (quantities != NULL && value != left->second) {
+        add(quantities,
+            index->entries[left->first].name,
+            value - left->second);
+      }
+
+      if (value > 0) {
+        *out++ = std::make_pair(left->first, value);
+      }
+    }
+
+    scalars.erase(out, scalars.end());
+  }
+
+  if (quantities != NULL && !others.empty() && !that.others.empty()) {
+    add(quantities, index, others, -1.0);
+    others -= that.others;
+    add(quantities, index, others, 1.0);
+  } else {
+    others -= that.others;
+  }
+}
+
+
+void CompactResources::adopt(const CompactResources& that)
+{
+  if (index == NULL) {
+    index = that.index;
+  }
+
+  CHECK(that.index == NULL || index == that.index)
+    << "Cannot combine resources from different indexes";
+}
+
+
+ostream& operator << (ostream& stream, const CompactResources& resources)
+{
+  return stream << resources.resources();
+}
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
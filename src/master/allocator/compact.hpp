@@ -0,0 +1,168 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MASTER_ALLOCATOR_COMPACT_HPP__
+#define __MASTER_ALLOCATOR_COMPACT_HPP__
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mesos/resources.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/option.hpp>
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+// An internal representation of 'Resources' for the allocator and
+// the sorters, which do a lot of arithmetic on resources.
+//
+// Scalar resources are stored as (slot, value) pairs, where a slot
+// identifies everything about a scalar resource but its value (i.e.,
+// the name, role, reservation, disk and revocable info). Arithmetic
+// on scalars is thus arithmetic on doubles rather than on protobufs.
+// All other resources (e.g., ranges, sets and persistent volumes,
+// which can not be combined) are kept as 'Resources'.
+//
+// The semantics are those of 'Resources', e.g., subtracting
+// resources that are not present is a no-op and scalars never become
+// negative. We convert from and to 'Resources' only at the boundary
+// of the allocator, see 'CompactResources(Index*, const Resources&)'
+// and 'resources()'.
+class CompactResources
+{
+public:
+  // Assigns slots to scalar resources. All CompactResources that are
+  // combined with each other must use the same index, which has to
+  // outlive them.
+  //
+  // NOTE: The index grows as new kinds of resources are seen, it is
+  // not safe to use concurrently.
+  class Index
+  {
+  public:
+    // Returns the slot of the scalar resource, which must not be a
+    // persistent volume.
+    size_t slot(const Resource& resource);
+
+    // Returns the id of the resource name. Ids are dense, i.e., they
+    // are in [0, names()).
+    size_t name(const std::string& name);
+
+    // Returns the number of resource names seen so far.
+    size_t names() const { return ids.size(); }
+
+  private:
+    friend class CompactResources;
+
+    struct Slot
+    {
+      // The resource with a zero value.
+      Resource prototype;
+
+      // The id of the resource name.
+      size_t name;
+
+      bool unreserved;
+      bool revocable;
+    };
+
+    // Slots by the hash of the fields that identify them, see
+    // 'slot()'. Slots whose hashes collide share a bucket.
+    hashmap<size_t, std::vector<size_t>> slots;
+    std::vector<Slot> entries;
+
+    hashmap<std::string, size_t> ids;
+  };
+
+  CompactResources() : index(NULL) {}
+
+  CompactResources(Index* index, const Resources& resources);
+
+  // Converts back to 'Resources'.
+  Resources resources() const;
+
+  bool empty() const { return scalars.empty() && others.empty(); }
+
+  bool contains(const CompactResources& that) const;
+
+  // See the corresponding functions of 'Resources'.
+  CompactResources unreserved() const;
+  CompactResources reserved(const std::string& role) const;
+  CompactResources revocable() const;
+
+  Option<double> cpus() const;
+  Option<Bytes> mem() const;
+
+  // Adds the quantity of each scalar resource to 'quantities' at the
+  // index of the id of its name, see 'Index::name()'. Quantities for
+  // names that were added to the index afterwards are appended.
+  void sum(std::vector<double>* quantities) const;
+
+  // Like '-=', but also subtracts what actually got removed from each
+  // resource name from 'quantities', see 'sum()'. Since scalars never
+  // become negative this can be less than the quantities of 'that'.
+  void subtract(const CompactResources& that, std::vector<double>* quantities);
+
+  bool operator == (const CompactResources& that) const;
+  bool operator != (const CompactResources& that) const;
+
+  CompactResources operator + (const CompactResources& that) const;
+  CompactResources operator - (const CompactResources& that) const;
+  CompactResources& operator += (const CompactResources& that);
+  CompactResources& operator -= (const CompactResources& that);
+
+private:
+  // Values are kept sorted by slot, and are always positive.
+  typedef std::vector<std::pair<size_t, double>> Scalars;
+
+  // Returns the scalars whose slot satisfies the predicate, along
+  // with the given non-scalar resources.
+  template <typename Predicate>
+  CompactResources filter(Predicate predicate, const Resources& others) const;
+
+  Option<double> get(const std::string& name) const;
+
+  // Adopts the index of 'that' if we do not have one yet (e.g., when
+  // we have been default constructed).
+  void adopt(const CompactResources& that);
+
+  Index* index;
+
+  Scalars scalars;
+
+  Resources others;
+};
+
+
+std::ostream& operator << (
+    std::ostream& stream,
+    const CompactResources& resources);
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ALLOCATOR_COMPACT_HPP__
@@ -19,6 +19,8 @@
 #ifndef __MASTER_ALLOCATOR_MESOS_ALLOCATOR_HPP__
 #define __MASTER_ALLOCATOR_MESOS_ALLOCATOR_HPP__
 
+#include <utility>
+
 #include <mesos/master/allocator.hpp>
 
 #include <process/dispatch.hpp>
@@ -42,8 +44,10 @@ template <typename AllocatorProcess>
 class MesosAllocator : public mesos::master::allocator::Allocator
 {
 public:
-  // Factory to allow for typed tests.
-  static Try<mesos::master::allocator::Allocator*> create();
+  // Factory to allow for typed tests. Any arguments are forwarded to
+  // the constructor of the AllocatorProcess.
+  template <typename... Args>
+  static Try<mesos::master::allocator::Allocator*> create(Args&&... args);
 
   ~MesosAllocator();
 
@@ -116,8 +120,11 @@ public:
   void reviveOffers(
       const FrameworkID& frameworkId);
 
+  void suppressOffers(
+      const FrameworkID& frameworkId);
+
 private:
-  MesosAllocator();
+  explicit MesosAllocator(AllocatorProcess* _process);
   MesosAllocator(const MesosAllocator&); // Not copyable.
   MesosAllocator& operator=(const MesosAllocator&); // Not assignable.
 
@@ -205,22 +212,27 @@ public:
 
   virtual void reviveOffers(
       const FrameworkID& frameworkId) = 0;
+
+  virtual void suppressOffers(
+      const FrameworkID& frameworkId) = 0;
 };
 
 
 template <typename AllocatorProcess>
+template <typename... Args>
 Try<mesos::master::allocator::Allocator*>
-MesosAllocator<AllocatorProcess>::create()
+MesosAllocator<AllocatorProcess>::create(Args&&... args)
 {
   mesos::master::allocator::Allocator* allocator =
-    new MesosAllocator<AllocatorProcess>();
+    new MesosAllocator<AllocatorProcess>(
+        new AllocatorProcess(std::forward<Args>(args)...));
   return CHECK_NOTNULL(allocator);
 }
 
 template <typename AllocatorProcess>
-MesosAllocator<AllocatorProcess>::MesosAllocator()
+MesosAllocator<AllocatorProcess>::MesosAllocator(AllocatorProcess* _process)
+  : process(CHECK_NOTNULL(_process))
 {
-  process = new AllocatorProcess();
   process::spawn(process);
 }
 
@@ -455,6 +467,17 @@ inline void MesosAllocator<AllocatorProcess>::reviveOffers(
       frameworkId);
 }
 
+
+template <typename AllocatorProcess>
+inline void MesosAllocator<AllocatorProcess>::suppressOffers(
+    const FrameworkID& frameworkId)
+{
+  process::dispatch(
+      process,
+      &MesosAllocatorProcess::suppressOffers,
+      frameworkId);
+}
+
 } // namespace allocator {
 } // namespace master {
 } // namespace internal {
@@ -20,27 +20,44 @@
 #define __MASTER_ALLOCATOR_MESOS_HIERARCHICAL_HPP__
 
 #include <algorithm>
+#include <list>
+#include <queue>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <mesos/resources.hpp>
 #include <mesos/type_utils.hpp>
 
-#include <process/event.hpp>
+#include <process/collect.hpp>
+#include <process/defer.hpp>
 #include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/event.hpp>
 #include <process/future.hpp>
 #include <process/id.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+#include <process/shared.hpp>
+#include <process/timeout.hpp>
+#include <process/timer.hpp>
+
+#include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
 #include <process/metrics/metrics.hpp>
-#include <process/timeout.hpp>
+#include <process/metrics/timer.hpp>
 
 #include <stout/check.hpp>
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/stopwatch.hpp>
 #include <stout/stringify.hpp>
 
+#include "master/allocator/compact.hpp"
+
 #include "master/allocator/mesos/allocator.hpp"
-#include "master/allocator/sorter/drf/sorter.hpp"
+#include "master/allocator/sorter/drf/incremental.hpp"
 
 #include "master/constants.hpp"
 
@@ -58,7 +75,7 @@ class Filter;
 template <typename RoleSorter, typename FrameworkSorter>
 class HierarchicalAllocatorProcess;
 
-typedef HierarchicalAllocatorProcess<DRFSorter, DRFSorter>
+typedef HierarchicalAllocatorProcess<IncrementalDRFSorter, IncrementalDRFSorter>
 HierarchicalDRFAllocatorProcess;
 
 typedef MesosAllocator<HierarchicalDRFAllocatorProcess>
@@ -67,15 +84,42 @@ HierarchicalDRFAllocator;
 
 // Implements the basic allocator algorithm - first pick a role by
 // some criteria, then pick one of their frameworks to allocate to.
+//
+// Besides implementing 'Sorter', the sorters need to provide the
+// ordering of their clients through 'order()' and 'name()' (see
+// IncrementalDRFSorter), so that an allocation does not copy the
+// names of all clients for every slave.
+//
+// If 'batchInterval' is greater than zero, the allocations triggered
+// by events (e.g., added slaves or recovered resources) are batched:
+// an allocation is performed at most once per 'batchInterval', and
+// it handles all the requests made meanwhile, see '_allocate()'.
+//
+// If 'workers' is greater than zero, allocations for all slaves
+// (i.e., batch allocations) are sharded: the slaves are partitioned
+// across that many worker processes, which compute tentative offers
+// in parallel against a snapshot of the sorters' ordering. The
+// tentative offers are then reconciled against the current state by
+// the allocator itself, see 'allocate()' and 'reconcile()'.
 template <typename RoleSorter, typename FrameworkSorter>
 class HierarchicalAllocatorProcess : public MesosAllocatorProcess
 {
 public:
-  HierarchicalAllocatorProcess()
+  explicit HierarchicalAllocatorProcess(
+      size_t _workers = 0,
+      const Duration& _batchInterval = Duration::zero())
     : ProcessBase(process::ID::generate("hierarchical-allocator")),
       initialized(false),
       metrics(*this),
-      roleSorter(NULL) {}
+      roleSorter(NULL),
+      batchInterval(_batchInterval),
+      allocationPending(false),
+      allocationAll(false),
+      allocationRequests(0),
+      allocationSlaves(0),
+      workerCount(_workers),
+      sharding(false),
+      pending(false) {}
 
   virtual ~HierarchicalAllocatorProcess() {}
 
@@ -153,6 +197,9 @@ public:
   void reviveOffers(
       const FrameworkID& frameworkId);
 
+  void suppressOffers(
+      const FrameworkID& frameworkId);
+
 protected:
   // Useful typedefs for dispatch/delay/defer to self()/this.
   typedef HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter> Self;
@@ -161,17 +208,44 @@ protected:
   // Callback for doing batch allocations.
   void batch();
 
-  // Allocate any allocatable resources.
+  virtual void finalize();
+
+  // Requests an allocation of any allocatable resources.
   void allocate();
 
-  // Allocate resources just from the specified slave.
+  // Requests an allocation of resources just from the specified slave.
   void allocate(const SlaveID& slaveId);
 
+  // Schedules '_allocate()' unless it is pending already, see above.
+  void request();
+
+  // Performs the requested allocations. If batching, requests are
+  // coalesced: the first request schedules this to run once
+  // 'batchInterval' has passed since the previous allocation, and
+  // any requests that are made before it runs are handled by the same
+  // allocation. This means an allocation is performed right away when
+  // the allocator has been idle, while under load there is at most one
+  // allocation per 'batchInterval'. Without batching, every request
+  // is performed right away.
+  void _allocate();
+
   // Allocate resources from the specified slaves.
   void allocate(const hashset<SlaveID>& slaveIds);
 
-  // Remove a filter for the specified framework.
-  void expire(const FrameworkID& frameworkId, Filter* filter);
+  // Allocate resources from the given slaves, in the given order,
+  // accumulating the resources to be offered in 'offerable' and the
+  // time spent sorting in 'sortTime'.
+  void allocate(
+      const std::vector<SlaveID>& slaveIds,
+      hashmap<FrameworkID, hashmap<SlaveID, Resources>>* offerable,
+      Duration* sortTime);
+
+  // Sends the offerable resources to the frameworks.
+  void offer(
+      const hashmap<FrameworkID, hashmap<SlaveID, Resources>>& offerable);
+
+  // Removes the filters that have expired.
+  void expire();
 
   // Checks whether the slave is whitelisted.
   bool isWhitelisted(const SlaveID& slaveId);
@@ -181,9 +255,16 @@ protected:
   bool isFiltered(
       const FrameworkID& frameworkId,
       const SlaveID& slaveId,
-      const Resources& resources);
+      const CompactResources& resources);
+
+  // Works for both 'Resources' and 'CompactResources'.
+  template <typename T>
+  static bool allocatable(const T& resources);
 
-  bool allocatable(const Resources& resources);
+  // Adds the slave to (or removes it from) 'allocatableSlaves'
+  // depending on its available resources. This needs to be called
+  // whenever the total or allocated resources of a slave change.
+  void updateAllocatable(const SlaveID& slaveId);
 
   bool initialized;
 
@@ -198,28 +279,153 @@ protected:
     explicit Metrics(const Self& process)
       : event_queue_dispatches(
             "allocator/event_queue_dispatches",
-            process::defer(process.self(), &Self::_event_queue_dispatches))
+            process::defer(process.self(), &Self::_event_queue_dispatches)),
+        allocation_runs("allocator/allocation_runs"),
+        allocation_requests("allocator/allocation_requests"),
+        allocation_batch_slaves(
+            "allocator/allocation_batch_slaves",
+            process::defer(process.self(), &Self::_allocation_batch_slaves)),
+        allocation_latency("allocator/allocation_latency", Hours(1)),
+        allocation_run("allocator/allocation_run", Hours(1)),
+        allocation_sort_time(
+            "allocator/allocation_sort_time_ms",
+            process::defer(process.self(), &Self::_allocation_sort_time)),
+        filter_checks("allocator/filter_checks"),
+        filtered("allocator/filtered"),
+        offers("allocator/offers")
     {
       process::metrics::add(event_queue_dispatches);
+      process::metrics::add(allocation_runs);
+      process::metrics::add(allocation_requests);
+      process::metrics::add(allocation_batch_slaves);
+      process::metrics::add(allocation_latency);
+      process::metrics::add(allocation_run);
+      process::metrics::add(allocation_sort_time);
+      process::metrics::add(filter_checks);
+      process::metrics::add(filtered);
+      process::metrics::add(offers);
     }
 
     ~Metrics()
     {
       process::metrics::remove(event_queue_dispatches);
+      process::metrics::remove(allocation_runs);
+      process::metrics::remove(allocation_requests);
+      process::metrics::remove(allocation_batch_slaves);
+      process::metrics::remove(allocation_latency);
+      process::metrics::remove(allocation_run);
+      process::metrics::remove(allocation_sort_time);
+      process::metrics::remove(filter_checks);
+      process::metrics::remove(filtered);
+      process::metrics::remove(offers);
+
+      foreachvalue (const process::metrics::Counter& counter, role_offers) {
+        process::metrics::remove(counter);
+      }
+
+      typedef hashmap<std::string, process::metrics::Gauge> Gauges;
+
+      foreachvalue (const Gauges& gauges, role_resources_offered) {
+        foreachvalue (const process::metrics::Gauge& gauge, gauges) {
+          process::metrics::remove(gauge);
+        }
+      }
+    }
+
+    // Adds the metrics of a role. We do this once the roles are
+    // known, see 'initialize()'.
+    void add(const Self& process, const std::string& role)
+    {
+      process::metrics::Counter counter(
+          "allocator/roles/" + role + "/offers");
+
+      role_offers.put(role, counter);
+      process::metrics::add(counter);
+    }
+
+    // Adds the gauge of the cumulative amount of a scalar resource
+    // offered to a role. We do this the first time the resource is
+    // offered to the role, see 'offer()'.
+    void add(
+        const Self& process,
+        const std::string& role,
+        const std::string& resource)
+    {
+      process::metrics::Gauge gauge(
+          "allocator/roles/" + role + "/" + resource + "_offered_total",
+          process::defer(
+              process.self(), &Self::_resources_offered, role, resource));
+
+      role_resources_offered[role].put(resource, gauge);
+      process::metrics::add(gauge);
     }
 
     process::metrics::Gauge event_queue_dispatches;
+
+    // Number of allocations performed, and number of allocations
+    // requested. Since requests are coalesced, the ratio of the two
+    // is the average number of requests handled by an allocation.
+    process::metrics::Counter allocation_runs;
+    process::metrics::Counter allocation_requests;
+
+    // Number of slaves considered by the latest allocation.
+    process::metrics::Gauge allocation_batch_slaves;
+
+    // Time from the first request of an allocation until the
+    // allocation has been performed.
+    process::metrics::Timer<Milliseconds> allocation_latency;
+
+    // Time it takes to perform an allocation, including the workers
+    // and the reconciliation of their proposals if sharded.
+    process::metrics::Timer<Milliseconds> allocation_run;
+
+    // Time spent sorting the roles and frameworks during the latest
+    // allocation.
+    process::metrics::Gauge allocation_sort_time;
+
+    // Number of times a framework's filters were checked against
+    // resources to be offered, and how many of those checks filtered
+    // the resources (including non-checkpointing slaves).
+    process::metrics::Counter filter_checks;
+    process::metrics::Counter filtered;
+
+    // Number of offers made, i.e., one per framework and slave.
+    process::metrics::Counter offers;
+
+    // Number of offers made to each role, and the cumulative amount
+    // of each resource offered to it (i.e., including the resources
+    // that were offered again after being declined or rescinded).
+    hashmap<std::string, process::metrics::Counter> role_offers;
+    hashmap<std::string, hashmap<std::string, process::metrics::Gauge>>
+      role_resources_offered;
   } metrics;
 
   struct Framework
   {
+    Framework()
+      : checkpoint(false),
+        revocable(false),
+        active(false),
+        suppressed(false) {}
+
     std::string role;
     bool checkpoint;  // Whether the framework desires checkpointing.
 
     // Whether the framework desires revocable resources.
     bool revocable;
 
-    hashset<Filter*> filters; // Active filters for the framework.
+    // Whether the framework is activated.
+    bool active;
+
+    // Whether the framework has suppressed offers. A framework is
+    // only part of the sort if it is active and not suppressed.
+    // Suppression is lifted when the framework revives offers, or
+    // when it is deactivated (e.g., when the scheduler fails over).
+    bool suppressed;
+
+    // Active filters for the framework, indexed by the slave whose
+    // resources they filter.
+    hashmap<SlaveID, hashset<Filter*>> filters;
   };
 
   double _event_queue_dispatches()
@@ -227,12 +433,39 @@ protected:
     return static_cast<double>(eventCount<process::DispatchEvent>());
   }
 
+  double _allocation_batch_slaves()
+  {
+    return static_cast<double>(allocationSlaves);
+  }
+
+  double _allocation_sort_time()
+  {
+    return allocationSortTime.ms();
+  }
+
+  double _resources_offered(
+      const std::string& role,
+      const std::string& resource)
+  {
+    if (offered.contains(role) && offered[role].contains(resource)) {
+      return offered[role][resource];
+    }
+
+    return 0.0;
+  }
+
   hashmap<FrameworkID, Framework> frameworks;
 
+  // Assigns the slots of the slaves' compact resources below.
+  CompactResources::Index index;
+
+  // NOTE: We keep the slaves' resources in compact form since they
+  // are what every allocation does arithmetic on. They are converted
+  // from and to 'Resources' when they enter or leave the allocator.
   struct Slave
   {
     // Total amount of regular *and* oversubscribed resources.
-    Resources total;
+    CompactResources total;
 
     // Regular *and* oversubscribed resources that are allocated.
     //
@@ -240,7 +473,7 @@ protected:
     // having that information in sorters. This is because the
     // information in sorters is not accurate if some framework
     // hasn't reregistered. See MESOS-2919 for details.
-    Resources allocated;
+    CompactResources allocated;
 
     // We track the total and allocated resources on the slave, the
     // available resources are computed as follows:
@@ -258,6 +491,12 @@ protected:
 
   hashmap<SlaveID, Slave> slaves;
 
+  // The slaves whose available resources are allocatable. Only these
+  // slaves can produce offers, so an allocation does not need to look
+  // at the others (e.g., fully allocated slaves, which make up the
+  // bulk of a busy cluster).
+  hashset<SlaveID> allocatableSlaves;
+
   hashmap<std::string, mesos::master::RoleInfo> roles;
 
   // Slaves to send offers for.
@@ -278,6 +517,183 @@ protected:
   // oversubscribed resources.
   RoleSorter* roleSorter;
   hashmap<std::string, FrameworkSorter*> frameworkSorters;
+
+  // State used for coalescing allocations, see '_allocate()'.
+
+  const Duration batchInterval;
+
+  // When the latest allocation was performed.
+  process::Time allocationTime;
+
+  // Whether '_allocate()' has been dispatched.
+  bool allocationPending;
+
+  // Whether the pending allocation is for all slaves, otherwise it is
+  // for the slaves in 'allocationCandidates'.
+  bool allocationAll;
+  hashset<SlaveID> allocationCandidates;
+
+  // Number of requests coalesced into the pending allocation.
+  size_t allocationRequests;
+
+  // Completed once the pending allocation has been performed, which
+  // times the latency of its first request. We cannot use the start
+  // and stop of the latency timer since a sharded allocation can
+  // still be in progress when the next allocation is requested.
+  Option<process::Owned<process::Promise<Nothing>>> requested;
+
+  // Number of slaves considered by the latest allocation.
+  size_t allocationSlaves;
+
+  // Time spent sorting during the latest allocation. A sharded
+  // allocation accumulates it in 'shardedSortTime' until it has been
+  // reconciled, since other allocations can be performed meanwhile.
+  Duration allocationSortTime;
+
+  // Scalar resources offered to each role since the allocator
+  // started, by resource name.
+  hashmap<std::string, hashmap<std::string, double>> offered;
+
+  // A filter along with the framework and slave it was installed
+  // for, ordered by when the filter expires.
+  struct Expiry
+  {
+    process::Timeout timeout;
+    FrameworkID frameworkId;
+    SlaveID slaveId;
+    Filter* filter;
+
+    // NOTE: Reversed so that the filter that expires first is at the
+    // top of the 'std::priority_queue'.
+    bool operator < (const Expiry& that) const
+    {
+      return that.timeout < timeout;
+    }
+  };
+
+  // All filters, including those which are no longer active (e.g.,
+  // because the framework revived offers), until they expire. Since
+  // filters are only deleted here, the address of a filter can not
+  // get reused while it is still referenced.
+  std::priority_queue<Expiry> expiries;
+
+  // Fires when the filter at the top of 'expiries' expires.
+  Option<process::Timer> expiryTimer;
+
+  // State used for sharded allocations.
+
+  // The inputs of a sharded allocation that are shared by all the
+  // workers.
+  struct Snapshot
+  {
+    struct Framework
+    {
+      bool checkpoint;
+      bool revocable;
+
+      // NOTE: Filters are not deleted while a sharded allocation is
+      // in progress, see 'expire()'.
+      hashmap<SlaveID, std::vector<Filter*>> filters;
+    };
+
+    // The roles in the order in which they should be allocated to,
+    // each along with its active frameworks in that same fashion.
+    std::vector<std::pair<std::string, std::vector<FrameworkID>>> roles;
+
+    hashmap<FrameworkID, Framework> frameworks;
+  };
+
+  // A slave to be allocated by a worker.
+  struct Candidate
+  {
+    SlaveID slaveId;
+    Resources total;
+    Resources allocated;
+    bool checkpoint;
+  };
+
+  // A tentative offer computed by a worker.
+  struct Proposal
+  {
+    FrameworkID frameworkId;
+    SlaveID slaveId;
+    Resources resources;
+  };
+
+  // Computes tentative offers for a shard of the slaves.
+  class Worker : public process::Process<Worker>
+  {
+  public:
+    // The workers update the allocator's filter metrics.
+    Worker(
+        const process::metrics::Counter& _filterChecks,
+        const process::metrics::Counter& _filterHits)
+      : ProcessBase(process::ID::generate("hierarchical-allocator-worker")),
+        filterChecks(_filterChecks),
+        filterHits(_filterHits) {}
+
+    virtual ~Worker() {}
+
+    // Runs the allocation algorithm over the candidates using the
+    // ordering of the snapshot. Since we cannot update the sorters
+    // here, a framework (and its role) is moved to the back of the
+    // ordering whenever it is allocated to, which approximates how
+    // its share increases.
+    //
+    // NOTE: Every worker starts with the same ordering, so compared
+    // to a serial allocation a framework can be allocated up to one
+    // slave per worker before the frameworks ordered behind it are.
+    // This bounds the unfairness of a sharded allocation: a framework
+    // is never proposed more slaves by a worker than any framework
+    // ordered ahead of it that is able to use them.
+    std::vector<Proposal> allocate(
+        const process::Shared<Snapshot>& snapshot,
+        const std::vector<Candidate>& candidates);
+
+  private:
+    process::metrics::Counter filterChecks;
+    process::metrics::Counter filterHits;
+  };
+
+  // Allocates all slaves by sharding them across the workers. The
+  // promise is completed once the allocation has been performed.
+  void shard(const process::Owned<process::Promise<Nothing>>& latency);
+
+  // Continuation of 'shard()' that applies the tentative offers of
+  // the workers. They are applied in the current ordering of the
+  // sorters, one per framework at a time, so that conflicts are
+  // resolved in favor of the frameworks with the lowest shares.
+  // Tentative offers that are no longer valid (e.g., the resources
+  // were allocated, or the framework was deactivated or started
+  // filtering them meanwhile) are dropped and their slaves are
+  // allocated again, this time by the allocator itself.
+  void reconcile(const process::Future<std::list<std::vector<Proposal>>>&);
+
+  const size_t workerCount;
+  std::vector<Worker*> workers;
+
+  // Whether a sharded allocation is in progress.
+  bool sharding;
+
+  // Completed once the sharded allocation in progress is done, which
+  // times it, see 'requested' above.
+  Option<process::Owned<process::Promise<Nothing>>> run;
+
+  // The requests served by the sharded allocation in progress.
+  std::vector<process::Owned<process::Promise<Nothing>>> served;
+
+  // Time spent sorting during the sharded allocation in progress.
+  Duration shardedSortTime;
+
+  // Whether another allocation of all slaves was requested while a
+  // sharded allocation was in progress, and the requests that will
+  // be served by the next sharded allocation.
+  bool pending;
+  std::vector<process::Owned<process::Promise<Nothing>>> deferred;
+
+  // Filters that expired while a sharded allocation was in progress,
+  // to be deleted once the workers are done.
+  std::vector<Filter*> expired;
 };
 
 
@@ -288,6 +704,10 @@ public:
   virtual ~Filter() {}
 
   virtual bool filter(const SlaveID& slaveId, const Resources& resources) = 0;
+
+  virtual bool filter(
+      const SlaveID& slaveId,
+      const CompactResources& resources) = 0;
 };
 
 
@@ -297,8 +717,12 @@ public:
   RefusedFilter(
       const SlaveID& _slaveId,
       const Resources& _resources,
+      const CompactResources& _compact,
       const process::Timeout& _timeout)
-    : slaveId(_slaveId), resources(_resources), timeout(_timeout) {}
+    : slaveId(_slaveId),
+      resources(_resources),
+      compact(_compact),
+      timeout(_timeout) {}
 
   virtual bool filter(const SlaveID& _slaveId, const Resources& _resources)
   {
@@ -312,8 +736,18 @@ public:
            timeout.remaining() > Seconds(0);
   }
 
+  virtual bool filter(
+      const SlaveID& _slaveId,
+      const CompactResources& _resources)
+  {
+    return slaveId == _slaveId &&
+           compact.contains(_resources) &&
+           timeout.remaining() > Seconds(0);
+  }
+
   const SlaveID slaveId;
   const Resources resources;
+  const CompactResources compact;
   const process::Timeout timeout;
 };
 
@@ -337,13 +771,23 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::initialize(
       const std::string& name, const mesos::master::RoleInfo& roleInfo, roles) {
     roleSorter->add(name, roleInfo.weight());
     frameworkSorters[name] = new FrameworkSorter();
+    metrics.add(*this, name);
   }
 
   if (roleSorter->count() == 0) {
     LOG(ERROR) << "No roles specified, cannot allocate resources!";
   }
 
-  VLOG(1) << "Initialized hierarchical allocator process";
+  for (size_t i = 0; i < workerCount; i++) {
+    Worker* worker = new Worker(metrics.filter_checks, metrics.filtered);
+    process::spawn(worker);
+    workers.push_back(worker);
+  }
+
+  VLOG(1) << "Initialized hierarchical allocator process"
+          << (workers.empty()
+              ? ""
+              : " with " + stringify(workers.size()) + " workers");
 
   delay(allocationInterval, self(), &Self::batch);
 }
@@ -378,6 +822,8 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::addFramework(
   frameworks[frameworkId] = Framework();
   frameworks[frameworkId].role = frameworkInfo.role();
   frameworks[frameworkId].checkpoint = frameworkInfo.checkpoint();
+  frameworks[frameworkId].active = true;
+  frameworks[frameworkId].suppressed = false;
 
   // Check if the framework desires revocable resources.
   frameworks[frameworkId].revocable = false;
@@ -420,7 +866,7 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::removeFramework(
   }
 
   // Do not delete the filters contained in this
-  // framework's 'filters' hashset yet, see comments in
+  // framework's 'filters' yet, see comments in
   // HierarchicalAllocatorProcess::reviveOffers and
   // HierarchicalAllocatorProcess::expire.
   frameworks.erase(frameworkId);
@@ -439,7 +885,11 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::activateFramework(
   CHECK(frameworks.contains(frameworkId));
   const std::string& role = frameworks[frameworkId].role;
 
-  frameworkSorters[role]->activate(frameworkId.value());
+  if (!frameworks[frameworkId].suppressed) {
+    frameworkSorters[role]->activate(frameworkId.value());
+  }
+
+  frameworks[frameworkId].active = true;
 
   LOG(INFO) << "Activated framework " << frameworkId;
 
@@ -458,6 +908,8 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::deactivateFramework(
   const std::string& role = frameworks[frameworkId].role;
 
   frameworkSorters[role]->deactivate(frameworkId.value());
+  frameworks[frameworkId].active = false;
+  frameworks[frameworkId].suppressed = false;
 
   // Note that the Sorter *does not* remove the resources allocated
   // to this framework. For now, this is important because if the
@@ -466,7 +918,7 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::deactivateFramework(
   // the added/removed and activated/deactivated in the future.
 
   // Do not delete the filters contained in this
-  // framework's 'filters' hashset yet, see comments in
+  // framework's 'filters' yet, see comments in
   // HierarchicalAllocatorProcess::reviveOffers and
   // HierarchicalAllocatorProcess::expire.
   frameworks[frameworkId].filters.clear();
@@ -531,12 +983,14 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::addSlave(
   }
 
   slaves[slaveId] = Slave();
-  slaves[slaveId].total = total;
-  slaves[slaveId].allocated = Resources::sum(used);
+  slaves[slaveId].total = CompactResources(&index, total);
+  slaves[slaveId].allocated = CompactResources(&index, Resources::sum(used));
   slaves[slaveId].activated = true;
   slaves[slaveId].checkpoint = slaveInfo.checkpoint();
   slaves[slaveId].hostname = slaveInfo.hostname();
 
+  updateAllocatable(slaveId);
+
   LOG(INFO) << "Added slave " << slaveId << " (" << slaves[slaveId].hostname
             << ") with " << slaves[slaveId].total
             << " (allocated: " << slaves[slaveId].allocated << ")";
@@ -559,9 +1013,10 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::removeSlave(
   // all the resources. Fixing this would require more information
   // than what we currently track in the allocator.
 
-  roleSorter->remove(slaveId, slaves[slaveId].total.unreserved());
+  roleSorter->remove(slaveId, slaves[slaveId].total.unreserved().resources());
 
   slaves.erase(slaveId);
+  allocatableSlaves.erase(slaveId);
 
   // Note that we DO NOT actually delete any filters associated with
   // this slave, that will occur when the delayed
@@ -590,12 +1045,14 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::updateSlave(
   slaves[slaveId].total -= slaves[slaveId].total.revocable();
 
   // Now add the new estimate of oversubscribed resources.
-  slaves[slaveId].total += oversubscribed;
+  slaves[slaveId].total += CompactResources(&index, oversubscribed);
 
   // Now, update the total resources in the role sorter.
   roleSorter->update(
       slaveId,
-      slaves[slaveId].total.unreserved());
+      slaves[slaveId].total.unreserved().resources());
+
+  updateAllocatable(slaveId);
 
   LOG(INFO) << "Slave " << slaveId << " (" << slaves[slaveId].hostname << ")"
             << " updated with oversubscribed resources " << oversubscribed
@@ -707,17 +1164,22 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::updateAllocation(
       updatedFrameworkAllocation.get().unreserved());
 
   Try<Resources> updatedSlaveAllocation =
-    slaves[slaveId].allocated.apply(operations);
+    slaves[slaveId].allocated.resources().apply(operations);
 
   CHECK_SOME(updatedSlaveAllocation);
 
-  slaves[slaveId].allocated = updatedSlaveAllocation.get();
+  slaves[slaveId].allocated =
+    CompactResources(&index, updatedSlaveAllocation.get());
 
   // Update the total resources.
-  Try<Resources> updatedTotal = slaves[slaveId].total.apply(operations);
+  Try<Resources> updatedTotal =
+    slaves[slaveId].total.resources().apply(operations);
+
   CHECK_SOME(updatedTotal);
 
-  slaves[slaveId].total = updatedTotal.get();
+  slaves[slaveId].total = CompactResources(&index, updatedTotal.get());
+
+  updateAllocatable(slaveId);
 
   // TODO(jieyu): Do not log if there is no update.
   LOG(INFO) << "Updated allocation of framework " << frameworkId
@@ -736,7 +1198,8 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::updateAvailable(
   CHECK(initialized);
   CHECK(slaves.contains(slaveId));
 
-  Resources available = slaves[slaveId].total - slaves[slaveId].allocated;
+  Resources available =
+    (slaves[slaveId].total - slaves[slaveId].allocated).resources();
 
   // It's possible for this 'apply' to fail here because a call to
   // 'allocate' could have been enqueued by the allocator itself
@@ -756,13 +1219,19 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::updateAvailable(
   }
 
   // Update the total resources.
-  Try<Resources> updatedTotal = slaves[slaveId].total.apply(operations);
+  Try<Resources> updatedTotal =
+    slaves[slaveId].total.resources().apply(operations);
+
   CHECK_SOME(updatedTotal);
 
-  slaves[slaveId].total = updatedTotal.get();
+  slaves[slaveId].total = CompactResources(&index, updatedTotal.get());
 
   // Now, update the total resources in the role sorter.
-  roleSorter->update(slaveId, slaves[slaveId].total.unreserved());
+  roleSorter->update(
+      slaveId,
+      slaves[slaveId].total.unreserved().resources());
+
+  updateAllocatable(slaveId);
 
   return Nothing();
 }
@@ -809,7 +1278,9 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::recoverResources(
     // precision errors. See MESOS-1187 for details.
     // CHECK(slaves[slaveId].allocated.contains(resources));
 
-    slaves[slaveId].allocated -= resources;
+    slaves[slaveId].allocated -= CompactResources(&index, resources);
+
+    updateAllocatable(slaveId);
 
     LOG(INFO) << "Recovered " << resources
               << " (total: " << slaves[slaveId].total
@@ -852,15 +1323,29 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::recoverResources(
             << " filtered slave " << slaveId
             << " for " << seconds.get();
 
-    // Create a new filter and delay its expiration.
-    Filter* filter = new RefusedFilter(
+    // Create a new filter and queue it for expiration.
+    Expiry expiry;
+    expiry.timeout = process::Timeout::in(seconds.get());
+    expiry.frameworkId = frameworkId;
+    expiry.slaveId = slaveId;
+    expiry.filter = new RefusedFilter(
         slaveId,
         resources,
-        process::Timeout::in(seconds.get()));
+        CompactResources(&index, resources),
+        expiry.timeout);
+
+    frameworks[frameworkId].filters[slaveId].insert(expiry.filter);
 
-    frameworks[frameworkId].filters.insert(filter);
+    expiries.push(expiry);
+
+    // (Re)start the timer if this filter is the first to expire.
+    if (expiries.top().filter == expiry.filter) {
+      if (expiryTimer.isSome()) {
+        process::Clock::cancel(expiryTimer.get());
+      }
 
-    delay(seconds.get(), self(), &Self::expire, frameworkId, filter);
+      expiryTimer = delay(seconds.get(), self(), &Self::expire);
+    }
   }
 }
 
@@ -872,6 +1357,8 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::reviveOffers(
 {
   CHECK(initialized);
 
+  CHECK(frameworks.contains(frameworkId));
+
   frameworks[frameworkId].filters.clear();
 
   // We delete each actual Filter when
@@ -883,10 +1370,49 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::reviveOffers(
 
   LOG(INFO) << "Removed filters for framework " << frameworkId;
 
+  // Reviving offers also lifts a suppression.
+  if (frameworks[frameworkId].suppressed) {
+    frameworks[frameworkId].suppressed = false;
+
+    if (frameworks[frameworkId].active) {
+      const std::string& role = frameworks[frameworkId].role;
+      frameworkSorters[role]->activate(frameworkId.value());
+    }
+
+    LOG(INFO) << "Unsuppressed offers for framework " << frameworkId;
+  }
+
   allocate();
 }
 
 
+template <class RoleSorter, class FrameworkSorter>
+void
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::suppressOffers(
+    const FrameworkID& frameworkId)
+{
+  CHECK(initialized);
+
+  CHECK(frameworks.contains(frameworkId));
+
+  if (frameworks[frameworkId].suppressed) {
+    return;
+  }
+
+  // We take the framework out of the sort, just like a deactivated
+  // framework, so that allocations do not even consider it. Its
+  // allocation is still accounted for in the sorters.
+  if (frameworks[frameworkId].active) {
+    const std::string& role = frameworks[frameworkId].role;
+    frameworkSorters[role]->deactivate(frameworkId.value());
+  }
+
+  frameworks[frameworkId].suppressed = true;
+
+  LOG(INFO) << "Suppressed offers for framework " << frameworkId;
+}
+
+
 template <class RoleSorter, class FrameworkSorter>
 void
 HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::batch()
@@ -898,15 +1424,41 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::batch()
 
 template <class RoleSorter, class FrameworkSorter>
 void
-HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::allocate()
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::finalize()
 {
-  Stopwatch stopwatch;
-  stopwatch.start();
+  foreach (Worker* worker, workers) {
+    process::terminate(worker);
+    process::wait(worker);
+    delete worker;
+  }
 
-  allocate(slaves.keys());
+  workers.clear();
+
+  foreach (Filter* filter, expired) {
+    delete filter;
+  }
 
-  VLOG(1) << "Performed allocation for " << slaves.size() << " slaves in "
-            << stopwatch.elapsed();
+  expired.clear();
+
+  if (expiryTimer.isSome()) {
+    process::Clock::cancel(expiryTimer.get());
+  }
+
+  while (!expiries.empty()) {
+    delete expiries.top().filter;
+    expiries.pop();
+  }
+}
+
+
+template <class RoleSorter, class FrameworkSorter>
+void
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::allocate()
+{
+  allocationAll = true;
+  allocationCandidates.clear();
+
+  request();
 }
 
 
@@ -915,16 +1467,101 @@ void
 HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::allocate(
     const SlaveID& slaveId)
 {
+  if (!allocationAll) {
+    allocationCandidates.insert(slaveId);
+  }
+
+  request();
+}
+
+
+template <class RoleSorter, class FrameworkSorter>
+void
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::request()
+{
+  allocationRequests++;
+  ++metrics.allocation_requests;
+
+  if (allocationPending) {
+    return;
+  }
+
+  allocationPending = true;
+
+  requested = process::Owned<process::Promise<Nothing>>(
+      new process::Promise<Nothing>());
+
+  metrics.allocation_latency.time(requested.get()->future());
+
+  if (batchInterval == Duration::zero()) {
+    _allocate();
+    return;
+  }
+
+  // NOTE: We still dispatch if the interval has passed already, so
+  // that the events which are queued meanwhile are batched as well.
+  const Duration elapsed = process::Clock::now() - allocationTime;
+
+  if (elapsed < batchInterval) {
+    delay(batchInterval - elapsed, self(), &Self::_allocate);
+  } else {
+    dispatch(self(), &Self::_allocate);
+  }
+}
+
+
+template <class RoleSorter, class FrameworkSorter>
+void
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::_allocate()
+{
+  CHECK(allocationPending);
+  CHECK_SOME(requested);
+
   Stopwatch stopwatch;
   stopwatch.start();
 
-  // TODO(bmahler): Add initializer list constructor for hashset.
-  hashset<SlaveID> slaves;
-  slaves.insert(slaveId);
-  allocate(slaves);
+  const size_t requests = allocationRequests;
+
+  const process::Owned<process::Promise<Nothing>> latency = requested.get();
+
+  allocationPending = false;
+  allocationRequests = 0;
+  allocationTime = process::Clock::now();
+  requested = None();
+
+  if (allocationAll) {
+    allocationAll = false;
+    allocationSlaves = allocatableSlaves.size();
+
+    if (!workers.empty()) {
+      shard(latency);
+    } else {
+      allocate(allocatableSlaves);
+      latency->set(Nothing());
+    }
+  } else {
+    hashset<SlaveID> slaveIds;
+
+    // Skip slaves that have been removed meanwhile, or that have
+    // nothing left to offer.
+    foreach (const SlaveID& slaveId, allocationCandidates) {
+      if (allocatableSlaves.contains(slaveId)) {
+        slaveIds.insert(slaveId);
+      }
+    }
+
+    allocationCandidates.clear();
+
+    allocationSlaves = slaveIds.size();
 
-  VLOG(1) << "Performed allocation for slave " << slaveId << " in "
-          << stopwatch.elapsed();
+    allocate(slaveIds);
+    latency->set(Nothing());
+  }
+
+  ++metrics.allocation_runs;
+
+  VLOG(1) << "Performed allocation for " << allocationSlaves << " slaves ("
+          << requests << " requests) in " << stopwatch.elapsed();
 }
 
 
@@ -938,11 +1575,12 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::allocate(
     return;
   }
 
-  // Compute the offerable resources, per framework:
-  //   (1) For reserved resources on the slave, allocate these to a
-  //       framework having the corresponding role.
-  //   (2) For unreserved resources on the slave, allocate these
-  //       to a framework of any role.
+  // Time this allocation, see 'requested'.
+  process::Promise<Nothing> done;
+  metrics.allocation_run.time(done.future());
+
+  Duration sortTime = Duration::zero();
+
   hashmap<FrameworkID, hashmap<SlaveID, Resources>> offerable;
 
   // Randomize the order in which slaves' resources are allocated.
@@ -950,30 +1588,86 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::allocate(
   std::vector<SlaveID> slaveIds(slaveIds_.begin(), slaveIds_.end());
   std::random_shuffle(slaveIds.begin(), slaveIds.end());
 
+  allocate(slaveIds, &offerable, &sortTime);
+
+  offer(offerable);
+
+  done.set(Nothing());
+  allocationSortTime = sortTime;
+}
+
+
+template <class RoleSorter, class FrameworkSorter>
+void
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::allocate(
+    const std::vector<SlaveID>& slaveIds,
+    hashmap<FrameworkID, hashmap<SlaveID, Resources>>* offerable,
+    Duration* sortTime)
+{
+  // Compute the offerable resources, per framework:
+  //   (1) For reserved resources on the slave, allocate these to a
+  //       framework having the corresponding role.
+  //   (2) For unreserved resources on the slave, allocate these
+  //       to a framework of any role.
   foreach (const SlaveID& slaveId, slaveIds) {
     // Don't send offers for non-whitelisted and deactivated slaves.
     if (!isWhitelisted(slaveId) || !slaves[slaveId].activated) {
       continue;
     }
 
-    foreach (const std::string& role, roleSorter->sort()) {
-      foreach (const std::string& frameworkId_,
-               frameworkSorters[role]->sort()) {
-        FrameworkID frameworkId;
-        frameworkId.set_value(frameworkId_);
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    // NOTE: The orderings are not changed by allocating to the
+    // clients, only by the next call to 'order()', so it is safe to
+    // iterate over them while we allocate.
+    const std::vector<typename RoleSorter::Handle>& sortedRoles =
+      roleSorter->order();
+
+    *sortTime += stopwatch.elapsed();
+
+    foreach (typename RoleSorter::Handle roleHandle, sortedRoles) {
+      const std::string& role = roleSorter->name(roleHandle);
 
+      FrameworkSorter* frameworkSorter = frameworkSorters[role];
+
+      stopwatch.start();
+
+      const std::vector<typename FrameworkSorter::Handle>& sortedFrameworks =
+        frameworkSorter->order();
+
+      *sortTime += stopwatch.elapsed();
+
+      // The resources on the slave that are available to frameworks
+      // in this role, with and without the revocable resources. They
+      // only change when we allocate them, so we do not recalculate
+      // them for each framework.
+      CompactResources roleResources;
+      CompactResources nonRevocable;
+
+      auto calculate = [&]() {
         // Calculate the currently available resources on the slave.
-        Resources available = slaves[slaveId].total - slaves[slaveId].allocated;
+        const CompactResources available =
+          slaves[slaveId].total - slaves[slaveId].allocated;
 
         // NOTE: Currently, frameworks are allowed to have '*' role.
         // Calling reserved('*') returns an empty Resources object.
-        Resources resources = available.unreserved() + available.reserved(role);
+        roleResources = available.unreserved() + available.reserved(role);
+        nonRevocable = roleResources - roleResources.revocable();
+      };
+
+      calculate();
+
+      foreach (typename FrameworkSorter::Handle handle, sortedFrameworks) {
+        const std::string& frameworkId_ = frameworkSorter->name(handle);
+
+        FrameworkID frameworkId;
+        frameworkId.set_value(frameworkId_);
 
         // Remove revocable resources if the framework has not opted
         // for them.
-        if (!frameworks[frameworkId].revocable) {
-          resources -= resources.revocable();
-        }
+        const CompactResources& resources =
+          frameworks[frameworkId].revocable ? roleResources : nonRevocable;
 
         // If the resources are not allocatable, ignore.
         if (!allocatable(resources)) {
@@ -988,28 +1682,65 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::allocate(
         VLOG(2) << "Allocating " << resources << " on slave " << slaveId
                 << " to framework " << frameworkId;
 
+        slaves[slaveId].allocated += resources;
+
+        // Everything beyond this point expects 'Resources', so we
+        // convert the allocation once.
+        const Resources allocation = resources.resources();
+
         // Note that we perform "coarse-grained" allocation,
         // meaning that we always allocate the entire remaining
         // slave resources to a single framework.
-        offerable[frameworkId][slaveId] = resources;
-        slaves[slaveId].allocated += resources;
+        (*offerable)[frameworkId][slaveId] += allocation;
 
         // Reserved resources are only accounted for in the framework
         // sorter, since the reserved resources are not shared across
         // roles.
-        frameworkSorters[role]->add(slaveId, resources);
-        frameworkSorters[role]->allocated(frameworkId_, slaveId, resources);
-        roleSorter->allocated(role, slaveId, resources.unreserved());
+        frameworkSorter->add(slaveId, allocation);
+        frameworkSorter->allocated(frameworkId_, slaveId, allocation);
+        roleSorter->allocated(role, slaveId, allocation.unreserved());
+
+        calculate();
       }
     }
+
+    updateAllocatable(slaveId);
   }
+}
 
+
+template <class RoleSorter, class FrameworkSorter>
+void
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::offer(
+    const hashmap<FrameworkID, hashmap<SlaveID, Resources>>& offerable)
+{
   if (offerable.empty()) {
     VLOG(1) << "No resources available to allocate!";
   } else {
     // Now offer the resources to each framework.
     foreachkey (const FrameworkID& frameworkId, offerable) {
-      offerCallback(frameworkId, offerable[frameworkId]);
+      const std::string& role = frameworks[frameworkId].role;
+
+      foreachvalue (const Resources& resources, offerable.at(frameworkId)) {
+        ++metrics.offers;
+
+        if (metrics.role_offers.contains(role)) {
+          ++metrics.role_offers.at(role);
+        }
+
+        foreach (const Resource& resource, resources) {
+          if (resource.type() == Value::SCALAR) {
+            if (metrics.role_offers.contains(role) &&
+                !offered[role].contains(resource.name())) {
+              metrics.add(*this, role, resource.name());
+            }
+
+            offered[role][resource.name()] += resource.scalar().value();
+          }
+        }
+      }
+
+      offerCallback(frameworkId, offerable.at(frameworkId));
     }
   }
 }
@@ -1017,21 +1748,368 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::allocate(
 
 template <class RoleSorter, class FrameworkSorter>
 void
-HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::expire(
-    const FrameworkID& frameworkId,
-    Filter* filter)
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::shard(
+    const process::Owned<process::Promise<Nothing>>& latency)
+{
+  // Coalesce with the allocation in progress, since it can not take
+  // into account any changes that happened after it was started.
+  if (sharding) {
+    pending = true;
+    deferred.push_back(latency);
+    return;
+  }
+
+  // This also serves the requests that were coalesced with the
+  // previous allocation.
+  CHECK(served.empty());
+  served.swap(deferred);
+  served.push_back(latency);
+
+  if (roleSorter->count() == 0) {
+    LOG(ERROR) << "No roles specified, cannot allocate resources!";
+
+    foreach (const process::Owned<process::Promise<Nothing>>& promise,
+             served) {
+      promise->set(Nothing());
+    }
+
+    served.clear();
+    return;
+  }
+
+  run = process::Owned<process::Promise<Nothing>>(
+      new process::Promise<Nothing>());
+
+  metrics.allocation_run.time(run.get()->future());
+
+  shardedSortTime = Duration::zero();
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  const std::vector<typename RoleSorter::Handle>& sortedRoles =
+    roleSorter->order();
+
+  shardedSortTime += stopwatch.elapsed();
+
+  Snapshot* snapshot = new Snapshot();
+
+  foreach (typename RoleSorter::Handle roleHandle, sortedRoles) {
+    const std::string& role = roleSorter->name(roleHandle);
+
+    FrameworkSorter* frameworkSorter = frameworkSorters[role];
+
+    std::vector<FrameworkID> frameworkIds;
+
+    stopwatch.start();
+
+    const std::vector<typename FrameworkSorter::Handle>& sortedFrameworks =
+      frameworkSorter->order();
+
+    shardedSortTime += stopwatch.elapsed();
+
+    foreach (typename FrameworkSorter::Handle handle, sortedFrameworks) {
+      FrameworkID frameworkId;
+      frameworkId.set_value(frameworkSorter->name(handle));
+
+      CHECK(frameworks.contains(frameworkId));
+
+      const Framework& framework = frameworks[frameworkId];
+
+      typename Snapshot::Framework& snapshotted =
+        snapshot->frameworks[frameworkId];
+
+      snapshotted.checkpoint = framework.checkpoint;
+      snapshotted.revocable = framework.revocable;
+      foreachpair (const SlaveID& slaveId,
+                   const hashset<Filter*>& filters,
+                   framework.filters) {
+        snapshotted.filters[slaveId].assign(filters.begin(), filters.end());
+      }
+
+      frameworkIds.push_back(frameworkId);
+    }
+
+    snapshot->roles.push_back(std::make_pair(role, frameworkIds));
+  }
+
+  // Randomize the order in which slaves' resources are allocated, and
+  // deal them out to the workers.
+  std::vector<SlaveID> slaveIds(
+      allocatableSlaves.begin(),
+      allocatableSlaves.end());
+
+  std::random_shuffle(slaveIds.begin(), slaveIds.end());
+
+  std::vector<std::vector<Candidate>> candidates(workers.size());
+
+  size_t count = 0;
+  foreach (const SlaveID& slaveId, slaveIds) {
+    // Don't send offers for non-whitelisted and deactivated slaves.
+    if (!isWhitelisted(slaveId) || !slaves[slaveId].activated) {
+      continue;
+    }
+
+    Candidate candidate;
+    candidate.slaveId = slaveId;
+    candidate.total = slaves[slaveId].total.resources();
+    candidate.allocated = slaves[slaveId].allocated.resources();
+    candidate.checkpoint = slaves[slaveId].checkpoint;
+
+    candidates[count++ % workers.size()].push_back(candidate);
+  }
+
+  process::Shared<Snapshot> shared(snapshot);
+
+  std::list<process::Future<std::vector<Proposal>>> futures;
+  for (size_t i = 0; i < workers.size(); i++) {
+    futures.push_back(process::dispatch(
+        workers[i], &Worker::allocate, shared, candidates[i]));
+  }
+
+  sharding = true;
+
+  process::collect(futures)
+    .onAny(process::defer(self(), &Self::reconcile, lambda::_1));
+}
+
+
+template <class RoleSorter, class FrameworkSorter>
+void
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::reconcile(
+    const process::Future<std::list<std::vector<Proposal>>>& future)
+{
+  CHECK(sharding);
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  sharding = false;
+
+  foreach (Filter* filter, expired) {
+    delete filter;
+  }
+
+  expired.clear();
+
+  hashmap<FrameworkID, hashmap<SlaveID, Resources>> offerable;
+
+  // Slaves that need to be allocated by us.
+  hashset<SlaveID> conflicts;
+
+  if (!future.isReady()) {
+    LOG(WARNING) << "Falling back to a serial allocation as the sharded "
+                 << "allocation failed: "
+                 << (future.isFailed() ? future.failure() : "discarded");
+
+    conflicts = slaves.keys();
+  } else {
+    const std::vector<std::vector<Proposal>> shards(
+        future.get().begin(), future.get().end());
+
+    // The proposals of each framework, taking those of the workers in
+    // turn so that none of the workers' slaves are favored.
+    hashmap<FrameworkID, std::vector<const Proposal*>> proposed;
+
+    size_t count = 0;
+    for (size_t i = 0; count < shards.size(); i++) {
+      count = 0;
+
+      foreach (const std::vector<Proposal>& proposals, shards) {
+        if (i >= proposals.size()) {
+          count++;
+          continue;
+        }
+
+        proposed[proposals[i].frameworkId].push_back(&proposals[i]);
+      }
+    }
+
+    // Re-validate the proposals against the current ordering of the
+    // sorters, which reflects any changes made while the workers were
+    // allocating (e.g., resources that have been recovered). Since
+    // only active frameworks that have not suppressed offers are
+    // sorted, this also drops the proposals of the others.
+    std::vector<FrameworkID> ordered;
+    hashset<FrameworkID> sorted;
+
+    Stopwatch sorting;
+    sorting.start();
+
+    foreach (typename RoleSorter::Handle roleHandle, roleSorter->order()) {
+      FrameworkSorter* frameworkSorter =
+        frameworkSorters[roleSorter->name(roleHandle)];
+
+      foreach (typename FrameworkSorter::Handle handle,
+               frameworkSorter->order()) {
+        FrameworkID frameworkId;
+        frameworkId.set_value(frameworkSorter->name(handle));
+
+        if (proposed.contains(frameworkId)) {
+          ordered.push_back(frameworkId);
+          sorted.insert(frameworkId);
+        }
+      }
+    }
+
+    shardedSortTime += sorting.elapsed();
+
+    size_t accepted = 0;
+    size_t proposals = 0;
+
+    foreachpair (const FrameworkID& frameworkId,
+                 const std::vector<const Proposal*>& proposals_,
+                 proposed) {
+      if (!sorted.contains(frameworkId)) {
+        foreach (const Proposal* proposal, proposals_) {
+          proposals++;
+
+          if (slaves.contains(proposal->slaveId)) {
+            conflicts.insert(proposal->slaveId);
+          }
+        }
+      }
+    }
+
+    // Apply one proposal of each framework at a time, in the order
+    // of the sorters, so that if there are conflicts the frameworks
+    // with the lowest shares are favored.
+    bool done = false;
+    for (size_t i = 0; !done; i++) {
+      done = true;
+
+      foreach (const FrameworkID& frameworkId, ordered) {
+        if (i >= proposed[frameworkId].size()) {
+          continue;
+        }
+
+        done = false;
+        proposals++;
+
+        const Proposal& proposal = *proposed[frameworkId][i];
+        const SlaveID& slaveId = proposal.slaveId;
+        const Resources& resources = proposal.resources;
+
+        // Skip slaves that have been removed, deactivated or are no
+        // longer whitelisted since the allocation started.
+        if (!slaves.contains(slaveId) ||
+            !slaves[slaveId].activated ||
+            !isWhitelisted(slaveId)) {
+          continue;
+        }
+
+        CompactResources available =
+          slaves[slaveId].total - slaves[slaveId].allocated;
+
+        const CompactResources compact(&index, resources);
+
+        if (!available.contains(compact) ||
+            isFiltered(frameworkId, slaveId, compact)) {
+          conflicts.insert(slaveId);
+          continue;
+        }
+
+        const std::string& role = frameworks[frameworkId].role;
+
+        VLOG(2) << "Allocating " << resources << " on slave " << slaveId
+                << " to framework " << frameworkId;
+
+        offerable[frameworkId][slaveId] += resources;
+        slaves[slaveId].allocated += compact;
+
+        updateAllocatable(slaveId);
+
+        frameworkSorters[role]->add(slaveId, resources);
+        frameworkSorters[role]->allocated(
+            frameworkId.value(), slaveId, resources);
+        roleSorter->allocated(role, slaveId, resources.unreserved());
+
+        accepted++;
+      }
+    }
+
+    VLOG(1) << "Accepted " << accepted << " of " << proposals
+            << " proposed allocations, " << conflicts.size()
+            << " slaves need to be allocated again";
+  }
+
+  std::vector<SlaveID> slaveIds(conflicts.begin(), conflicts.end());
+  std::random_shuffle(slaveIds.begin(), slaveIds.end());
+
+  allocate(slaveIds, &offerable, &shardedSortTime);
+
+  offer(offerable);
+
+  CHECK_SOME(run);
+  run.get()->set(Nothing());
+  run = None();
+
+  foreach (const process::Owned<process::Promise<Nothing>>& promise, served) {
+    promise->set(Nothing());
+  }
+
+  served.clear();
+
+  allocationSortTime = shardedSortTime;
+
+  VLOG(1) << "Reconciled sharded allocation for " << slaves.size()
+          << " slaves in " << stopwatch.elapsed();
+
+  if (pending) {
+    pending = false;
+    allocate();
+  }
+}
+
+
+template <class RoleSorter, class FrameworkSorter>
+void
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::expire()
 {
-  // The filter might have already been removed (e.g., if the
-  // framework no longer exists or in
-  // HierarchicalAllocatorProcess::reviveOffers) but not yet deleted (to
-  // keep the address from getting reused possibly causing premature
-  // expiration).
-  if (frameworks.contains(frameworkId) &&
-      frameworks[frameworkId].filters.contains(filter)) {
-    frameworks[frameworkId].filters.erase(filter);
+  expiryTimer = None();
+
+  while (!expiries.empty() && expiries.top().timeout.expired()) {
+    const Expiry& expiry = expiries.top();
+
+    // The filter might have already been removed (e.g., if the
+    // framework no longer exists or in
+    // HierarchicalAllocatorProcess::reviveOffers) but not yet deleted
+    // (to keep the address from getting reused possibly causing
+    // premature expiration).
+    if (frameworks.contains(expiry.frameworkId)) {
+      hashmap<SlaveID, hashset<Filter*>>& filters =
+        frameworks[expiry.frameworkId].filters;
+
+      if (filters.contains(expiry.slaveId) &&
+          filters[expiry.slaveId].contains(expiry.filter)) {
+        filters[expiry.slaveId].erase(expiry.filter);
+
+        if (filters[expiry.slaveId].empty()) {
+          filters.erase(expiry.slaveId);
+        }
+
+        // The filtered resources can be offered again, so there is no
+        // need to wait for the next batch allocation.
+        if (slaves.contains(expiry.slaveId)) {
+          allocate(expiry.slaveId);
+        }
+      }
+    }
+
+    // The workers may still be looking at the filter.
+    if (sharding) {
+      expired.push_back(expiry.filter);
+    } else {
+      delete expiry.filter;
+    }
+
+    expiries.pop();
   }
 
-  delete filter;
+  if (!expiries.empty()) {
+    expiryTimer = delay(
+        expiries.top().timeout.remaining(), self(), &Self::expire);
+  }
 }
 
 
@@ -1052,11 +2130,13 @@ bool
 HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::isFiltered(
     const FrameworkID& frameworkId,
     const SlaveID& slaveId,
-    const Resources& resources)
+    const CompactResources& resources)
 {
   CHECK(frameworks.contains(frameworkId));
   CHECK(slaves.contains(slaveId));
 
+  ++metrics.filter_checks;
+
   // Do not offer a non-checkpointing slave's resources to a checkpointing
   // framework. This is a short term fix until the following is resolved:
   // https://issues.apache.org/jira/browse/MESOS-444.
@@ -1064,15 +2144,19 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::isFiltered(
     VLOG(1) << "Filtered " << resources
             << " on non-checkpointing slave " << slaveId
             << " for checkpointing framework " << frameworkId;
+    ++metrics.filtered;
     return true;
   }
 
-  foreach (Filter* filter, frameworks[frameworkId].filters) {
-    if (filter->filter(slaveId, resources)) {
-      VLOG(1) << "Filtered " << resources
-              << " on slave " << slaveId
-              << " for framework " << frameworkId;
-      return true;
+  if (frameworks[frameworkId].filters.contains(slaveId)) {
+    foreach (Filter* filter, frameworks[frameworkId].filters[slaveId]) {
+      if (filter->filter(slaveId, resources)) {
+        VLOG(1) << "Filtered " << resources
+                << " on slave " << slaveId
+                << " for framework " << frameworkId;
+        ++metrics.filtered;
+        return true;
+      }
     }
   }
   return false;
@@ -1080,9 +2164,10 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::isFiltered(
 
 
 template <class RoleSorter, class FrameworkSorter>
+template <typename T>
 bool
 HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::allocatable(
-    const Resources& resources)
+    const T& resources)
 {
   Option<double> cpus = resources.cpus();
   Option<Bytes> mem = resources.mem();
@@ -1091,6 +2176,148 @@ HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::allocatable(
          (mem.isSome() && mem.get() >= MIN_MEM);
 }
 
+
+template <class RoleSorter, class FrameworkSorter>
+void
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::updateAllocatable(
+    const SlaveID& slaveId)
+{
+  CHECK(slaves.contains(slaveId));
+
+  // NOTE: Any resources offered to a framework are a subset of the
+  // available resources, so if the available resources are not
+  // allocatable, neither are the resources offered to any framework.
+  if (allocatable(slaves[slaveId].total - slaves[slaveId].allocated)) {
+    allocatableSlaves.insert(slaveId);
+  } else {
+    allocatableSlaves.erase(slaveId);
+  }
+}
+
+
+template <class RoleSorter, class FrameworkSorter>
+std::vector<typename HierarchicalAllocatorProcess<
+    RoleSorter, FrameworkSorter>::Proposal>
+HierarchicalAllocatorProcess<RoleSorter, FrameworkSorter>::Worker::allocate(
+    const process::Shared<Snapshot>& snapshot,
+    const std::vector<Candidate>& candidates)
+{
+  typedef std::list<FrameworkID> Frameworks;
+  typedef std::list<std::pair<std::string, Frameworks>> Roles;
+
+  // Our own copy of the ordering, which we update as we allocate.
+  Roles roles;
+
+  typedef std::pair<std::string, std::vector<FrameworkID>> Role;
+  foreach (const Role& role, snapshot->roles) {
+    roles.push_back(std::make_pair(
+        role.first,
+        Frameworks(role.second.begin(), role.second.end())));
+  }
+
+  std::vector<Proposal> proposals;
+
+  foreach (const Candidate& candidate, candidates) {
+    Resources available = candidate.total - candidate.allocated;
+
+    // The roles and frameworks allocated to on this slave, which are
+    // moved to the back of the ordering once we are done with it.
+    std::vector<typename Roles::iterator> chosenRoles;
+    std::vector<std::pair<Frameworks*, Frameworks::iterator>> chosen;
+
+    for (typename Roles::iterator role = roles.begin();
+         role != roles.end();
+         ++role) {
+      bool allocated = false;
+
+      // See 'HierarchicalAllocatorProcess::allocate()'.
+      Resources roleResources;
+      Resources nonRevocable;
+
+      auto calculate = [&]() {
+        // NOTE: Currently, frameworks are allowed to have '*' role.
+        // Calling reserved('*') returns an empty Resources object.
+        roleResources =
+          available.unreserved() + available.reserved(role->first);
+        nonRevocable = roleResources - roleResources.revocable();
+      };
+
+      calculate();
+
+      for (Frameworks::iterator frameworkId = role->second.begin();
+           frameworkId != role->second.end();
+           ++frameworkId) {
+        const typename Snapshot::Framework& framework =
+          snapshot->frameworks.at(*frameworkId);
+
+        // Remove revocable resources if the framework has not opted
+        // for them.
+        const Resources& resources =
+          framework.revocable ? roleResources : nonRevocable;
+
+        // If the resources are not allocatable, ignore.
+        if (!HierarchicalAllocatorProcess::allocatable(resources)) {
+          continue;
+        }
+
+        // If the framework filters these resources, ignore. See
+        // 'HierarchicalAllocatorProcess::isFiltered()'.
+        ++filterChecks;
+
+        if (framework.checkpoint && !candidate.checkpoint) {
+          ++filterHits;
+          continue;
+        }
+
+        bool filtered = false;
+        if (framework.filters.contains(candidate.slaveId)) {
+          foreach (Filter* filter, framework.filters.at(candidate.slaveId)) {
+            if (filter->filter(candidate.slaveId, resources)) {
+              filtered = true;
+              break;
+            }
+          }
+        }
+
+        if (filtered) {
+          ++filterHits;
+          continue;
+        }
+
+        Proposal proposal;
+        proposal.frameworkId = *frameworkId;
+        proposal.slaveId = candidate.slaveId;
+        proposal.resources = resources;
+
+        proposals.push_back(proposal);
+
+        available -= resources;
+
+        calculate();
+
+        chosen.push_back(std::make_pair(&role->second, frameworkId));
+        allocated = true;
+      }
+
+      if (allocated) {
+        chosenRoles.push_back(role);
+      }
+    }
+
+    typedef std::pair<Frameworks*, Frameworks::iterator> Chosen;
+    foreach (const Chosen& framework, chosen) {
+      framework.first->splice(
+          framework.first->end(), *framework.first, framework.second);
+    }
+
+    foreach (const typename Roles::iterator& role, chosenRoles) {
+      roles.splice(roles.end(), roles, role);
+    }
+  }
+
+  return proposals;
+}
+
 } // namespace allocator {
 } // namespace master {
 } // namespace internal {
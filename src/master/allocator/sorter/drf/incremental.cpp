@@ -0,0 +1,507 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "logging/logging.hpp"
+
+#include "master/allocator/sorter/drf/incremental.hpp"
+
+using std::list;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+bool IncrementalDRFSorter::EntryComparator::operator () (
+    const Entry& left,
+    const Entry& right) const
+{
+  if (left.share == right.share) {
+    if (left.allocations == right.allocations) {
+      return *left.name < *right.name;
+    }
+    return left.allocations < right.allocations;
+  }
+  return left.share < right.share;
+}
+
+
+IncrementalDRFSorter::IncrementalDRFSorter()
+  : reorder(false) {}
+
+
+void IncrementalDRFSorter::add(const string& name, double weight)
+{
+  CHECK(!handles.contains(name)) << "Client '" << name << "' already exists";
+
+  Handle handle;
+  if (!free.empty()) {
+    handle = free.back();
+    free.pop_back();
+  } else {
+    handle = clients.size();
+    clients.push_back(Client());
+  }
+
+  Client& client = clients[handle];
+  client.name = name;
+  client.weight = weight;
+  client.active = false;
+  client.resources.clear();
+  client.scalars = CompactResources(&index, Resources());
+  client.quantities.clear();
+
+  handles[name] = handle;
+
+  insert(handle, 0, 0);
+}
+
+
+void IncrementalDRFSorter::remove(const string& name)
+{
+  if (!handles.contains(name)) {
+    return;
+  }
+
+  Handle handle = handles[name];
+
+  erase(handle);
+
+  Client& client = clients[handle];
+  client.name.clear();
+  client.resources.clear();
+  client.scalars = CompactResources();
+
+  holders.erase(handle);
+
+  handles.erase(name);
+  free.push_back(handle);
+}
+
+
+void IncrementalDRFSorter::activate(const string& name)
+{
+  CHECK(handles.contains(name));
+
+  Handle handle = handles[name];
+
+  if (!clients[handle].active) {
+    insert(handle, calculateShare(clients[handle]), 0);
+  }
+}
+
+
+void IncrementalDRFSorter::deactivate(const string& name)
+{
+  if (handles.contains(name)) {
+    // NOTE: Like the DRFSorter, we lose the number of allocations
+    // for this client when it gets deactivated.
+    erase(handles[name]);
+  }
+}
+
+
+void IncrementalDRFSorter::allocated(
+    const string& name,
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  Client& client = this->client(name);
+
+  client.resources[slaveId] += resources;
+  client.quantities.add(
+      &client.scalars, CompactResources(&index, resources.scalars()));
+
+  track(handles[name]);
+  reposition(handles[name], true);
+}
+
+
+void IncrementalDRFSorter::update(
+    const string& name,
+    const SlaveID& slaveId,
+    const Resources& oldAllocation,
+    const Resources& newAllocation)
+{
+  Client& client = this->client(name);
+
+  const CompactResources oldScalars(&index, oldAllocation.scalars());
+  const CompactResources newScalars(&index, newAllocation.scalars());
+
+  CHECK(total.resources[slaveId].contains(oldAllocation));
+  CHECK(total.scalars.contains(oldScalars));
+
+  total.resources[slaveId] -= oldAllocation;
+  total.resources[slaveId] += newAllocation;
+
+  total.quantities.subtract(&total.scalars, oldScalars);
+  total.quantities.add(&total.scalars, newScalars);
+
+  changed(oldScalars);
+  changed(newScalars);
+
+  CHECK(client.resources[slaveId].contains(oldAllocation));
+  CHECK(client.scalars.contains(oldScalars));
+
+  client.resources[slaveId] -= oldAllocation;
+  client.resources[slaveId] += newAllocation;
+
+  client.quantities.subtract(&client.scalars, oldScalars);
+  client.quantities.add(&client.scalars, newScalars);
+
+  track(handles[name]);
+  reposition(handles[name], false);
+}
+
+
+hashmap<SlaveID, Resources> IncrementalDRFSorter::allocation(
+    const string& name)
+{
+  return client(name).resources;
+}
+
+
+Resources IncrementalDRFSorter::allocation(
+    const string& name,
+    const SlaveID& slaveId)
+{
+  const Client& client = this->client(name);
+
+  if (client.resources.contains(slaveId)) {
+    return client.resources.at(slaveId);
+  }
+
+  return Resources();
+}
+
+
+void IncrementalDRFSorter::unallocated(
+    const string& name,
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  Client& client = this->client(name);
+
+  client.resources[slaveId] -= resources;
+  client.quantities.subtract(
+      &client.scalars, CompactResources(&index, resources.scalars()));
+
+  if (client.resources[slaveId].empty()) {
+    client.resources.erase(slaveId);
+  }
+
+  track(handles[name]);
+  reposition(handles[name], false);
+}
+
+
+void IncrementalDRFSorter::add(const SlaveID& slaveId, const Resources& resources)
+{
+  if (!resources.empty()) {
+    const CompactResources scalars(&index, resources.scalars());
+
+    total.resources[slaveId] += resources;
+    total.quantities.add(&total.scalars, scalars);
+
+    // We have to recalculate the shares of the clients holding these
+    // resources, but we put it off until the clients are ordered.
+    changed(scalars);
+  }
+}
+
+
+void IncrementalDRFSorter::remove(
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  if (!resources.empty()) {
+    CHECK(total.resources.contains(slaveId));
+
+    const CompactResources scalars(&index, resources.scalars());
+
+    total.resources[slaveId] -= resources;
+    total.quantities.subtract(&total.scalars, scalars);
+
+    if (total.resources[slaveId].empty()) {
+      total.resources.erase(slaveId);
+    }
+
+    changed(scalars);
+  }
+}
+
+
+void IncrementalDRFSorter::update(
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  const CompactResources oldScalars(
+      &index, total.resources[slaveId].scalars());
+
+  CHECK(total.scalars.contains(oldScalars));
+
+  const CompactResources newScalars(&index, resources.scalars());
+
+  total.quantities.subtract(&total.scalars, oldScalars);
+  total.quantities.add(&total.scalars, newScalars);
+
+  total.resources[slaveId] = resources;
+
+  if (total.resources[slaveId].empty()) {
+    total.resources.erase(slaveId);
+  }
+
+  changed(oldScalars);
+  changed(newScalars);
+}
+
+
+list<string> IncrementalDRFSorter::sort()
+{
+  list<string> result;
+
+  foreach (Handle handle, order()) {
+    result.push_back(clients[handle].name);
+  }
+
+  return result;
+}
+
+
+bool IncrementalDRFSorter::contains(const string& name)
+{
+  return handles.contains(name);
+}
+
+
+int IncrementalDRFSorter::count()
+{
+  return handles.size();
+}
+
+
+const vector<IncrementalDRFSorter::Handle>& IncrementalDRFSorter::order()
+{
+  if (!stale.empty()) {
+    // The totals of some resources have changed. Clients that have
+    // not been allocated any of them keep their shares, and of the
+    // others we only move those whose shares actually changed.
+    vector<std::pair<Handle, double>> changes;
+
+    foreach (Handle handle, holders) {
+      const Client& client = clients[handle];
+
+      if (!client.active) {
+        continue;
+      }
+
+      bool affected = false;
+      foreach (size_t name, stale) {
+        if (client.quantities.get(name) > 0.0) {
+          affected = true;
+          break;
+        }
+      }
+
+      if (!affected) {
+        continue;
+      }
+
+      const double share = calculateShare(client);
+      if (share != client.entry->share) {
+        changes.push_back(std::make_pair(handle, share));
+      }
+    }
+
+    // Moving a client costs about as much as inserting two, so if
+    // most of the clients have to move we rebuild the sorted entries
+    // in one pass instead. The clients that have not been affected
+    // get the same shares again.
+    if (changes.size() * 2 > entries.size()) {
+      Entries temp;
+
+      foreach (const Entry& entry, entries) {
+        Client& client = clients[entry.handle];
+
+        client.entry = temp.insert(Entry(
+            calculateShare(client),
+            entry.allocations,
+            &client.name,
+            entry.handle)).first;
+      }
+
+      entries.swap(temp);
+      reorder = true;
+    } else {
+      typedef std::pair<Handle, double> Change;
+      foreach (const Change& change, changes) {
+        move(change.first,
+             change.second,
+             clients[change.first].entry->allocations);
+      }
+    }
+
+    stale.clear();
+  }
+
+  if (reorder) {
+    ordered.clear();
+    ordered.reserve(entries.size());
+
+    foreach (const Entry& entry, entries) {
+      ordered.push_back(entry.handle);
+    }
+
+    reorder = false;
+  }
+
+  return ordered;
+}
+
+
+Option<IncrementalDRFSorter::Handle> IncrementalDRFSorter::handle(
+    const string& name) const
+{
+  if (handles.contains(name)) {
+    return handles.at(name);
+  }
+
+  return None();
+}
+
+
+const string& IncrementalDRFSorter::name(Handle handle) const
+{
+  CHECK_LT(handle, clients.size());
+
+  return clients[handle].name;
+}
+
+
+IncrementalDRFSorter::Client& IncrementalDRFSorter::client(const string& name)
+{
+  CHECK(handles.contains(name)) << "Unknown client '" << name << "'";
+
+  return clients[handles[name]];
+}
+
+
+void IncrementalDRFSorter::insert(
+    Handle handle,
+    double share,
+    uint64_t allocations)
+{
+  Client& client = clients[handle];
+
+  CHECK(!client.active);
+
+  client.entry =
+    entries.insert(Entry(share, allocations, &client.name, handle)).first;
+  client.active = true;
+
+  reorder = true;
+}
+
+
+void IncrementalDRFSorter::erase(Handle handle)
+{
+  Client& client = clients[handle];
+
+  if (client.active) {
+    entries.erase(client.entry);
+    client.active = false;
+
+    reorder = true;
+  }
+}
+
+
+void IncrementalDRFSorter::reposition(Handle handle, bool chosen)
+{
+  const Client& client = clients[handle];
+
+  if (!client.active) {
+    return;
+  }
+
+  uint64_t allocations = client.entry->allocations;
+
+  if (chosen) {
+    allocations++;
+  }
+
+  move(handle, calculateShare(client), allocations);
+}
+
+
+void IncrementalDRFSorter::move(
+    Handle handle,
+    double share,
+    uint64_t allocations)
+{
+  Client& client = clients[handle];
+
+  CHECK(client.active);
+
+  entries.erase(client.entry);
+  client.entry =
+    entries.insert(Entry(share, allocations, &client.name, handle)).first;
+
+  reorder = true;
+}
+
+
+void IncrementalDRFSorter::track(Handle handle)
+{
+  if (clients[handle].scalars.empty()) {
+    holders.erase(handle);
+  } else {
+    holders.insert(handle);
+  }
+}
+
+
+void IncrementalDRFSorter::changed(const CompactResources& scalars)
+{
+  // NOTE: 'sum()' only touches the quantities of the names that the
+  // scalars hold, which are the ones we are looking for.
+  vector<double> quantities;
+  scalars.sum(&quantities);
+
+  for (size_t name = 0; name < quantities.size(); name++) {
+    if (quantities[name] > 0.0) {
+      stale.insert(name);
+    }
+  }
+}
+
+
+double IncrementalDRFSorter::calculateShare(const Client& client) const
+{
+  // TODO(benh): This implementation of "dominant resource fairness"
+  // currently does not take into account resources that are not
+  // scalars.
+  return client.quantities.share(total.quantities) / client.weight;
+}
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
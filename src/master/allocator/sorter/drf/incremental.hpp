@@ -0,0 +1,251 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MASTER_ALLOCATOR_SORTER_DRF_INCREMENTAL_HPP__
+#define __MASTER_ALLOCATOR_SORTER_DRF_INCREMENTAL_HPP__
+
+#include <deque>
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mesos/resources.hpp>
+
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/option.hpp>
+
+#include "master/allocator/compact.hpp"
+
+#include "master/allocator/sorter/sorter.hpp"
+
+#include "master/allocator/sorter/drf/scalars.hpp"
+
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+// A DRF sorter that keeps its clients ordered incrementally instead
+// of rebuilding the ordering on every call to 'sort()'. It produces
+// exactly the same ordering as the DRFSorter, i.e., clients are
+// ordered by (share, allocations, name).
+//
+// Clients are identified internally by integer handles which index
+// into a vector of per-client state, so that looking up a client is
+// a hash lookup rather than a scan over the sorted clients. The
+// sorted clients are kept in an ordered set keyed by share; updating
+// a client's share is O(log n), and iterating the ordering does not
+// copy any client names (see 'order()').
+//
+// When the total resources change, only the clients that have been
+// allocated resources with a changed total get their shares
+// recalculated, and only those whose share actually changed are
+// moved in the ordering (unless most clients have to move, in which
+// case the ordering is rebuilt in one pass).
+class IncrementalDRFSorter : public Sorter
+{
+public:
+  typedef size_t Handle;
+
+  IncrementalDRFSorter();
+
+  virtual ~IncrementalDRFSorter() {}
+
+  virtual void add(const std::string& name, double weight = 1);
+
+  virtual void remove(const std::string& name);
+
+  virtual void activate(const std::string& name);
+
+  virtual void deactivate(const std::string& name);
+
+  virtual void allocated(
+      const std::string& name,
+      const SlaveID& slaveId,
+      const Resources& resources);
+
+  virtual void update(
+      const std::string& name,
+      const SlaveID& slaveId,
+      const Resources& oldAllocation,
+      const Resources& newAllocation);
+
+  virtual void unallocated(
+      const std::string& name,
+      const SlaveID& slaveId,
+      const Resources& resources);
+
+  virtual hashmap<SlaveID, Resources> allocation(const std::string& name);
+
+  virtual Resources allocation(const std::string& name, const SlaveID& slaveId);
+
+  virtual void add(const SlaveID& slaveId, const Resources& resources);
+
+  virtual void remove(const SlaveID& slaveId, const Resources& resources);
+
+  virtual void update(const SlaveID& slaveId, const Resources& resources);
+
+  // NOTE: This copies the client names, prefer 'order()' when the
+  // concrete sorter type is known.
+  virtual std::list<std::string> sort();
+
+  virtual bool contains(const std::string& name);
+
+  virtual int count();
+
+  // Returns the handles of the active clients in the order that they
+  // should be allocated to. The returned vector is only rebuilt when
+  // the ordering has changed since the last call, and it is not
+  // modified by any other call. This means it is safe to iterate
+  // over it while invoking 'allocated()' (e.g., during an allocation
+  // cycle) as long as no clients are removed meanwhile.
+  const std::vector<Handle>& order();
+
+  // Returns the handle of the client, if it exists in this sorter.
+  Option<Handle> handle(const std::string& name) const;
+
+  // Returns the name of the client with the given handle.
+  const std::string& name(Handle handle) const;
+
+private:
+  struct Entry
+  {
+    Entry(double _share, uint64_t _allocations, const std::string* _name,
+          Handle _handle)
+      : share(_share),
+        allocations(_allocations),
+        name(_name),
+        handle(_handle) {}
+
+    double share;
+    uint64_t allocations;
+
+    // Points to the name stored in the client state, which is stable
+    // for the lifetime of the client (see 'clients' below).
+    const std::string* name;
+
+    Handle handle;
+  };
+
+  struct EntryComparator
+  {
+    bool operator () (const Entry& left, const Entry& right) const;
+  };
+
+  typedef std::set<Entry, EntryComparator> Entries;
+
+  struct Client
+  {
+    std::string name;
+    double weight;
+
+    // Whether the client is currently part of the sort.
+    bool active;
+
+    // Valid only if 'active' is true.
+    Entries::iterator entry;
+
+    hashmap<SlaveID, Resources> resources;
+
+    // We aggregate scalars across slaves, see DRFSorter. The scalars
+    // are kept in compact form so that the arithmetic on them is
+    // cheap, see CompactResources.
+    CompactResources scalars;
+    ScalarQuantities quantities;
+  };
+
+  // Returns the client with the given name, which must exist.
+  Client& client(const std::string& name);
+
+  // Inserts the client into the sorted entries with the given share
+  // and allocation count.
+  void insert(Handle handle, double share, uint64_t allocations);
+
+  // Removes the client from the sorted entries, if it is active.
+  void erase(Handle handle);
+
+  // Recalculates the share for the client and moves it in 'entries'
+  // accordingly. If 'chosen' is true, the number of times the client
+  // has been chosen for allocation is incremented as well.
+  void reposition(Handle handle, bool chosen);
+
+  // Moves the active client in 'entries' to the given share and
+  // allocation count.
+  void move(Handle handle, double share, uint64_t allocations);
+
+  // Updates whether the client is in 'holders', after its
+  // allocation has changed.
+  void track(Handle handle);
+
+  // Marks the names of the scalars as 'stale', after the total of
+  // them has changed.
+  void changed(const CompactResources& scalars);
+
+  // Returns the dominant resource share for the client.
+  double calculateShare(const Client& client) const;
+
+  // Assigns the slots of the compact scalars below, and interns the
+  // resource names used by the quantities.
+  CompactResources::Index index;
+
+  // The ids of the resource names whose totals have changed since
+  // the shares were last updated, see 'order()'.
+  hashset<size_t> stale;
+
+  // The clients that have been allocated scalar resources, i.e., the
+  // clients whose shares can depend on the total resources.
+  hashset<Handle> holders;
+
+  // If true, 'ordered' needs to be rebuilt from 'entries'.
+  bool reorder;
+
+  // Per-client state, indexed by handle. Handles of removed clients
+  // are recycled through 'free'. NOTE: We use a deque because
+  // appending to it does not invalidate references to the existing
+  // clients, which the sorted entries rely on.
+  std::deque<Client> clients;
+  std::vector<Handle> free;
+
+  hashmap<std::string, Handle> handles;
+
+  // The active clients sorted by share.
+  Entries entries;
+
+  // Cached ordering of the active clients, see 'order()'.
+  std::vector<Handle> ordered;
+
+  // Total resources.
+  struct Total {
+    hashmap<SlaveID, Resources> resources;
+
+    // NOTE: Scalars can be safely aggregated across slaves, see
+    // DRFSorter.
+    CompactResources scalars;
+    ScalarQuantities quantities;
+  } total;
+};
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ALLOCATOR_SORTER_DRF_INCREMENTAL_HPP__
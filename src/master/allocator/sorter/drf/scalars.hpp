@@ -0,0 +1,96 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MASTER_ALLOCATOR_SORTER_DRF_SCALARS_HPP__
+#define __MASTER_ALLOCATOR_SORTER_DRF_SCALARS_HPP__
+
+#include <algorithm>
+#include <vector>
+
+#include "master/allocator/compact.hpp"
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+// Scalar resource quantities aggregated by resource name (e.g., all
+// 'disk' regardless of role or persistence), stored as plain doubles
+// so that the dominant share can be computed without walking
+// protobufs. The quantities are kept up to date with the scalars
+// they are aggregated from by changing both through 'add()' and
+// 'subtract()', which only touch the names that change.
+class ScalarQuantities
+{
+public:
+  // Adds 'resources' to 'scalars' and their quantities to these
+  // quantities. The names are interned by the index of the
+  // resources, see 'CompactResources::Index::name()'.
+  void add(CompactResources* scalars, const CompactResources& resources)
+  {
+    *scalars += resources;
+    resources.sum(&values);
+  }
+
+  // Subtracts 'resources' from 'scalars' and whatever that removed
+  // from these quantities. This retains the semantics of 'Resources'
+  // arithmetic (e.g., subtracting resources that are not present is
+  // a no-op) without recomputing the quantities from 'scalars'.
+  void subtract(CompactResources* scalars, const CompactResources& resources)
+  {
+    scalars->subtract(resources, &values);
+  }
+
+  void clear()
+  {
+    std::fill(values.begin(), values.end(), 0.0);
+  }
+
+  // Returns the quantity of the resource name with the given id.
+  double get(size_t name) const
+  {
+    return name < values.size() ? values[name] : 0.0;
+  }
+
+  // Returns the maximum share across all resource names of these
+  // quantities relative to the 'total' quantities. Names for which
+  // there is no total are ignored.
+  double share(const ScalarQuantities& total) const
+  {
+    double result = 0.0;
+
+    const size_t size = std::min(values.size(), total.values.size());
+    for (size_t i = 0; i < size; i++) {
+      if (total.values[i] > 0.0) {
+        result = std::max(result, values[i] / total.values[i]);
+      }
+    }
+
+    return result;
+  }
+
+private:
+  std::vector<double> values;
+};
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ALLOCATOR_SORTER_DRF_SCALARS_HPP__
@@ -107,7 +107,9 @@ void DRFSorter::allocated(
   }
 
   allocations[name].resources[slaveId] += resources;
-  allocations[name].scalars += resources.scalars();
+  allocations[name].quantities.add(
+      &allocations[name].scalars,
+      CompactResources(&index, resources.scalars()));
 
   // If the total resources have changed, we're going to
   // recalculate all the shares, so don't bother just
@@ -131,23 +133,27 @@ void DRFSorter::update(
   // Otherwise, we need to ensure we re-calculate the shares, as
   // is being currently done, for safety.
 
+  const CompactResources oldScalars(&index, oldAllocation.scalars());
+  const CompactResources newScalars(&index, newAllocation.scalars());
+
   CHECK(total.resources[slaveId].contains(oldAllocation));
-  CHECK(total.scalars.contains(oldAllocation.scalars()));
+  CHECK(total.scalars.contains(oldScalars));
 
   total.resources[slaveId] -= oldAllocation;
   total.resources[slaveId] += newAllocation;
 
-  total.scalars -= oldAllocation.scalars();
-  total.scalars += newAllocation.scalars();
+  total.quantities.subtract(&total.scalars, oldScalars);
+  total.quantities.add(&total.scalars, newScalars);
 
   CHECK(allocations[name].resources[slaveId].contains(oldAllocation));
-  CHECK(allocations[name].scalars.contains(oldAllocation.scalars()));
+  CHECK(allocations[name].scalars.contains(oldScalars));
 
   allocations[name].resources[slaveId] -= oldAllocation;
   allocations[name].resources[slaveId] += newAllocation;
 
-  allocations[name].scalars -= oldAllocation.scalars();
-  allocations[name].scalars += newAllocation.scalars();
+  allocations[name].quantities.subtract(
+      &allocations[name].scalars, oldScalars);
+  allocations[name].quantities.add(&allocations[name].scalars, newScalars);
 
   // Just assume the total has changed, per the TODO above.
   dirty = true;
@@ -180,7 +186,9 @@ void DRFSorter::unallocated(
     const Resources& resources)
 {
   allocations[name].resources[slaveId] -= resources;
-  allocations[name].scalars -= resources.scalars();
+  allocations[name].quantities.subtract(
+      &allocations[name].scalars,
+      CompactResources(&index, resources.scalars()));
 
   if (allocations[name].resources[slaveId].empty()) {
     allocations[name].resources.erase(slaveId);
@@ -196,7 +204,8 @@ void DRFSorter::add(const SlaveID& slaveId, const Resources& resources)
 {
   if (!resources.empty()) {
     total.resources[slaveId] += resources;
-    total.scalars += resources.scalars();
+    total.quantities.add(
+        &total.scalars, CompactResources(&index, resources.scalars()));
 
     // We have to recalculate all shares when the total resources
     // change, but we put it off until sort is called so that if
@@ -213,7 +222,8 @@ void DRFSorter::remove(const SlaveID& slaveId, const Resources& resources)
     CHECK(total.resources.contains(slaveId));
 
     total.resources[slaveId] -= resources;
-    total.scalars -= resources.scalars();
+    total.quantities.subtract(
+        &total.scalars, CompactResources(&index, resources.scalars()));
 
     if (total.resources[slaveId].empty()) {
       total.resources.erase(slaveId);
@@ -226,10 +236,14 @@ void DRFSorter::remove(const SlaveID& slaveId, const Resources& resources)
 
 void DRFSorter::update(const SlaveID& slaveId, const Resources& resources)
 {
-  CHECK(total.scalars.contains(total.resources[slaveId].scalars()));
+  const CompactResources oldScalars(
+      &index, total.resources[slaveId].scalars());
+
+  CHECK(total.scalars.contains(oldScalars));
 
-  total.scalars -= total.resources[slaveId].scalars();
-  total.scalars += resources.scalars();
+  total.quantities.subtract(&total.scalars, oldScalars);
+  total.quantities.add(
+      &total.scalars, CompactResources(&index, resources.scalars()));
 
   total.resources[slaveId] = resources;
 
@@ -257,6 +271,7 @@ list<string> DRFSorter::sort()
     }
 
     clients = temp;
+    dirty = false;
   }
 
   list<string> result;
@@ -301,38 +316,15 @@ void DRFSorter::update(const string& name)
 
 double DRFSorter::calculateShare(const string& name)
 {
-  double share = 0.0;
-
   // TODO(benh): This implementation of "dominant resource fairness"
   // currently does not take into account resources that are not
   // scalars.
-
-  foreach (const string& scalar, total.scalars.names()) {
-    double _total = 0.0;
-
-    // NOTE: Scalar resources may be spread across multiple
-    // 'Resource' objects. E.g. persistent volumes.
-    foreach (const Resource& resource, total.scalars.get(scalar)) {
-      CHECK_EQ(resource.type(), Value::SCALAR);
-      _total += resource.scalar().value();
-    }
-
-    if (_total > 0.0) {
-      double allocation = 0.0;
-
-      // NOTE: Scalar resources may be spread across multiple
-      // 'Resource' objects. E.g. persistent volumes.
-      foreach (const Resource& resource,
-               allocations[name].scalars.get(scalar)) {
-        CHECK_EQ(resource.type(), Value::SCALAR);
-        allocation += resource.scalar().value();
-      }
-
-      share = std::max(share, allocation / _total);
-    }
-  }
-
-  return share / weights[name];
+  //
+  // NOTE: Scalar resources may be spread across multiple 'Resource'
+  // objects (e.g. persistent volumes), these are summed up by name
+  // in the quantities.
+  return allocations[name].quantities.share(total.quantities) /
+         weights[name];
 }
 
 
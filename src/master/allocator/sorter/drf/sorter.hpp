@@ -26,8 +26,12 @@
 
 #include <stout/hashmap.hpp>
 
+#include "master/allocator/compact.hpp"
+
 #include "master/allocator/sorter/sorter.hpp"
 
+#include "master/allocator/sorter/drf/scalars.hpp"
+
 
 namespace mesos {
 namespace internal {
@@ -63,6 +67,8 @@ struct DRFComparator
 class DRFSorter : public Sorter
 {
 public:
+  DRFSorter() : dirty(false) {}
+
   virtual ~DRFSorter() {}
 
   virtual void add(const std::string& name, double weight = 1);
@@ -113,6 +119,10 @@ private:
   // Returns the dominant resource share for the client.
   double calculateShare(const std::string& name);
 
+  // Assigns the slots of the compact scalars below, and interns the
+  // resource names used by the quantities.
+  CompactResources::Index index;
+
   // Returns an iterator to the specified client, if
   // it exists in this Sorter.
   std::set<Client, DRFComparator>::iterator find(const std::string& name);
@@ -132,8 +142,13 @@ private:
 
     // NOTE: Scalars can be safely aggregated across slaves. We keep
     // that to speed up the calculation of shares. See MESOS-2891 for
-    // the reasons why we want to do that.
-    Resources scalars;
+    // the reasons why we want to do that. The scalars are kept in
+    // compact form, so that updating them does not touch protobufs.
+    CompactResources scalars;
+
+    // The aggregated 'scalars' by resource name, kept up to date so
+    // that calculating a share is a loop over doubles.
+    ScalarQuantities quantities;
   } total;
 
   // Allocation for a client.
@@ -141,7 +156,9 @@ private:
     hashmap<SlaveID, Resources> resources;
 
     // Similarly, we aggregated scalars across slaves. See note above.
-    Resources scalars;
+    CompactResources scalars;
+
+    ScalarQuantities quantities;
   };
 
   // Maps client names to the resources they have been allocated.
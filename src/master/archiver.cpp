@@ -0,0 +1,471 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <leveldb/db.h>
+#include <leveldb/write_batch.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <mesos/type_utils.hpp>
+
+#include <process/help.hpp>
+#include <process/id.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/json.hpp>
+#include <stout/none.hpp>
+#include <stout/numify.hpp>
+#include <stout/result.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+#include <stout/try.hpp>
+
+#include "common/http.hpp"
+
+#include "master/archiver.hpp"
+#include "master/constants.hpp"
+#include "master/replica.hpp"
+
+using process::DESCRIPTION;
+using process::Future;
+using process::HELP;
+using process::TLDR;
+using process::USAGE;
+
+using process::http::BadRequest;
+using process::http::InternalServerError;
+using process::http::OK;
+
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+// Pull in model overrides from common.
+using mesos::internal::model;
+
+// Pull in definitions from process.
+using process::http::Response;
+using process::http::Request;
+
+
+// The prefixes of the keys of the archive:
+//   tasks/<sequence>                         -> Task
+//   frameworks/<sequence>                    -> StateResponse::Framework
+//   framework-tasks/<framework>/<sequence>   -> tasks/<sequence>
+//   task-ids/<framework>/<task>              -> tasks/<sequence>
+static const string TASKS = "tasks/";
+static const string FRAMEWORKS = "frameworks/";
+static const string FRAMEWORK_TASKS = "framework-tasks/";
+static const string TASK_IDS = "task-ids/";
+
+
+// Returns the sequence number padded with zeros, so that the keys
+// sort in the order of their sequence numbers.
+static string pad(uint64_t sequence)
+{
+  const string digits = stringify(sequence);
+  return string(std::max<size_t>(20, digits.size()) - digits.size(), '0') +
+    digits;
+}
+
+
+// Returns the first key after all of the keys with the given prefix,
+// which must end with a '/'.
+static string end(const string& prefix)
+{
+  CHECK(strings::endsWith(prefix, "/"));
+  return prefix.substr(0, prefix.size() - 1) + "0"; // '0' follows '/'.
+}
+
+
+Archiver::Archiver(const string& _path)
+  : ProcessBase(process::ID::generate("archiver")),
+    path(_path),
+    db(NULL),
+    sequence(0) {}
+
+
+Archiver::~Archiver()
+{
+  delete db; // NULL if open failed in Archiver::initialize.
+}
+
+
+void Archiver::initialize()
+{
+  leveldb::Options options;
+  options.create_if_missing = true;
+
+  leveldb::Status status = leveldb::DB::Open(options, path, &db);
+
+  if (!status.ok()) {
+    error = status.ToString();
+    LOG(ERROR) << "Failed to open the archive at '" << path << "': "
+               << error.get();
+    return;
+  }
+
+  // Recover the sequence number of the last record.
+  leveldb::Iterator* iterator = db->NewIterator(leveldb::ReadOptions());
+
+  const string prefixes[] = {TASKS, FRAMEWORKS};
+
+  foreach (const string& prefix, prefixes) {
+    iterator->Seek(end(prefix));
+
+    if (iterator->Valid()) {
+      iterator->Prev();
+    } else {
+      iterator->SeekToLast();
+    }
+
+    if (iterator->Valid() && iterator->key().starts_with(prefix)) {
+      const string key = iterator->key().ToString();
+
+      Try<uint64_t> last = numify<uint64_t>(key.substr(prefix.size()));
+      if (last.isError()) {
+        // NOTE: We do not archive anything as we could overwrite the
+        // existing records otherwise.
+        error = "Invalid key '" + key + "'";
+        LOG(ERROR) << "Failed to recover the archive at '" << path << "': "
+                   << error.get();
+
+        delete iterator;
+        return;
+      }
+
+      sequence = std::max(sequence, last.get());
+    }
+  }
+
+  delete iterator;
+
+  LOG(INFO) << "Opened the archive at '" << path << "' with "
+            << sequence << " records";
+}
+
+
+void Archiver::addTask(const Task& task)
+{
+  if (error.isSome()) {
+    return;
+  }
+
+  const string id =
+    TASK_IDS + task.framework_id().value() + "/" + task.task_id().value();
+
+  string value;
+  leveldb::Status status = db->Get(leveldb::ReadOptions(), id, &value);
+
+  if (status.ok()) {
+    VLOG(1) << "Skipping task " << task.task_id() << " of framework "
+            << task.framework_id() << " as it has been archived already";
+    return;
+  } else if (!status.IsNotFound()) {
+    LOG(ERROR) << "Failed to archive task " << task.task_id()
+               << " of framework " << task.framework_id() << ": "
+               << status.ToString();
+    return;
+  }
+
+  append(TASKS,
+         task.SerializeAsString(),
+         {FRAMEWORK_TASKS + task.framework_id().value() + "/"},
+         {id});
+}
+
+
+void Archiver::addFramework(const StateResponse::Framework& framework)
+{
+  if (error.isSome()) {
+    return;
+  }
+
+  append(FRAMEWORKS, framework.SerializeAsString(), {}, {});
+}
+
+
+void Archiver::append(
+    const string& prefix,
+    const string& data,
+    const vector<string>& indices,
+    const vector<string>& aliases)
+{
+  const string suffix = pad(sequence + 1);
+  const string key = prefix + suffix;
+
+  leveldb::WriteBatch batch;
+  batch.Put(key, data);
+
+  foreach (const string& index, indices) {
+    batch.Put(index + suffix, key);
+  }
+
+  foreach (const string& alias, aliases) {
+    batch.Put(alias, key);
+  }
+
+  // NOTE: The writes are not synced since the archive only holds the
+  // history of the cluster: the records that have not been flushed
+  // when the machine crashes are lost, which is acceptable.
+  leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to append '" << key << "' to the archive: "
+               << status.ToString();
+    return;
+  }
+
+  sequence++;
+}
+
+
+// A page of the records of the archive, see 'list()'.
+struct Page
+{
+  // The values of the keys, from the most recent one.
+  vector<string> values;
+
+  // The cursor of the next page, if there are more records.
+  Option<uint64_t> next;
+};
+
+
+// Lists the values of (at most) 'limit' keys with the given prefix,
+// from the one before 'before' (or from the last one).
+static Try<Page> list(
+    leveldb::DB* db,
+    const string& prefix,
+    const Option<uint64_t>& before,
+    size_t limit)
+{
+  CHECK_GT(limit, 0u);
+
+  Page page;
+
+  leveldb::Iterator* iterator = db->NewIterator(leveldb::ReadOptions());
+
+  iterator->Seek(before.isSome() ? prefix + pad(before.get()) : end(prefix));
+
+  if (iterator->Valid()) {
+    iterator->Prev();
+  } else {
+    iterator->SeekToLast();
+  }
+
+  for (; iterator->Valid() && iterator->key().starts_with(prefix);
+       iterator->Prev()) {
+    const string key = iterator->key().ToString();
+    const string suffix = key.substr(prefix.size());
+
+    // Skip the keys of another index that share the prefix, e.g., the
+    // tasks of framework 'a/b' when listing those of framework 'a'.
+    if (strings::contains(suffix, "/")) {
+      continue;
+    }
+
+    Try<uint64_t> sequence = numify<uint64_t>(suffix);
+    if (sequence.isError()) {
+      delete iterator;
+      return Error("Invalid key '" + key + "'");
+    }
+
+    if (page.values.size() == limit) {
+      // The next page starts with this key.
+      page.next = sequence.get() + 1;
+      break;
+    }
+
+    page.values.push_back(iterator->value().ToString());
+  }
+
+  delete iterator;
+
+  return page;
+}
+
+
+// Parses the options of a page of the archive (i.e., 'limit' and
+// 'before') from the query of the request.
+static Try<std::pair<Option<uint64_t>, size_t>> parse(const Request& request)
+{
+  Result<uint64_t> before = numify<uint64_t>(request.query.get("before"));
+  if (before.isError()) {
+    return Error("Failed to parse 'before': " + before.error());
+  }
+
+  Result<size_t> limit = numify<size_t>(request.query.get("limit"));
+  if (limit.isError()) {
+    return Error("Failed to parse 'limit': " + limit.error());
+  } else if (limit.isSome() && limit.get() == 0) {
+    return Error("Invalid 'limit': must be positive");
+  }
+
+  return std::make_pair(
+      before.isSome() ? Option<uint64_t>(before.get()) : None(),
+      limit.isSome() ? limit.get() : TASK_LIMIT);
+}
+
+
+const string Archiver::TASKS_HELP = HELP(
+    TLDR(
+        "Lists the archived tasks."),
+    USAGE(
+        "/master/archived_tasks"),
+    DESCRIPTION(
+        "Lists the completed tasks that were archived (see --archive_dir),",
+        "from the one that completed last.",
+        "",
+        "Query parameters:",
+        "",
+        ">        limit=VALUE          Maximum number of tasks returned "
+        "(default is " + stringify(TASK_LIMIT) + ").",
+        ">        before=VALUE         Starts the task list at this cursor, "
+        "i.e., the 'next' value of the previous page.",
+        ">        framework_id=VALUE   Only lists tasks of this framework."));
+
+
+Future<Response> Archiver::tasks(const Request& request)
+{
+  if (error.isSome()) {
+    return InternalServerError("Failed to open the archive: " + error.get());
+  }
+
+  Try<std::pair<Option<uint64_t>, size_t>> options = parse(request);
+  if (options.isError()) {
+    return BadRequest(options.error());
+  }
+
+  const Option<string> frameworkId = request.query.get("framework_id");
+
+  const Try<Page> page = list(
+      db,
+      frameworkId.isSome() ? FRAMEWORK_TASKS + frameworkId.get() + "/" : TASKS,
+      options.get().first,
+      options.get().second);
+
+  if (page.isError()) {
+    return InternalServerError("Failed to list the archived tasks: " +
+                               page.error());
+  }
+
+  JSON::Array array;
+  array.values.reserve(page.get().values.size()); // MESOS-2353.
+
+  foreach (const string& value, page.get().values) {
+    // The index of the framework's tasks refers to the tasks.
+    string data = value;
+    if (frameworkId.isSome()) {
+      leveldb::Status status = db->Get(leveldb::ReadOptions(), value, &data);
+      if (!status.ok()) {
+        return InternalServerError(
+            "Failed to read '" + value + "': " + status.ToString());
+      }
+    }
+
+    Task task;
+    if (!task.ParseFromString(data)) {
+      return InternalServerError("Failed to deserialize an archived task");
+    }
+
+    array.values.push_back(model(task));
+  }
+
+  JSON::Object object;
+  object.values["tasks"] = std::move(array);
+
+  if (page.get().next.isSome()) {
+    object.values["next"] = page.get().next.get();
+  }
+
+  return OK(object, request.query.get("jsonp"));
+}
+
+
+const string Archiver::FRAMEWORKS_HELP = HELP(
+    TLDR(
+        "Lists the archived frameworks."),
+    USAGE(
+        "/master/archived_frameworks"),
+    DESCRIPTION(
+        "Lists the completed frameworks that were archived (see",
+        "--archive_dir), from the one that completed last. The tasks of",
+        "the frameworks are listed by /master/archived_tasks.",
+        "",
+        "Query parameters:",
+        "",
+        ">        limit=VALUE          Maximum number of frameworks returned "
+        "(default is " + stringify(TASK_LIMIT) + ").",
+        ">        before=VALUE         Starts the framework list at this "
+        "cursor, i.e., the 'next' value of the previous page."));
+
+
+Future<Response> Archiver::frameworks(const Request& request)
+{
+  if (error.isSome()) {
+    return InternalServerError("Failed to open the archive: " + error.get());
+  }
+
+  Try<std::pair<Option<uint64_t>, size_t>> options = parse(request);
+  if (options.isError()) {
+    return BadRequest(options.error());
+  }
+
+  const Try<Page> page =
+    list(db, FRAMEWORKS, options.get().first, options.get().second);
+
+  if (page.isError()) {
+    return InternalServerError("Failed to list the archived frameworks: " +
+                               page.error());
+  }
+
+  JSON::Array array;
+  array.values.reserve(page.get().values.size()); // MESOS-2353.
+
+  foreach (const string& data, page.get().values) {
+    StateResponse::Framework framework;
+    if (!framework.ParseFromString(data)) {
+      return InternalServerError(
+          "Failed to deserialize an archived framework");
+    }
+
+    array.values.push_back(model(framework));
+  }
+
+  JSON::Object object;
+  object.values["frameworks"] = std::move(array);
+
+  if (page.get().next.isSome()) {
+    object.values["next"] = page.get().next.get();
+  }
+
+  return OK(object, request.query.get("jsonp"));
+}
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
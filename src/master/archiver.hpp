@@ -0,0 +1,112 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MASTER_ARCHIVER_HPP__
+#define __MASTER_ARCHIVER_HPP__
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+
+#include <process/future.hpp>
+#include <process/http.hpp>
+#include <process/process.hpp>
+
+#include <stout/option.hpp>
+
+#include "master/http.pb.h"
+
+// Forward declarations.
+namespace leveldb {
+class DB;
+}
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+// An append-only, on-disk archive of the completed tasks and
+// frameworks of the master, stored in LevelDB under --archive_dir.
+// Every task is archived once it completes, so the in-memory buffers
+// of completed tasks and frameworks only need to keep the most recent
+// history (see --max_completed_tasks_per_framework) while the full
+// history remains available through the paginated endpoints below.
+//
+// Records are keyed by a sequence number that increases in the order
+// they were archived, and tasks are also indexed by framework. The
+// endpoints list the records from the most recent one and return the
+// cursor to pass to get the next page.
+class Archiver : public process::Process<Archiver>
+{
+public:
+  explicit Archiver(const std::string& path);
+  virtual ~Archiver();
+
+  // Archives the completed task, unless it has been archived already
+  // (e.g., when a slave re-registers after a master failover with the
+  // tasks that completed before the failover).
+  void addTask(const Task& task);
+
+  // Archives the completed framework, which is expected to omit its
+  // tasks as they are archived separately.
+  void addFramework(const StateResponse::Framework& framework);
+
+  // /master/archived_tasks
+  process::Future<process::http::Response> tasks(
+      const process::http::Request& request);
+
+  // /master/archived_frameworks
+  process::Future<process::http::Response> frameworks(
+      const process::http::Request& request);
+
+  const static std::string TASKS_HELP;
+  const static std::string FRAMEWORKS_HELP;
+
+protected:
+  virtual void initialize();
+
+private:
+  // Appends a record under the next sequence number along with the
+  // entries that refer to it: one under each of the 'indices'
+  // prefixes, followed by the sequence number, and one under each of
+  // the 'aliases' keys.
+  void append(
+      const std::string& prefix,
+      const std::string& data,
+      const std::vector<std::string>& indices,
+      const std::vector<std::string>& aliases);
+
+  const std::string path;
+  leveldb::DB* db;
+
+  // Set if the archive could not be opened or recovered, in which
+  // case nothing is archived and the endpoints return an error.
+  Option<std::string> error;
+
+  // The sequence number of the last record.
+  uint64_t sequence;
+};
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ARCHIVER_HPP__
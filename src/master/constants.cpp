@@ -33,6 +33,7 @@ const double MIN_CPUS = 0.01;
 const Bytes MIN_MEM = Megabytes(32);
 const Duration DEFAULT_SLAVE_PING_TIMEOUT = Seconds(15);
 const size_t DEFAULT_MAX_SLAVE_PING_TIMEOUTS = 5;
+const Duration SLAVE_PING_SLOT = Milliseconds(100);
 const Duration MIN_SLAVE_REREGISTER_TIMEOUT = Minutes(10);
 const double RECOVERY_SLAVE_REMOVAL_PERCENT_LIMIT = 1.0; // 100%.
 const size_t MAX_REMOVED_SLAVES = 100000;
@@ -40,6 +41,11 @@ const uint32_t MAX_COMPLETED_FRAMEWORKS = 50;
 const uint32_t MAX_COMPLETED_TASKS_PER_FRAMEWORK = 1000;
 const Duration WHITELIST_WATCH_INTERVAL = Seconds(5);
 const uint32_t TASK_LIMIT = 100;
+const size_t MAX_CACHED_RESPONSES = 16;
+const size_t STATE_STREAM_BATCH_SIZE = 1000;
+const Duration DEFAULT_ALLOCATION_BATCH_INTERVAL = Duration::zero();
+const Duration DEFAULT_STATUS_UPDATE_BATCH_INTERVAL = Milliseconds(10);
+const Bytes MAX_STATUS_UPDATE_BATCH_SIZE = Kilobytes(512);
 const std::string MASTER_INFO_LABEL = "info";
 const std::string MASTER_INFO_JSON_LABEL = "json.info";
 
@@ -65,6 +65,11 @@ extern const Duration DEFAULT_SLAVE_PING_TIMEOUT;
 // Maximum number of ping timeouts until slave is considered failed.
 extern const size_t DEFAULT_MAX_SLAVE_PING_TIMEOUTS;
 
+// Width of the slots in which the slave health checker groups the
+// ping deadlines of the slaves. Slaves may be checked up to this much
+// earlier than one ping timeout after their last ping.
+extern const Duration SLAVE_PING_SLOT;
+
 // The minimum timeout that can be used by a newly elected leader to
 // allow re-registration of slaves. Any slaves that do not re-register
 // within this timeout will be shutdown.
@@ -84,12 +89,12 @@ extern const double RECOVERY_SLAVE_REMOVAL_PERCENT_LIMIT;
 // Maximum number of removed slaves to store in the cache.
 extern const size_t MAX_REMOVED_SLAVES;
 
-// Maximum number of completed frameworks to store in the cache.
-// TODO(thomasm): Make configurable.
+// Default maximum number of completed frameworks to store in the
+// cache, see --max_completed_frameworks.
 extern const uint32_t MAX_COMPLETED_FRAMEWORKS;
 
-// Maximum number of completed tasks per framework to store in the
-// cache.  TODO(thomasm): Make configurable.
+// Default maximum number of completed tasks per framework to store
+// in the cache, see --max_completed_tasks_per_framework.
 extern const uint32_t MAX_COMPLETED_TASKS_PER_FRAMEWORK;
 
 // Time interval to check for updated watchers list.
@@ -98,6 +103,30 @@ extern const Duration WHITELIST_WATCH_INTERVAL;
 // Default number of tasks (limit) for /master/tasks.json endpoint.
 extern const uint32_t TASK_LIMIT;
 
+// Maximum number of cached responses of the read-only endpoints
+// (e.g., /master/state.json), one per path and query.
+extern const size_t MAX_CACHED_RESPONSES;
+
+// Number of records (i.e., slaves, frameworks and tasks) of
+// /master/state.json that are streamed before yielding to other
+// requests.
+extern const size_t STATE_STREAM_BATCH_SIZE;
+
+// Default minimum interval between the allocations that are
+// triggered by events, see the --allocation_batch_interval flag. It
+// is zero, i.e., batching is opt-in.
+extern const Duration DEFAULT_ALLOCATION_BATCH_INTERVAL;
+
+// Default interval within which the status updates for a framework
+// with the BATCHED_STATUS_UPDATES capability are coalesced.
+extern const Duration DEFAULT_STATUS_UPDATE_BATCH_INTERVAL;
+
+// Maximum (serialized) size of a batch of status updates. A batch is
+// sent as soon as it is full, without waiting for the interval to
+// elapse. This also bounds the size of the messages that reconciliation
+// replies are packed into.
+extern const Bytes MAX_STATUS_UPDATE_BATCH_SIZE;
+
 /**
  * Label used by the Leader Contender and Detector.
  *
@@ -93,6 +93,16 @@ mesos::internal::master::Flags::Flags()
       "after which the operation is considered a failure.",
       Seconds(5));
 
+  add(&Flags::registry_max_journal_entries,
+      "registry_max_journal_entries",
+      "Maximum number of changes to the registry that are appended to a\n"
+      "journal before a new snapshot of the registry is stored. This\n"
+      "avoids storing the whole registry (i.e., all of the slaves) on\n"
+      "every change. Set to 0 to store the whole registry on every change,\n"
+      "which must be done before downgrading to a master that does not\n"
+      "support the journal.",
+      0);
+
   add(&Flags::log_auto_initialize,
       "log_auto_initialize",
       "Whether to automatically initialize the replicated log used for the\n"
@@ -168,6 +178,15 @@ mesos::internal::master::Flags::Flags()
       " (batch) allocations (e.g., 500ms, 1sec, etc).",
       Seconds(1));
 
+  add(&Flags::allocation_batch_interval,
+      "allocation_batch_interval",
+      "Minimum amount of time between the allocations triggered by\n"
+      "events such as added slaves or recovered resources. The events\n"
+      "that happen within this interval are handled by a single\n"
+      "allocation. With 0secs (the default) every event triggers\n"
+      "its own allocation.",
+      DEFAULT_ALLOCATION_BATCH_INTERVAL);
+
   add(&Flags::cluster,
       "cluster",
       "Human readable name for the cluster,\n"
@@ -372,6 +391,14 @@ mesos::internal::master::Flags::Flags()
       "load an alternate allocator module using --modules.",
       DEFAULT_ALLOCATOR);
 
+  add(&Flags::allocator_workers,
+      "allocator_workers",
+      "Number of worker processes the '" + DEFAULT_ALLOCATOR + "' allocator\n"
+      "uses to compute batch allocations in parallel, each of which\n"
+      "allocates a disjoint subset of the slaves. Use 0 to perform\n"
+      "all allocations serially within the allocator.",
+      0);
+
   add(&Flags::hooks,
       "hooks",
       "A comma separated list of hook modules to be\n"
@@ -407,4 +434,43 @@ mesos::internal::master::Flags::Flags()
         }
         return None();
       });
+
+  add(&Flags::max_state_staleness,
+      "max_state_staleness",
+      "Maximum age of a cached response of the /master/state.json,\n"
+      "/master/state-summary and /master/tasks.json endpoints that is\n"
+      "served after the master state changed. Responses are always\n"
+      "served from the cache while the master state is unchanged.\n"
+      "Increase this to render the state at most once per interval\n"
+      "on busy clusters with many clients polling these endpoints.",
+      Seconds(0));
+
+  add(&Flags::status_update_batch_interval,
+      "status_update_batch_interval",
+      "Amount of time within which the status updates for a framework\n"
+      "are coalesced and sent as a single message. Only applies to\n"
+      "frameworks with the BATCHED_STATUS_UPDATES capability; other\n"
+      "frameworks receive each status update as soon as it arrives.\n"
+      "Set to 0secs to disable batching. The replies to task\n"
+      "reconciliation are always batched for these frameworks.",
+      DEFAULT_STATUS_UPDATE_BATCH_INTERVAL);
+
+  add(&Flags::archive_dir,
+      "archive_dir",
+      "Directory of an on-disk archive of the completed tasks and\n"
+      "frameworks, which are listed by the /master/archived_tasks and\n"
+      "/master/archived_frameworks endpoints. Tasks and frameworks are\n"
+      "archived as they complete, so the history is kept beyond\n"
+      "--max_completed_tasks_per_framework and --max_completed_frameworks.\n"
+      "If not set, completed tasks and frameworks are only kept in memory.");
+
+  add(&Flags::max_completed_frameworks,
+      "max_completed_frameworks",
+      "Maximum number of completed frameworks to keep in memory.",
+      MAX_COMPLETED_FRAMEWORKS);
+
+  add(&Flags::max_completed_tasks_per_framework,
+      "max_completed_tasks_per_framework",
+      "Maximum number of completed tasks per framework to keep in memory.",
+      MAX_COMPLETED_TASKS_PER_FRAMEWORK);
 }
@@ -50,6 +50,7 @@ public:
   bool registry_strict;
   Duration registry_fetch_timeout;
   Duration registry_store_timeout;
+  size_t registry_max_journal_entries;
   bool log_auto_initialize;
   Duration slave_reregister_timeout;
   std::string recovery_slave_removal_limit;
@@ -59,6 +60,7 @@ public:
   std::string user_sorter;
   std::string framework_sorter;
   Duration allocation_interval;
+  Duration allocation_batch_interval;
   Option<std::string> cluster;
   Option<std::string> roles;
   Option<std::string> weights;
@@ -72,9 +74,15 @@ public:
   Option<Modules> modules;
   std::string authenticators;
   std::string allocator;
+  size_t allocator_workers;
   Option<std::string> hooks;
   Duration slave_ping_timeout;
   size_t max_slave_ping_timeouts;
+  Duration max_state_staleness;
+  Duration status_update_batch_interval;
+  Option<std::string> archive_dir;
+  size_t max_completed_frameworks;
+  size_t max_completed_tasks_per_framework;
 
 #ifdef WITH_NETWORK_ISOLATOR
   Option<size_t> max_executors_per_slave;
@@ -0,0 +1,323 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <process/clock.hpp>
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/id.hpp>
+
+#include <stout/check.hpp>
+#include <stout/foreach.hpp>
+
+#include "master/constants.hpp"
+#include "master/health_checker.hpp"
+#include "master/master.hpp"
+
+#include "messages/messages.hpp"
+
+using process::Clock;
+using process::Future;
+using process::PID;
+using process::RateLimiter;
+using process::Time;
+using process::UPID;
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+SlaveHealthChecker::SlaveHealthChecker(
+    const PID<Master>& _master,
+    const Option<shared_ptr<RateLimiter>>& _limiter,
+    const shared_ptr<Metrics>& _metrics,
+    const Duration& _slavePingTimeout,
+    size_t _maxSlavePingTimeouts)
+  : ProcessBase(process::ID::generate("slave-health-checker")),
+    master(_master),
+    limiter(_limiter),
+    metrics(_metrics),
+    slavePingTimeout(_slavePingTimeout),
+    maxSlavePingTimeouts(_maxSlavePingTimeouts),
+    armed(false)
+{
+  // TODO(vinod): Deprecate this handler in 0.22.0 in favor of a
+  // new PongSlaveMessage handler.
+  install("PONG", &SlaveHealthChecker::pong);
+}
+
+
+void SlaveHealthChecker::add(const SlaveID& slaveId, const UPID& pid)
+{
+  CHECK(!slaves.contains(slaveId)) << "Duplicate slave " << slaveId;
+
+  Observed& observed = slaves[slaveId];
+  observed.pid = pid;
+  observed.timeouts = 0;
+  observed.pinged = false;
+  observed.connected = true;
+
+  pids[pid] = slaveId;
+
+  ping(slaveId);
+  arm();
+}
+
+
+void SlaveHealthChecker::remove(const SlaveID& slaveId)
+{
+  if (!slaves.contains(slaveId)) {
+    return;
+  }
+
+  // The slave's entries in the wheel are skipped once their slots
+  // are due, since the slave is unknown by then.
+  pids.erase(slaves[slaveId].pid);
+  slaves.erase(slaveId);
+}
+
+
+void SlaveHealthChecker::disconnect(const SlaveID& slaveId)
+{
+  if (slaves.contains(slaveId)) {
+    slaves[slaveId].connected = false;
+  }
+}
+
+
+void SlaveHealthChecker::reconnect(const SlaveID& slaveId, const UPID& pid)
+{
+  if (!slaves.contains(slaveId)) {
+    return;
+  }
+
+  Observed& observed = slaves[slaveId];
+  observed.connected = true;
+
+  // The slave might have re-registered from a different pid.
+  if (observed.pid != pid) {
+    pids.erase(observed.pid);
+    pids[pid] = slaveId;
+    observed.pid = pid;
+  }
+}
+
+
+void SlaveHealthChecker::pong(const UPID& from, const string& body)
+{
+  if (!pids.contains(from)) {
+    VLOG(1) << "Ignoring pong from unknown slave at " << from;
+    return;
+  }
+
+  Observed& observed = slaves[pids[from]];
+  observed.timeouts = 0;
+  observed.pinged = false;
+
+  // Cancel any pending shutdown.
+  if (observed.shuttingDown.isSome()) {
+    // Need a copy for non-const access.
+    Future<Nothing> future = observed.shuttingDown.get();
+    future.discard();
+  }
+}
+
+
+void SlaveHealthChecker::ping(const SlaveID& slaveId)
+{
+  CHECK(slaves.contains(slaveId));
+
+  Observed& observed = slaves[slaveId];
+
+  // TODO(vinod): In 0.22.0, master should send the PingSlaveMessage
+  // instead of sending "PING" with the encoded PingSlaveMessage.
+  // Currently we do not do this for backwards compatibility with
+  // slaves on 0.20.0.
+  PingSlaveMessage message;
+  message.set_connected(observed.connected);
+  string data;
+  CHECK(message.SerializeToString(&data));
+  send(observed.pid, "PING", data.data(), data.size());
+
+  observed.pinged = true;
+
+  // Add the slave to the last slot if the deadline falls within it,
+  // which means the slave is checked up to one slot earlier than its
+  // deadline. Otherwise, start a new slot.
+  const Time deadline = Clock::now() + slavePingTimeout;
+
+  if (wheel.empty() || deadline >= wheel.back().deadline + SLAVE_PING_SLOT) {
+    wheel.push_back(Slot());
+    wheel.back().deadline = deadline;
+  }
+
+  wheel.back().slaveIds.push_back(slaveId);
+  observed.deadline = wheel.back().deadline;
+}
+
+
+void SlaveHealthChecker::timeout()
+{
+  armed = false;
+
+  const Time now = Clock::now();
+
+  // The slaves that timed out and are shut down right away, which
+  // are reported to the master at once.
+  vector<SlaveID> shutdowns;
+
+  while (!wheel.empty() && wheel.front().deadline <= now) {
+    const Slot slot = wheel.front();
+    wheel.pop_front();
+
+    foreach (const SlaveID& slaveId, slot.slaveIds) {
+      // Skip the slaves that were removed since being pinged.
+      if (!slaves.contains(slaveId) ||
+          slaves[slaveId].deadline != slot.deadline) {
+        continue;
+      }
+
+      Observed& observed = slaves[slaveId];
+
+      if (observed.pinged) {
+        observed.timeouts++; // No pong has been received before the timeout.
+        if (observed.timeouts >= maxSlavePingTimeouts) {
+          // No pong has been received for the last
+          // 'maxSlavePingTimeouts' pings.
+          shutdown(slaveId, &shutdowns);
+        }
+      }
+
+      // NOTE: We keep pinging even if we schedule a shutdown. This is
+      // because if the slave eventually responds to a ping, we can
+      // cancel the shutdown.
+      ping(slaveId);
+    }
+  }
+
+  if (!shutdowns.empty()) {
+    dispatch(master,
+             &Master::shutdownSlaves,
+             shutdowns,
+             "health check timed out");
+  }
+
+  arm();
+}
+
+
+void SlaveHealthChecker::arm()
+{
+  if (armed || wheel.empty()) {
+    return;
+  }
+
+  // NOTE: The deadline might already have passed if the clock was
+  // advanced while the timer was not armed, in which case the timer
+  // fires right away.
+  const Time now = Clock::now();
+  const Time deadline = wheel.front().deadline;
+
+  delay(deadline > now ? deadline - now : Duration::zero(),
+        self(),
+        &SlaveHealthChecker::timeout);
+
+  armed = true;
+}
+
+
+void SlaveHealthChecker::shutdown(
+    const SlaveID& slaveId,
+    vector<SlaveID>* shutdowns)
+{
+  CHECK_NOTNULL(shutdowns);
+
+  Observed& observed = slaves[slaveId];
+
+  if (observed.shuttingDown.isSome()) {
+    return;  // Shutdown is already in progress.
+  }
+
+  ++metrics->slave_shutdowns_scheduled;
+
+  // Without a rate limit the shutdown cannot be canceled anymore, so
+  // it is reported right away along with the other slaves.
+  if (limiter.isNone()) {
+    LOG(INFO) << "Shutting down slave " << slaveId
+              << " due to health check timeout";
+
+    ++metrics->slave_shutdowns_completed;
+
+    shutdowns->push_back(slaveId);
+    return;
+  }
+
+  LOG(INFO) << "Scheduling shutdown of slave " << slaveId
+            << " due to health check timeout";
+
+  observed.shuttingDown = limiter.get()->acquire()
+    .onAny(defer(self(), &Self::_shutdown, slaveId));
+}
+
+
+void SlaveHealthChecker::_shutdown(const SlaveID& slaveId)
+{
+  // The slave might have been removed in the meantime.
+  if (!slaves.contains(slaveId) || slaves[slaveId].shuttingDown.isNone()) {
+    return;
+  }
+
+  Observed& observed = slaves[slaveId];
+
+  const Future<Nothing>& future = observed.shuttingDown.get();
+
+  CHECK(!future.isFailed());
+
+  if (future.isReady()) {
+    LOG(INFO) << "Shutting down slave " << slaveId
+              << " due to health check timeout";
+
+    ++metrics->slave_shutdowns_completed;
+
+    dispatch(master,
+             &Master::shutdownSlaves,
+             vector<SlaveID>({slaveId}),
+             "health check timed out");
+  } else if (future.isDiscarded()) {
+    LOG(INFO) << "Canceling shutdown of slave " << slaveId
+              << " since a pong is received!";
+
+    ++metrics->slave_shutdowns_canceled;
+  }
+
+  observed.shuttingDown = None();
+}
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,148 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MASTER_HEALTH_CHECKER_HPP__
+#define __MASTER_HEALTH_CHECKER_HPP__
+
+#include <stdint.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+
+#include <process/future.hpp>
+#include <process/limiter.hpp>
+#include <process/pid.hpp>
+#include <process/process.hpp>
+#include <process/time.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+
+#include "master/metrics.hpp"
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+// Forward declarations.
+class Master;
+
+
+// Checks the health of all of the registered slaves on behalf of the
+// master by pinging them every 'slavePingTimeout'. A slave that does
+// not respond to 'maxSlavePingTimeouts' consecutive pings is shut
+// down (subject to the slave removal rate limit).
+//
+// The deadlines of the pings are kept in a timer wheel: a queue of
+// slots that are SLAVE_PING_SLOT wide. Since every deadline is one
+// ping timeout from when the ping was sent, slots are only ever added
+// at the end of the queue. A single timer fires for the first slot,
+// at which point all of its slaves are pinged again and the slaves
+// that timed out are shut down in one batch.
+class SlaveHealthChecker : public process::Process<SlaveHealthChecker>
+{
+public:
+  SlaveHealthChecker(
+      const process::PID<Master>& master,
+      const Option<std::shared_ptr<process::RateLimiter>>& limiter,
+      const std::shared_ptr<Metrics>& metrics,
+      const Duration& slavePingTimeout,
+      size_t maxSlavePingTimeouts);
+
+  // Starts checking the health of the slave, by pinging it right away.
+  void add(const SlaveID& slaveId, const process::UPID& pid);
+
+  // Stops checking the health of the slave, e.g., when it is removed.
+  // Any pending (rate limited) shutdown of the slave is dropped.
+  void remove(const SlaveID& slaveId);
+
+  // Updates whether the slave is connected, which is included in the
+  // pings so that a partitioned slave can re-register.
+  void disconnect(const SlaveID& slaveId);
+  void reconnect(const SlaveID& slaveId, const process::UPID& pid);
+
+private:
+  struct Observed
+  {
+    process::UPID pid;
+
+    // The deadline of the last ping, i.e., of the slot the slave is
+    // in. Used to skip the slots the slave was in before it got
+    // removed (and possibly added again).
+    process::Time deadline;
+
+    uint32_t timeouts;
+    bool pinged;
+    bool connected;
+
+    Option<process::Future<Nothing>> shuttingDown;
+  };
+
+  void pong(const process::UPID& from, const std::string& body);
+
+  // Sends a ping to the slave and adds it to the wheel.
+  void ping(const SlaveID& slaveId);
+
+  // Handles the slots whose deadline passed, see above.
+  void timeout();
+
+  // Arms the timer for the first slot of the wheel, unless it is
+  // already armed.
+  void arm();
+
+  // NOTE: The shutdown of the slave is rate limited and can be
+  // canceled if a pong was received before the actual shutdown is
+  // called.
+  void shutdown(const SlaveID& slaveId, std::vector<SlaveID>* shutdowns);
+  void _shutdown(const SlaveID& slaveId);
+
+  const process::PID<Master> master;
+  const Option<std::shared_ptr<process::RateLimiter>> limiter;
+  std::shared_ptr<Metrics> metrics;
+  const Duration slavePingTimeout;
+  const size_t maxSlavePingTimeouts;
+
+  hashmap<SlaveID, Observed> slaves;
+
+  // Slaves respond to the pings of this process, hence we need to
+  // look up the slave of a pong by its pid.
+  hashmap<process::UPID, SlaveID> pids;
+
+  struct Slot
+  {
+    process::Time deadline;
+    std::vector<SlaveID> slaveIds;
+  };
+
+  std::deque<Slot> wheel;
+
+  // Whether a timer is armed for the first slot of the wheel.
+  bool armed;
+};
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_HEALTH_CHECKER_HPP__
@@ -83,6 +83,8 @@ using mesos::MasterInfo;
 
 using mesos::master::allocator::Allocator;
 
+using mesos::internal::master::allocator::HierarchicalDRFAllocator;
+
 using mesos::modules::Anonymous;
 using mesos::modules::ModuleManager;
 
@@ -236,9 +238,14 @@ int main(int argc, char** argv)
     LOG(INFO) << "Git SHA: " << build::GIT_SHA.get();
   }
 
-  // Create an instance of allocator.
+  // Create an instance of allocator. The default allocator is
+  // created directly so that it can be configured by the flags.
   const std::string allocatorName = flags.allocator;
-  Try<Allocator*> allocator = Allocator::create(allocatorName);
+  Try<Allocator*> allocator = allocatorName == DEFAULT_ALLOCATOR
+    ? HierarchicalDRFAllocator::create(
+          flags.allocator_workers,
+          flags.allocation_batch_interval)
+    : Allocator::create(allocatorName);
 
   if (allocator.isError()) {
     EXIT(EXIT_FAILURE)
@@ -77,8 +77,11 @@
 #include "logging/flags.hpp"
 #include "logging/logging.hpp"
 
+#include "master/archiver.hpp"
 #include "master/flags.hpp"
+#include "master/health_checker.hpp"
 #include "master/master.hpp"
+#include "master/replica.hpp"
 
 #include "module/manager.hpp"
 
@@ -117,163 +120,6 @@ using mesos::master::RoleInfo;
 using mesos::master::allocator::Allocator;
 
 
-class SlaveObserver : public Process<SlaveObserver>
-{
-public:
-  SlaveObserver(const UPID& _slave,
-                const SlaveInfo& _slaveInfo,
-                const SlaveID& _slaveId,
-                const PID<Master>& _master,
-                const Option<shared_ptr<RateLimiter>>& _limiter,
-                const shared_ptr<Metrics> _metrics,
-                const Duration& _slavePingTimeout,
-                const size_t _maxSlavePingTimeouts)
-    : ProcessBase(process::ID::generate("slave-observer")),
-      slave(_slave),
-      slaveInfo(_slaveInfo),
-      slaveId(_slaveId),
-      master(_master),
-      limiter(_limiter),
-      metrics(_metrics),
-      slavePingTimeout(_slavePingTimeout),
-      maxSlavePingTimeouts(_maxSlavePingTimeouts),
-      timeouts(0),
-      pinged(false),
-      connected(true)
-  {
-    // TODO(vinod): Deprecate this handler in 0.22.0 in favor of a
-    // new PongSlaveMessage handler.
-    install("PONG", &SlaveObserver::pong);
-  }
-
-  void reconnect()
-  {
-    connected = true;
-  }
-
-  void disconnect()
-  {
-    connected = false;
-  }
-
-protected:
-  virtual void initialize()
-  {
-    ping();
-  }
-
-  void ping()
-  {
-    // TODO(vinod): In 0.22.0, master should send the PingSlaveMessage
-    // instead of sending "PING" with the encoded PingSlaveMessage.
-    // Currently we do not do this for backwards compatibility with
-    // slaves on 0.20.0.
-    PingSlaveMessage message;
-    message.set_connected(connected);
-    string data;
-    CHECK(message.SerializeToString(&data));
-    send(slave, "PING", data.data(), data.size());
-
-    pinged = true;
-    delay(slavePingTimeout, self(), &SlaveObserver::timeout);
-  }
-
-  void pong(const UPID& from, const string& body)
-  {
-    timeouts = 0;
-    pinged = false;
-
-    // Cancel any pending shutdown.
-    if (shuttingDown.isSome()) {
-      // Need a copy for non-const access.
-      Future<Nothing> future = shuttingDown.get();
-      future.discard();
-    }
-  }
-
-  void timeout()
-  {
-    if (pinged) {
-      timeouts++; // No pong has been received before the timeout.
-      if (timeouts >= maxSlavePingTimeouts) {
-        // No pong has been received for the last
-        // 'maxSlavePingTimeouts' pings.
-        shutdown();
-      }
-    }
-
-    // NOTE: We keep pinging even if we schedule a shutdown. This is
-    // because if the slave eventually responds to a ping, we can
-    // cancel the shutdown.
-    ping();
-  }
-
-  // NOTE: The shutdown of the slave is rate limited and can be
-  // canceled if a pong was received before the actual shutdown is
-  // called.
-  void shutdown()
-  {
-    if (shuttingDown.isSome()) {
-      return;  // Shutdown is already in progress.
-    }
-
-    Future<Nothing> acquire = Nothing();
-
-    if (limiter.isSome()) {
-      LOG(INFO) << "Scheduling shutdown of slave " << slaveId
-                << " due to health check timeout";
-
-      acquire = limiter.get()->acquire();
-    }
-
-    shuttingDown = acquire.onAny(defer(self(), &Self::_shutdown));
-    ++metrics->slave_shutdowns_scheduled;
-  }
-
-  void _shutdown()
-  {
-    CHECK_SOME(shuttingDown);
-
-    const Future<Nothing>& future = shuttingDown.get();
-
-    CHECK(!future.isFailed());
-
-    if (future.isReady()) {
-      LOG(INFO) << "Shutting down slave " << slaveId
-                << " due to health check timeout";
-
-      ++metrics->slave_shutdowns_completed;
-
-      dispatch(master,
-               &Master::shutdownSlave,
-               slaveId,
-               "health check timed out");
-    } else if (future.isDiscarded()) {
-      LOG(INFO) << "Canceling shutdown of slave " << slaveId
-                << " since a pong is received!";
-
-      ++metrics->slave_shutdowns_canceled;
-    }
-
-    shuttingDown = None();
-  }
-
-private:
-  const UPID slave;
-  const SlaveInfo slaveInfo;
-  const SlaveID slaveId;
-  const PID<Master> master;
-  const Option<shared_ptr<RateLimiter>> limiter;
-  shared_ptr<Metrics> metrics;
-  Option<Future<Nothing>> shuttingDown;
-  const Duration slavePingTimeout;
-  const size_t maxSlavePingTimeouts;
-  uint32_t timeouts;
-  bool pinged;
-  bool connected;
-};
-
-
 Master::Master(
     Allocator* _allocator,
     Registrar* _registrar,
@@ -295,9 +141,15 @@ Master::Master(
     authorizer(_authorizer),
     authenticator(None()),
     metrics(new Metrics(*this)),
-    electedTime(None())
+    electedTime(None()),
+    version(0),
+    publishing(false),
+    replica(NULL),
+    healthChecker(NULL),
+    archiver(NULL)
 {
   slaves.limiter = _slaveRemovalLimiter;
+  frameworks.completed.set_capacity(flags.max_completed_frameworks);
 
   // NOTE: We populate 'info_' here instead of inside 'initialize()'
   // because 'StandaloneMasterDetector' needs access to the info.
@@ -633,6 +485,25 @@ void Master::initialize()
       });
   spawn(whitelistWatcher);
 
+  replica = new ReadReplica();
+  spawn(replica);
+
+  // Publish the first snapshot before any requests are forwarded.
+  publish();
+
+  healthChecker = new SlaveHealthChecker(
+      self(),
+      slaves.limiter,
+      metrics,
+      flags.slave_ping_timeout,
+      flags.max_slave_ping_timeouts);
+  spawn(healthChecker);
+
+  if (flags.archive_dir.isSome()) {
+    archiver = new Archiver(flags.archive_dir.get());
+    spawn(archiver);
+  }
+
   nextFrameworkId = 0;
   nextSlaveId = 0;
   nextOfferId = 0;
@@ -790,30 +661,49 @@ void Master::initialize()
           return http.teardown(request);
         });
   route("/slaves",
-        Http::SLAVES_HELP,
-        [http](const process::http::Request& request) {
+        ReadReplica::SLAVES_HELP,
+        [this](const process::http::Request& request) {
           Http::log(request);
-          return http.slaves(request);
+          publish();
+          return dispatch(replica->self(), &ReadReplica::slaves, request);
         });
   route("/state.json",
-        Http::STATE_HELP,
-        [http](const process::http::Request& request) {
+        ReadReplica::STATE_HELP,
+        [this](const process::http::Request& request) {
           Http::log(request);
-          return http.state(request);
+          publish();
+          return dispatch(replica->self(), &ReadReplica::state, request);
         });
   route("/state-summary",
-        Http::STATESUMMARY_HELP,
-        [http](const process::http::Request& request) {
+        ReadReplica::STATESUMMARY_HELP,
+        [this](const process::http::Request& request) {
           Http::log(request);
-          return http.stateSummary(request);
+          publish();
+          return dispatch(replica->self(), &ReadReplica::stateSummary, request);
         });
   route("/tasks.json",
-        Http::TASKS_HELP,
-        [http](const process::http::Request& request) {
+        ReadReplica::TASKS_HELP,
+        [this](const process::http::Request& request) {
           Http::log(request);
-          return http.tasks(request);
+          publish();
+          return dispatch(replica->self(), &ReadReplica::tasks, request);
         });
 
+  if (archiver != NULL) {
+    route("/archived_frameworks",
+          Archiver::FRAMEWORKS_HELP,
+          [this](const process::http::Request& request) {
+            Http::log(request);
+            return dispatch(archiver->self(), &Archiver::frameworks, request);
+          });
+    route("/archived_tasks",
+          Archiver::TASKS_HELP,
+          [this](const process::http::Request& request) {
+            Http::log(request);
+            return dispatch(archiver->self(), &Archiver::tasks, request);
+          });
+  }
+
   // Provide HTTP assets from a "webui" directory. This is either
   // specified via flags (which is necessary for running out of the
   // build directory before 'make install') or determined at build
@@ -872,7 +762,7 @@ void Master::finalize()
     allocator->removeSlave(slave->id);
 
     foreachkey (const FrameworkID& frameworkId, utils::copy(slave->tasks)) {
-      foreachvalue (Task* task, utils::copy(slave->tasks[frameworkId])) {
+      foreachvalue (TaskRecord* task, utils::copy(slave->tasks[frameworkId])) {
         removeTask(task);
       }
     }
@@ -890,11 +780,6 @@ void Master::finalize()
       removeOffer(offer);
     }
 
-    // Terminate the slave observer.
-    terminate(slave->observer);
-    wait(slave->observer);
-
-    delete slave->observer;
     delete slave;
   }
   slaves.registered.clear();
@@ -953,6 +838,20 @@ void Master::finalize()
   wait(whitelistWatcher);
   delete whitelistWatcher;
 
+  terminate(replica);
+  wait(replica);
+  delete replica;
+
+  terminate(healthChecker);
+  wait(healthChecker);
+  delete healthChecker;
+
+  if (archiver != NULL) {
+    terminate(archiver);
+    wait(archiver);
+    delete archiver;
+  }
+
   if (authenticator.isSome()) {
     delete authenticator.get();
   }
@@ -1009,7 +908,7 @@ void Master::exited(const UPID& pid)
   //    fall into one of the 2 cases:
   //    2.1) Framework is checkpointing: No immediate action is taken.
   //         The slave is given a chance to reconnect until the slave
-  //         observer times out (75s) and removes the slave (Case 1).
+  //         health check times out (75s) and removes the slave (Case 1).
   //    2.2) Framework is not-checkpointing: The slave is not removed
   //         but the framework is removed from the slave's structs,
   //         its tasks transitioned to LOST and resources recovered.
@@ -1292,8 +1191,8 @@ Future<Nothing> Master::_recover(const Registry& registry)
   }
 
   // Set up a timeout for slaves to re-register. This timeout is based
-  // on the maximum amount of time the SlaveObserver allows slaves to
-  // not respond to health checks.
+  // on the maximum amount of time the SlaveHealthChecker allows slaves
+  // to not respond to health checks.
   // TODO(bmahler): Consider making this configurable.
   slaves.recoveredTimer =
     delay(flags.slave_reregister_timeout,
@@ -1344,7 +1243,7 @@ void Master::recoveredSlavesTimeout(const Registry& registry)
   }
 
   // Remove the slaves in a rate limited manner, similar to how the
-  // SlaveObserver removes slaves.
+  // SlaveHealthChecker removes slaves.
   foreach (const Registry::Slave& slave, registry.slaves().slaves()) {
     // The slave is removed from 'recovered' when it re-registers.
     if (!slaves.recovered.contains(slave.info().id())) {
@@ -1492,6 +1391,8 @@ void Master::detected(const Future<Option<MasterInfo>>& _leader)
   bool wasElected = elected();
   leader = _leader.get();
 
+  changed();
+
   LOG(INFO) << "The newly elected leader is "
             << (leader.isSome()
                 ? (leader.get().pid() + " with id " + leader.get().id())
@@ -1693,6 +1594,11 @@ void Master::receive(
       break;
     }
 
+    case scheduler::Call::SUPPRESS: {
+      suppressOffers(framework);
+      break;
+    }
+
     case scheduler::Call::KILL: {
       if (!call.has_kill()) {
         drop(from, call, "Expecting 'kill' to be present");
@@ -2014,6 +1920,8 @@ void Master::_reregisterFramework(
 
     framework->reregisteredTime = Clock::now();
 
+    changed(framework->id());
+
     if (failover) {
       // We do not attempt to detect a duplicate re-registration
       // message here because it is impossible to distinguish between
@@ -2078,7 +1986,7 @@ void Master::_reregisterFramework(
 
     // Add active tasks and executors to the framework.
     foreachvalue (Slave* slave, slaves.registered) {
-      foreachvalue (Task* task, slave->tasks[framework->id()]) {
+      foreachvalue (TaskRecord* task, slave->tasks[framework->id()]) {
         framework->addTask(task);
       }
       foreachvalue (const ExecutorInfo& executor,
@@ -2217,6 +2125,8 @@ void Master::deactivate(Framework* framework)
   // Stop sending offers here for now.
   framework->active = false;
 
+  changed(framework->id());
+
   // Tell the allocator to stop allocating resources to this framework.
   allocator->deactivateFramework(framework->id());
 
@@ -2237,8 +2147,8 @@ void Master::disconnect(Slave* slave)
 
   slave->connected = false;
 
-  // Inform the slave observer.
-  dispatch(slave->observer, &SlaveObserver::disconnect);
+  // Inform the slave health checker.
+  dispatch(healthChecker, &SlaveHealthChecker::disconnect, slave->id);
 
   // Remove the slave from authenticated. This is safe because
   // a slave will always reauthenticate before (re-)registering.
@@ -2256,6 +2166,8 @@ void Master::deactivate(Slave* slave)
 
   slave->active = false;
 
+  changed(slave->id);
+
   allocator->deactivateSlave(slave->id);
 
   // Remove and rescind offers.
@@ -2422,6 +2334,9 @@ Resources Master::addTask(
   CHECK(slave->connected) << "Adding task " << task.task_id()
                           << " to disconnected slave " << *slave;
 
+  changed(framework->id());
+  changed(slave->id);
+
   // The resources consumed.
   Resources resources = task.resources();
 
@@ -2447,25 +2362,27 @@ Resources Master::addTask(
   }
 
   // Add the task to the framework and slave.
-  Task* t = new Task();
-  t->mutable_framework_id()->MergeFrom(framework->id());
-  t->set_state(TASK_STAGING);
-  t->set_name(task.name());
-  t->mutable_task_id()->MergeFrom(task.task_id());
-  t->mutable_slave_id()->MergeFrom(task.slave_id());
-  t->mutable_resources()->MergeFrom(task.resources());
+  Task t;
+  t.mutable_framework_id()->MergeFrom(framework->id());
+  t.set_state(TASK_STAGING);
+  t.set_name(task.name());
+  t.mutable_task_id()->MergeFrom(task.task_id());
+  t.mutable_slave_id()->MergeFrom(task.slave_id());
+  t.mutable_resources()->MergeFrom(task.resources());
 
   if (executorId.isSome()) {
-    t->mutable_executor_id()->MergeFrom(executorId.get());
+    t.mutable_executor_id()->MergeFrom(executorId.get());
   }
 
-  t->mutable_labels()->MergeFrom(task.labels());
+  t.mutable_labels()->MergeFrom(task.labels());
   if (task.has_discovery()) {
-    t->mutable_discovery()->MergeFrom(task.discovery());
+    t.mutable_discovery()->MergeFrom(task.discovery());
   }
 
-  slave->addTask(t);
-  framework->addTask(t);
+  TaskRecord* record = new TaskRecord(t);
+
+  slave->addTask(record);
+  framework->addTask(record);
 
   return resources;
 }
@@ -2582,6 +2499,7 @@ void Master::accept(
       // will not be launched.
       if (!framework->pendingTasks.contains(task.task_id())) {
         framework->pendingTasks[task.task_id()] = task;
+        changed(framework->id());
       }
     }
   }
@@ -2696,7 +2614,7 @@ void Master::_accept(
           continue;
         }
 
-        _offeredResources = resources.get();
+        _offeredResources = std::move(resources.get());
 
         LOG(INFO) << "Applying RESERVE operation for resources "
                   << operation.reserve().resources() << " from framework "
@@ -2721,7 +2639,7 @@ void Master::_accept(
           continue;
         }
 
-        _offeredResources = resources.get();
+        _offeredResources = std::move(resources.get());
 
         LOG(INFO) << "Applying UNRESERVE operation for resources "
                   << operation.unreserve().resources() << " from framework "
@@ -2747,7 +2665,7 @@ void Master::_accept(
           continue;
         }
 
-        _offeredResources = resources.get();
+        _offeredResources = std::move(resources.get());
 
         LOG(INFO) << "Applying CREATE operation for volumes "
                   << operation.create().volumes() << " from framework "
@@ -2773,7 +2691,7 @@ void Master::_accept(
           continue;
         }
 
-        _offeredResources = resources.get();
+        _offeredResources = std::move(resources.get());
 
         LOG(INFO) << "Applying DESTROY operation for volumes "
                   << operation.create().volumes() << " from framework "
@@ -2798,6 +2716,7 @@ void Master::_accept(
 
           // Remove from pending tasks.
           framework->pendingTasks.erase(task.task_id());
+          changed(framework->id());
 
           // Check authorization result.
           CHECK(!authorization.isDiscarded());
@@ -2990,6 +2909,17 @@ void Master::revive(Framework* framework)
 }
 
 
+void Master::suppressOffers(Framework* framework)
+{
+  CHECK_NOTNULL(framework);
+
+  ++metrics->messages_suppress_offers;
+
+  LOG(INFO) << "Processing SUPPRESS call for framework " << *framework;
+  allocator->suppressOffers(framework->id());
+}
+
+
 void Master::killTask(
     const UPID& from,
     const FrameworkID& frameworkId,
@@ -3034,6 +2964,7 @@ void Master::kill(Framework* framework, const scheduler::Call::Kill& kill)
   if (framework->pendingTasks.contains(taskId)) {
     // Remove from pending tasks.
     framework->pendingTasks.erase(taskId);
+    changed(framework->id());
 
     const StatusUpdate& update = protobuf::createStatusUpdate(
         framework->id(),
@@ -3049,7 +2980,7 @@ void Master::kill(Framework* framework, const scheduler::Call::Kill& kill)
     return;
   }
 
-  Task* task = framework->getTask(taskId);
+  TaskRecord* task = framework->getTask(taskId);
   if (task == NULL) {
     LOG(WARNING) << "Cannot kill task " << taskId
                  << " of framework " << *framework
@@ -3177,7 +3108,7 @@ void Master::acknowledge(
     return;
   }
 
-  Task* task = slave->getTask(framework->id(), taskId);
+  TaskRecord* task = slave->getTask(framework->id(), taskId);
 
   if (task != NULL) {
     // Status update state and uuid should be either set or unset
@@ -3577,6 +3508,8 @@ void Master::reregisterSlave(
   if (slave != NULL) {
     slave->reregisteredTime = Clock::now();
 
+    changed(slave->id);
+
     // NOTE: This handles the case where a slave tries to
     // re-register with an existing master (e.g. because of a
     // spurious Zookeeper session expiration or after the slave
@@ -3607,7 +3540,10 @@ void Master::reregisterSlave(
     // slave.
     if (!slave->connected) {
       slave->connected = true;
-      dispatch(slave->observer, &SlaveObserver::reconnect);
+      dispatch(healthChecker,
+               &SlaveHealthChecker::reconnect,
+               slave->id,
+               slave->pid);
       slave->active = true;
       allocator->activateSlave(slave->id);
     }
@@ -3832,6 +3768,8 @@ void Master::updateSlave(
   slave->totalResources -= slave->totalResources.revocable();
   slave->totalResources += oversubscribedResources.revocable();
 
+  changed(slave->id);
+
   // Now, update the allocator with the new estimate.
   allocator->updateSlave(slaveId, oversubscribedResources);
 }
@@ -3886,7 +3824,8 @@ void Master::statusUpdate(const StatusUpdate& update, const UPID& pid)
   forward(update, pid, framework);
 
   // Lookup the task and see if we need to update anything locally.
-  Task* task = slave->getTask(update.framework_id(), update.status().task_id());
+  TaskRecord* task =
+    slave->getTask(update.framework_id(), update.status().task_id());
   if (task == NULL) {
     LOG(WARNING) << "Could not lookup task for status update " << update
                  << " from slave " << *slave;
@@ -3925,7 +3864,37 @@ void Master::forward(
   StatusUpdateMessage message;
   message.mutable_update()->MergeFrom(update);
   message.set_pid(acknowledgee);
-  framework->send(message);
+
+  if (flags.status_update_batch_interval == Duration::zero() ||
+      !framework->batchesStatusUpdates()) {
+    framework->send(message);
+    return;
+  }
+
+  framework->batch(message);
+
+  // The first update of a batch starts the interval; a full batch
+  // is sent right away.
+  if (framework->batchedUpdates.size() == 1) {
+    delay(flags.status_update_batch_interval,
+          self(),
+          &Master::flushStatusUpdates,
+          framework->id());
+  } else if (framework->batchFull()) {
+    framework->flush();
+  }
+}
+
+
+void Master::flushStatusUpdates(const FrameworkID& frameworkId)
+{
+  Framework* framework = getFramework(frameworkId);
+
+  // The framework might have been removed in the meantime, in which
+  // case its batched updates are dropped along with it.
+  if (framework != NULL) {
+    framework->flush();
+  }
 }
 
 
@@ -4024,11 +3993,21 @@ void Master::shutdown(
 }
 
 
+void Master::shutdownSlaves(
+    const vector<SlaveID>& slaveIds,
+    const string& message)
+{
+  foreach (const SlaveID& slaveId, slaveIds) {
+    shutdownSlave(slaveId, message);
+  }
+}
+
+
 void Master::shutdownSlave(const SlaveID& slaveId, const string& message)
 {
   if (!slaves.registered.contains(slaveId)) {
-    // Possible when the SlaveObserver dispatched to shutdown a slave,
-    // but exited() was already called for this slave.
+    // Possible when the SlaveHealthChecker dispatched to shutdown a
+    // slave, but exited() was already called for this slave.
     LOG(WARNING) << "Unable to shutdown unknown slave " << slaveId;
     return;
   }
@@ -4101,6 +4080,33 @@ void Master::_reconcileTasks(
 {
   CHECK_NOTNULL(framework);
 
+  // Frameworks with the BATCHED_STATUS_UPDATES capability receive the
+  // replies packed into 'StatusUpdatesMessage's of up to
+  // MAX_STATUS_UPDATE_BATCH_SIZE rather than one message per task.
+  // After a master failover every framework reconciles all of its
+  // tasks at once, so this saves a lot of messages. The replies are
+  // sent right away instead of waiting for the batch interval, so
+  // this does not depend on '--status_update_batch_interval'.
+  const bool batch = framework->batchesStatusUpdates();
+
+  // TODO(bmahler): Consider using forward(); might lead to too
+  // much logging.
+  auto send = [framework, batch](const StatusUpdate& update) {
+    StatusUpdateMessage message;
+    message.mutable_update()->CopyFrom(update);
+
+    if (!batch) {
+      framework->send(message);
+      return;
+    }
+
+    framework->batch(message);
+
+    if (framework->batchFull()) {
+      framework->flush();
+    }
+  };
+
   if (statuses.empty()) {
     // Implicit reconciliation.
     LOG(INFO) << "Performing implicit task state reconciliation"
@@ -4122,14 +4128,10 @@ void Master::_reconcileTasks(
               << " for task " << update.status().task_id()
               << " of framework " << *framework;
 
-      // TODO(bmahler): Consider using forward(); might lead to too
-      // much logging.
-      StatusUpdateMessage message;
-      message.mutable_update()->CopyFrom(update);
-      framework->send(message);
+      send(update);
     }
 
-    foreachvalue (Task* task, framework->tasks) {
+    foreachvalue (TaskRecord* task, framework->tasks) {
       const TaskState& state = task->has_status_update_state()
           ? task->status_update_state()
           : task->state();
@@ -4148,20 +4150,17 @@ void Master::_reconcileTasks(
           "Reconciliation: Latest task state",
           TaskStatus::REASON_RECONCILIATION,
           executorId,
-          protobuf::getTaskHealth(*task));
+          task->health());
 
       VLOG(1) << "Sending implicit reconciliation state "
               << update.status().state()
               << " for task " << update.status().task_id()
               << " of framework " << *framework;
 
-      // TODO(bmahler): Consider using forward(); might lead to too
-      // much logging.
-      StatusUpdateMessage message;
-      message.mutable_update()->CopyFrom(update);
-      framework->send(message);
+      send(update);
     }
 
+    framework->flush();
     return;
   }
 
@@ -4189,7 +4188,7 @@ void Master::_reconcileTasks(
     }
 
     Option<StatusUpdate> update = None();
-    Task* task = framework->getTask(status.task_id());
+    TaskRecord* task = framework->getTask(status.task_id());
 
     if (framework->pendingTasks.contains(status.task_id())) {
       // (1) Task is known, but pending: TASK_STAGING.
@@ -4223,7 +4222,7 @@ void Master::_reconcileTasks(
           "Reconciliation: Latest task state",
           TaskStatus::REASON_RECONCILIATION,
           executorId,
-          protobuf::getTaskHealth(*task));
+          task->health());
     } else if (slaveId.isSome() && slaves.registered.contains(slaveId.get())) {
       // (3) Task is unknown, slave is registered: TASK_LOST.
       update = protobuf::createStatusUpdate(
@@ -4259,13 +4258,11 @@ void Master::_reconcileTasks(
               << " for task " << update.get().status().task_id()
               << " of framework " << *framework;
 
-      // TODO(bmahler): Consider using forward(); might lead to too
-      // much logging.
-      StatusUpdateMessage message;
-      message.mutable_update()->CopyFrom(update.get());
-      framework->send(message);
+      send(update.get());
     }
   }
+
+  framework->flush();
 }
 
 
@@ -4392,6 +4389,9 @@ void Master::offer(const FrameworkID& frameworkId,
     framework->addOffer(offer);
     slave->addOffer(offer);
 
+    changed(framework->id());
+    changed(slave->id);
+
     if (flags.offer_timeout.isSome()) {
       // Rescind the offer after the timeout elapses.
       offerTimers[offer->id()] =
@@ -4598,7 +4598,7 @@ void Master::reconcile(
     ReconcileTasksMessage reconcile;
     reconcile.mutable_framework_id()->CopyFrom(frameworkId);
 
-    foreachvalue (Task* task, utils::copy(slave->tasks[frameworkId])) {
+    foreachvalue (TaskRecord* task, utils::copy(slave->tasks[frameworkId])) {
       if (!slaveTasks.contains(task->framework_id(), task->task_id())) {
         LOG(WARNING) << "Task " << task->task_id()
                      << " of framework " << task->framework_id()
@@ -4738,6 +4738,8 @@ void Master::addFramework(Framework* framework)
   CHECK(!frameworks.registered.contains(framework->id()))
     << "Framework " << *framework << " already exists!";
 
+  changed(framework->id());
+
   CHECK_SOME(framework->pid) << "adding http framework not implemented";
 
   frameworks.registered[framework->id()] = framework;
@@ -4797,6 +4799,8 @@ void Master::failoverFramework(Framework* framework, const UPID& newPid)
 
   const UPID oldPid = framework->pid.get();
 
+  changed(framework->id());
+
   // There are a few failover cases to consider:
   //   1. The pid has changed. In this case we definitely want to
   //      send a FrameworkErrorMessage to shut down the older
@@ -4859,6 +4863,8 @@ void Master::removeFramework(Framework* framework)
 
   LOG(INFO) << "Removing framework " << *framework;
 
+  changed(framework->id());
+
   if (framework->active) {
     // Tell the allocator to stop allocating resources to this framework.
     // TODO(vinod): Consider setting  framework->active to false here
@@ -4877,7 +4883,7 @@ void Master::removeFramework(Framework* framework)
   framework->pendingTasks.clear();
 
   // Remove pointers to the framework's tasks in slaves.
-  foreachvalue (Task* task, utils::copy(framework->tasks)) {
+  foreachvalue (TaskRecord* task, utils::copy(framework->tasks)) {
     Slave* slave = slaves.registered.get(task->slave_id());
 
     // Since we only find out about tasks when the slave re-registers,
@@ -4946,6 +4952,13 @@ void Master::removeFramework(Framework* framework)
   // The completedFramework buffer now owns the framework pointer.
   frameworks.completed.push_back(shared_ptr<Framework>(framework));
 
+  if (archiver != NULL) {
+    // The tasks are archived separately, so we do not copy them.
+    dispatch(archiver->self(),
+             &Archiver::addFramework,
+             convert(*framework));
+  }
+
   CHECK(roles.contains(framework->info.role()))
     << "Unknown role " << framework->info.role()
     << " of framework " << *framework;
@@ -4989,10 +5002,13 @@ void Master::removeFramework(Slave* slave, Framework* framework)
   LOG(INFO) << "Removing framework " << *framework
             << " from slave " << *slave;
 
+  changed(framework->id());
+  changed(slave->id);
+
   // Remove pointers to framework's tasks in slaves, and send status
   // updates.
   // NOTE: A copy is needed because removeTask modifies slave->tasks.
-  foreachvalue (Task* task, utils::copy(slave->tasks[framework->id()])) {
+  foreachvalue (TaskRecord* task, utils::copy(slave->tasks[framework->id()])) {
     // Remove tasks that belong to this framework.
     if (task->framework_id() == framework->id()) {
       // A framework might not actually exist because the master failed
@@ -5036,20 +5052,12 @@ void Master::addSlave(
   slaves.removed.erase(slave->id);
   slaves.registered.put(slave);
 
-  link(slave->pid);
+  changed(slave->id);
 
-  // Set up an observer for the slave.
-  slave->observer = new SlaveObserver(
-      slave->pid,
-      slave->info,
-      slave->id,
-      self(),
-      slaves.limiter,
-      metrics,
-      flags.slave_ping_timeout,
-      flags.max_slave_ping_timeouts);
+  link(slave->pid);
 
-  spawn(slave->observer);
+  // Start checking the health of the slave.
+  dispatch(healthChecker, &SlaveHealthChecker::add, slave->id, slave->pid);
 
   // Add the slave's executors to the frameworks.
   foreachkey (const FrameworkID& frameworkId, slave->executors) {
@@ -5058,16 +5066,18 @@ void Master::addSlave(
       Framework* framework = getFramework(frameworkId);
       if (framework != NULL) { // The framework might not be re-registered yet.
         framework->addExecutor(slave->id, executorInfo);
+        changed(framework->id());
       }
     }
   }
 
   // Add the slave's tasks to the frameworks.
   foreachkey (const FrameworkID& frameworkId, slave->tasks) {
-    foreachvalue (Task* task, slave->tasks[frameworkId]) {
+    foreachvalue (TaskRecord* task, slave->tasks[frameworkId]) {
       Framework* framework = getFramework(task->framework_id());
       if (framework != NULL) { // The framework might not be re-registered yet.
         framework->addTask(task);
+        changed(framework->id());
       } else {
         // TODO(benh): We should really put a timeout on how long we
         // keep tasks running on a slave that never have frameworks
@@ -5095,6 +5105,7 @@ void Master::addSlave(
                 << " of framework " << *framework
                 << " that ran on slave " << *slave;
         framework->addCompletedTask(task);
+        changed(framework->id());
       } else {
         // We could be here if the framework hasn't registered yet.
         // TODO(vinod): Revisit these semantics when we store frameworks'
@@ -5123,6 +5134,8 @@ void Master::removeSlave(
 
   LOG(INFO) << "Removing slave " << *slave << ": " << message;
 
+  changed(slave->id);
+
   // We want to remove the slave first, to avoid the allocator
   // re-allocating the recovered resources.
   //
@@ -5138,7 +5151,7 @@ void Master::removeSlave(
   // after the slave is removed from the registry.
   vector<StatusUpdate> updates;
   foreachkey (const FrameworkID& frameworkId, utils::copy(slave->tasks)) {
-    foreachvalue (Task* task, utils::copy(slave->tasks[frameworkId])) {
+    foreachvalue (TaskRecord* task, utils::copy(slave->tasks[frameworkId])) {
       const StatusUpdate& update = protobuf::createStatusUpdate(
           task->framework_id(),
           task->slave_id(),
@@ -5182,10 +5195,8 @@ void Master::removeSlave(
   slaves.removed.put(slave->id, Nothing());
   authenticated.erase(slave->pid);
 
-  // Kill the slave observer.
-  terminate(slave->observer);
-  wait(slave->observer);
-  delete slave->observer;
+  // Stop checking the health of the slave.
+  dispatch(healthChecker, &SlaveHealthChecker::remove, slave->id);
 
   // TODO(benh): unlink(slave->pid);
 
@@ -5259,10 +5270,13 @@ void Master::_removeSlave(
 }
 
 
-void Master::updateTask(Task* task, const StatusUpdate& update)
+void Master::updateTask(TaskRecord* task, const StatusUpdate& update)
 {
   CHECK_NOTNULL(task);
 
+  changed(task->framework_id());
+  changed(task->slave_id());
+
   // Get the unacknowledged status.
   const TaskStatus& status = update.status();
 
@@ -5370,10 +5384,13 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
 }
 
 
-void Master::removeTask(Task* task)
+void Master::removeTask(TaskRecord* task)
 {
   CHECK_NOTNULL(task);
 
+  changed(task->framework_id());
+  changed(task->slave_id());
+
   // The slave owns the Task object and cannot be NULL.
   Slave* slave = slaves.registered.get(task->slave_id());
   CHECK_NOTNULL(slave);
@@ -5412,6 +5429,14 @@ void Master::removeTask(Task* task)
 }
 
 
+void Master::archiveTask(const TaskRecord& task)
+{
+  if (archiver != NULL) {
+    dispatch(archiver->self(), &Archiver::addTask, task.task());
+  }
+}
+
+
 void Master::removeExecutor(
     Slave* slave,
     const FrameworkID& frameworkId,
@@ -5420,6 +5445,9 @@ void Master::removeExecutor(
   CHECK_NOTNULL(slave);
   CHECK(slave->hasExecutor(frameworkId, executorId));
 
+  changed(frameworkId);
+  changed(slave->id);
+
   ExecutorInfo executor = slave->executors[frameworkId][executorId];
 
   LOG(INFO) << "Removing executor '" << executorId
@@ -5446,6 +5474,9 @@ void Master::applyOfferOperation(
   CHECK_NOTNULL(framework);
   CHECK_NOTNULL(slave);
 
+  changed(framework->id());
+  changed(slave->id);
+
   allocator->updateAllocation(
       framework->id(),
       slave->id,
@@ -5479,6 +5510,9 @@ void Master::offerTimeout(const OfferID& offerId)
 // 'useOffer()', 'discardOffer()' and 'rescindOffer()' for clarity.
 void Master::removeOffer(Offer* offer, bool rescind)
 {
+  changed(offer->framework_id());
+  changed(offer->slave_id());
+
   // Remove from framework.
   Framework* framework = getFramework(offer->framework_id());
   CHECK(framework != NULL)
@@ -5670,9 +5704,9 @@ double Master::_tasks_staging()
   }
 
   foreachvalue (Slave* slave, slaves.registered) {
-    typedef hashmap<TaskID, Task*> TaskMap;
+    typedef hashmap<TaskID, TaskRecord*> TaskMap;
     foreachvalue (const TaskMap& tasks, slave->tasks) {
-      foreachvalue (const Task* task, tasks) {
+      foreachvalue (const TaskRecord* task, tasks) {
         if (task->state() == TASK_STAGING) {
           count++;
         }
@@ -5689,9 +5723,9 @@ double Master::_tasks_starting()
   double count = 0.0;
 
   foreachvalue (Slave* slave, slaves.registered) {
-    typedef hashmap<TaskID, Task*> TaskMap;
+    typedef hashmap<TaskID, TaskRecord*> TaskMap;
     foreachvalue (const TaskMap& tasks, slave->tasks) {
-      foreachvalue (const Task* task, tasks) {
+      foreachvalue (const TaskRecord* task, tasks) {
         if (task->state() == TASK_STARTING) {
           count++;
         }
@@ -5708,9 +5742,9 @@ double Master::_tasks_running()
   double count = 0.0;
 
   foreachvalue (Slave* slave, slaves.registered) {
-    typedef hashmap<TaskID, Task*> TaskMap;
+    typedef hashmap<TaskID, TaskRecord*> TaskMap;
     foreachvalue (const TaskMap& tasks, slave->tasks) {
-      foreachvalue (const Task* task, tasks) {
+      foreachvalue (const TaskRecord* task, tasks) {
         if (task->state() == TASK_RUNNING) {
           count++;
         }
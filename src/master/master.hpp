@@ -46,6 +46,7 @@
 
 #include <process/metrics/counter.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/cache.hpp>
 #include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
@@ -64,8 +65,11 @@
 #include "master/contender.hpp"
 #include "master/detector.hpp"
 #include "master/flags.hpp"
+#include "master/http.pb.h"
 #include "master/metrics.hpp"
 #include "master/registrar.hpp"
+#include "master/replica.hpp"
+#include "master/task_record.hpp"
 #include "master/validation.hpp"
 
 #include "messages/messages.hpp"
@@ -87,8 +91,9 @@ class WhitelistWatcher;
 
 namespace master {
 
+class Archiver;
 class Repairer;
-class SlaveObserver;
+class SlaveHealthChecker;
 
 struct BoundedRateLimiter;
 struct Framework;
@@ -113,8 +118,7 @@ struct Slave
       registeredTime(_registeredTime),
       connected(true),
       active(true),
-      checkpointedResources(_checkpointedResources),
-      observer(NULL)
+      checkpointedResources(_checkpointedResources)
   {
     CHECK(_info.has_id());
 
@@ -124,7 +128,7 @@ struct Slave
 
     // NOTE: This should be validated during slave recovery.
     CHECK_SOME(resources);
-    totalResources = resources.get();
+    totalResources = std::move(resources.get());
 
     foreach (const ExecutorInfo& executorInfo, executorInfos) {
       CHECK(executorInfo.has_framework_id());
@@ -132,13 +136,13 @@ struct Slave
     }
 
     foreach (const Task& task, tasks) {
-      addTask(new Task(task));
+      addTask(new TaskRecord(task));
     }
   }
 
   ~Slave() {}
 
-  Task* getTask(const FrameworkID& frameworkId, const TaskID& taskId)
+  TaskRecord* getTask(const FrameworkID& frameworkId, const TaskID& taskId)
   {
     if (tasks.contains(frameworkId) && tasks[frameworkId].contains(taskId)) {
       return tasks[frameworkId][taskId];
@@ -146,7 +150,7 @@ struct Slave
     return NULL;
   }
 
-  void addTask(Task* task)
+  void addTask(TaskRecord* task)
   {
     const TaskID& taskId = task->task_id();
     const FrameworkID& frameworkId = task->framework_id();
@@ -169,7 +173,7 @@ struct Slave
   // TODO(bmahler): This is a hack for performance. We need to
   // maintain resource counters because computing task resources
   // functionally for all tasks is expensive, for now.
-  void taskTerminated(Task* task)
+  void taskTerminated(TaskRecord* task)
   {
     const TaskID& taskId = task->task_id();
     const FrameworkID& frameworkId = task->framework_id();
@@ -184,7 +188,7 @@ struct Slave
     }
   }
 
-  void removeTask(Task* task)
+  void removeTask(TaskRecord* task)
   {
     const TaskID& taskId = task->task_id();
     const FrameworkID& frameworkId = task->framework_id();
@@ -263,7 +267,7 @@ struct Slave
     Try<Resources> resources = totalResources.apply(operation);
     CHECK_SOME(resources);
 
-    totalResources = resources.get();
+    totalResources = std::move(resources.get());
     checkpointedResources = totalResources.filter(needCheckpointing);
   }
 
@@ -295,7 +299,7 @@ struct Slave
   // TODO(bmahler): The task pointer ownership complexity arises from the fact
   // that we own the pointer here, but it's shared with the Framework struct.
   // We should find a way to eliminate this.
-  hashmap<FrameworkID, hashmap<TaskID, Task*>> tasks;
+  hashmap<FrameworkID, hashmap<TaskID, TaskRecord*>> tasks;
 
   // Tasks that were asked to kill by frameworks.
   // This is used for reconciliation when the slave re-registers.
@@ -319,8 +323,6 @@ struct Slave
   // includes revocable resources as well.
   Resources totalResources;
 
-  SlaveObserver* observer;
-
 private:
   Slave(const Slave&);              // No copying.
   Slave& operator = (const Slave&); // No assigning.
@@ -457,6 +459,12 @@ public:
       const SlaveID& slaveId,
       const std::string& message);
 
+  // Shuts down the slaves whose health check timed out, see
+  // 'SlaveHealthChecker'.
+  void shutdownSlaves(
+      const std::vector<SlaveID>& slaveIds,
+      const std::string& message);
+
   void authenticate(
       const process::UPID& from,
       const process::UPID& pid);
@@ -646,10 +654,10 @@ protected:
 
   // Transitions the task, and recovers resources if the task becomes
   // terminal.
-  void updateTask(Task* task, const StatusUpdate& update);
+  void updateTask(TaskRecord* task, const StatusUpdate& update);
 
   // Removes the task.
-  void removeTask(Task* task);
+  void removeTask(TaskRecord* task);
 
   // Remove an executor and recover its resources.
   void removeExecutor(
@@ -665,12 +673,17 @@ protected:
       Slave* slave,
       const Offer::Operation& operation);
 
-  // Forwards the update to the framework.
+  // Forwards the update to the framework. The update is batched if
+  // the framework has the BATCHED_STATUS_UPDATES capability.
   void forward(
       const StatusUpdate& update,
       const process::UPID& acknowledgee,
       Framework* framework);
 
+  // Sends the batched status updates of the framework, if it is
+  // still registered.
+  void flushStatusUpdates(const FrameworkID& frameworkId);
+
   // Remove an offer after specified timeout
   void offerTimeout(const OfferID& offerId);
 
@@ -723,6 +736,8 @@ private:
 
   void revive(Framework* framework);
 
+  void suppressOffers(Framework* framework);
+
   void kill(
       Framework* framework,
       const scheduler::Call::Kill& kill);
@@ -787,32 +802,12 @@ private:
     process::Future<process::http::Response> teardown(
         const process::http::Request& request) const;
 
-    // /master/slaves
-    process::Future<process::http::Response> slaves(
-        const process::http::Request& request) const;
-
-    // /master/state.json
-    process::Future<process::http::Response> state(
-        const process::http::Request& request) const;
-
-    // /master/state-summary
-    process::Future<process::http::Response> stateSummary(
-        const process::http::Request& request) const;
-
-    // /master/tasks.json
-    process::Future<process::http::Response> tasks(
-        const process::http::Request& request) const;
-
     const static std::string CALL_HELP;
     const static std::string HEALTH_HELP;
     const static std::string OBSERVE_HELP;
     const static std::string REDIRECT_HELP;
     const static std::string ROLES_HELP;
     const static std::string TEARDOWN_HELP;
-    const static std::string SLAVES_HELP;
-    const static std::string STATE_HELP;
-    const static std::string STATESUMMARY_HELP;
-    const static std::string TASKS_HELP;
 
   private:
     // Helper for doing authentication, returns the credential used if
@@ -1099,6 +1094,68 @@ private:
 
   Option<process::Time> electedTime; // Time when this master is elected.
 
+  // The version of the master state, incremented by the handlers
+  // that change the state included in the snapshots (e.g., adding a
+  // task or an offer, see 'addTask()' and 'offer()').
+  uint64_t version;
+
+  // Marks the state as changed: increments the version and schedules
+  // publishing a snapshot to the read replica once the events that
+  // are already queued are processed, i.e., after the current batch
+  // of changes (see 'publish()').
+  void changed();
+
+  // Marks the framework (or slave) as changed and drops its record,
+  // so that the next snapshot converts it again.
+  void changed(const FrameworkID& frameworkId);
+  void changed(const SlaveID& slaveId);
+
+  // Publishes a snapshot to the read replica if the state changed
+  // since the last one was published. Snapshots are published at
+  // most once per --max_state_staleness, a later one is scheduled
+  // otherwise. The requests for the read-only endpoints publish the
+  // pending changes before they are forwarded to the replica, so
+  // that they observe the changes that preceded them.
+  void publish();
+  void _publish();
+
+  // Returns a snapshot of the master state. A new snapshot is only
+  // taken if the state changed since the last one was published. See
+  // master/snapshot.cpp.
+  std::shared_ptr<const Snapshot> snapshot();
+
+  // The last snapshot published to the replica, when it was
+  // published, and whether publishing a snapshot is scheduled.
+  std::shared_ptr<const Snapshot> published;
+  process::Time publishedTime;
+  bool publishing;
+
+  // The records of the frameworks and slaves as of the last snapshot.
+  // They are immutable, so snapshots share the records of the
+  // frameworks and slaves that have not changed since instead of
+  // converting them again, see 'changed()'.
+  struct
+  {
+    hashmap<FrameworkID, std::shared_ptr<const Snapshot::Framework>>
+      frameworks;
+    hashmap<FrameworkID, std::shared_ptr<const Snapshot::Framework>>
+      completedFrameworks;
+    hashmap<SlaveID, std::shared_ptr<const StateResponse::Slave>> slaves;
+  } records;
+
+  // Serves the read-only endpoints (e.g., /master/state.json).
+  ReadReplica* replica;
+
+  // Pings the registered slaves and shuts down the unhealthy ones.
+  SlaveHealthChecker* healthChecker;
+
+  // Archives the completed tasks and frameworks on disk if
+  // --archive_dir is set, NULL otherwise.
+  Archiver* archiver;
+
+  // Adds the completed task to the archive, if any.
+  void archiveTask(const TaskRecord& task);
+
   // Validates the framework including authorization.
   // Returns None if the framework is valid.
   // Returns Error if the framework is invalid.
@@ -1235,7 +1292,7 @@ struct Framework
       active(true),
       registeredTime(time),
       reregisteredTime(time),
-      completedTasks(MAX_COMPLETED_TASKS_PER_FRAMEWORK) {}
+      completedTasks(_master->flags.max_completed_tasks_per_framework) {}
 
   Framework(Master* const _master,
             const FrameworkInfo& _info,
@@ -1248,7 +1305,7 @@ struct Framework
       active(true),
       registeredTime(time),
       reregisteredTime(time),
-      completedTasks(MAX_COMPLETED_TASKS_PER_FRAMEWORK)
+      completedTasks(_master->flags.max_completed_tasks_per_framework)
   {
     // TODO(anand): This logic needs to be invoked each
     // time the framework connects via http. Move it to
@@ -1281,7 +1338,7 @@ struct Framework
     }
   }
 
-  Task* getTask(const TaskID& taskId)
+  TaskRecord* getTask(const TaskID& taskId)
   {
     if (tasks.count(taskId) > 0) {
       return tasks[taskId];
@@ -1290,7 +1347,7 @@ struct Framework
     }
   }
 
-  void addTask(Task* task)
+  void addTask(TaskRecord* task)
   {
     CHECK(!tasks.contains(task->task_id()))
       << "Duplicate task " << task->task_id()
@@ -1308,7 +1365,7 @@ struct Framework
   // TODO(bmahler): This is a hack for performance. We need to
   // maintain resource counters because computing task resources
   // functionally for all tasks is expensive, for now.
-  void taskTerminated(Task* task)
+  void taskTerminated(TaskRecord* task)
   {
     CHECK(protobuf::isTerminalState(task->state()));
     CHECK(tasks.contains(task->task_id()))
@@ -1322,10 +1379,13 @@ struct Framework
     }
   }
 
-  // Sends a message to the connected framework.
+  // Sends a message to the connected framework. Any batched status
+  // updates are sent first to preserve the order of the messages.
   template <typename Message>
   void send(const Message& message)
   {
+    flush();
+
     if (!connected) {
       LOG(WARNING) << "Master attempted to send message to disconnected"
                    << " framework " << *this;
@@ -1344,13 +1404,90 @@ struct Framework
     }
   }
 
+  // Whether the framework accepts status updates in batches.
+  bool batchesStatusUpdates() const
+  {
+    foreach (const FrameworkInfo::Capability& capability,
+             info.capabilities()) {
+      if (capability.type() ==
+          FrameworkInfo::Capability::BATCHED_STATUS_UPDATES) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Adds a status update to the next batch, see 'flush()'.
+  void batch(const StatusUpdateMessage& message)
+  {
+    CHECK(batchesStatusUpdates());
+
+    batchedUpdates.push_back(message);
+    batchedBytes += Bytes(message.ByteSize());
+  }
+
+  // Whether the batched status updates should be sent right away.
+  bool batchFull() const
+  {
+    return batchedBytes >= MAX_STATUS_UPDATE_BATCH_SIZE;
+  }
+
+  // Sends the batched status updates, if any. Driver based frameworks
+  // receive a single 'StatusUpdatesMessage' while HTTP frameworks
+  // receive all of the UPDATE events in a single chunk.
+  void flush()
+  {
+    if (batchedUpdates.empty()) {
+      return;
+    }
+
+    if (!connected) {
+      LOG(WARNING) << "Master attempted to send status updates to"
+                   << " disconnected framework " << *this;
+    }
+
+    if (http.isSome()) {
+      std::string chunk;
+      foreach (const StatusUpdateMessage& message, batchedUpdates) {
+        chunk += http.get().encoder.encode(
+            protobuf::scheduler::event(message));
+      }
+
+      if (!http.get().writer.write(chunk)) {
+        LOG(WARNING) << "Unable to send events to framework " << *this
+                     << ": connection closed";
+      }
+    } else {
+      CHECK_SOME(pid);
+
+      StatusUpdatesMessage message;
+      foreach (const StatusUpdateMessage& update, batchedUpdates) {
+        message.add_updates()->CopyFrom(update);
+      }
+
+      master->send(pid.get(), message);
+    }
+
+    batchedUpdates.clear();
+    batchedBytes = Bytes(0);
+  }
+
   void addCompletedTask(const Task& task)
+  {
+    addCompletedTask(TaskRecord(task));
+  }
+
+  void addCompletedTask(const TaskRecord& task)
   {
     // TODO(adam-mesos): Check if completed task already exists.
-    completedTasks.push_back(std::shared_ptr<Task>(new Task(task)));
+    completedTasks.push_back(
+        std::shared_ptr<TaskRecord>(new TaskRecord(task)));
+
+    master->archiveTask(task);
   }
 
-  void removeTask(Task* task)
+  void removeTask(TaskRecord* task)
   {
     CHECK(tasks.contains(task->task_id()))
       << "Unknown task " << task->task_id()
@@ -1527,12 +1664,12 @@ struct Framework
   // being authorized.
   hashmap<TaskID, TaskInfo> pendingTasks;
 
-  hashmap<TaskID, Task*> tasks;
+  hashmap<TaskID, TaskRecord*> tasks;
 
-  // NOTE: We use a shared pointer for Task because clang doesn't like
-  // Boost's implementation of circular_buffer with Task (Boost
+  // NOTE: We use a shared pointer for TaskRecord because clang doesn't
+  // like Boost's implementation of circular_buffer with Task (Boost
   // attempts to do some memset's which are unsafe).
-  boost::circular_buffer<std::shared_ptr<Task>> completedTasks;
+  boost::circular_buffer<std::shared_ptr<TaskRecord>> completedTasks;
 
   hashset<Offer*> offers; // Active offers for framework.
 
@@ -1568,6 +1705,11 @@ struct Framework
   Resources totalOfferedResources;
   hashmap<SlaveID, Resources> offeredResources;
 
+  // Status updates waiting to be sent in the next batch, in the
+  // order in which they were received, and their serialized size.
+  std::vector<StatusUpdateMessage> batchedUpdates;
+  Bytes batchedBytes;
+
 private:
   Framework(const Framework&);              // No copying.
   Framework& operator = (const Framework&); // No assigning.
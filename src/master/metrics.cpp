@@ -114,6 +114,8 @@ Metrics::Metrics(const Master& master)
         "master/messages_decline_offers"),
     messages_revive_offers(
         "master/messages_revive_offers"),
+    messages_suppress_offers(
+        "master/messages_suppress_offers"),
     messages_reconcile_tasks(
         "master/messages_reconcile_tasks"),
     messages_framework_to_executor(
@@ -218,6 +220,7 @@ Metrics::Metrics(const Master& master)
   process::metrics::add(messages_launch_tasks);
   process::metrics::add(messages_decline_offers);
   process::metrics::add(messages_revive_offers);
+  process::metrics::add(messages_suppress_offers);
   process::metrics::add(messages_reconcile_tasks);
   process::metrics::add(messages_framework_to_executor);
   process::metrics::add(messages_executor_to_framework);
@@ -353,6 +356,7 @@ Metrics::~Metrics()
   process::metrics::remove(messages_launch_tasks);
   process::metrics::remove(messages_decline_offers);
   process::metrics::remove(messages_revive_offers);
+  process::metrics::remove(messages_suppress_offers);
   process::metrics::remove(messages_reconcile_tasks);
   process::metrics::remove(messages_framework_to_executor);
   process::metrics::remove(messages_executor_to_framework);
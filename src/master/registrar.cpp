@@ -17,10 +17,13 @@
  */
 
 #include <deque>
+#include <list>
+#include <set>
 #include <string>
 
 #include <mesos/type_utils.hpp>
 
+#include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
@@ -34,12 +37,15 @@
 #include <process/metrics/metrics.hpp>
 #include <process/metrics/timer.hpp>
 
+#include <stout/hashset.hpp>
 #include <stout/lambda.hpp>
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
 #include <stout/option.hpp>
 #include <stout/protobuf.hpp>
 #include <stout/stopwatch.hpp>
+#include <stout/strings.hpp>
+#include <stout/uuid.hpp>
 
 #include "master/registrar.hpp"
 #include "master/registry.hpp"
@@ -49,6 +55,7 @@
 using mesos::internal::state::protobuf::State;
 using mesos::internal::state::protobuf::Variable;
 
+using process::await;
 using process::dispatch;
 using process::spawn;
 using process::terminate;
@@ -70,6 +77,8 @@ using process::metrics::Gauge;
 using process::metrics::Timer;
 
 using std::deque;
+using std::list;
+using std::set;
 using std::string;
 
 namespace mesos {
@@ -79,6 +88,15 @@ namespace master {
 using process::http::Response;
 using process::http::Request;
 
+// Names of the variables in which the registry is stored, see
+// --registry_max_journal_entries. Snapshots are named with a random
+// suffix so that a new one can be stored before the journal is
+// switched over to it.
+static const string REGISTRY = "registry";
+static const string JOURNAL = "registry_journal";
+static const string SNAPSHOT = "registry_snapshot_";
+
+
 class RegistrarProcess : public Process<RegistrarProcess>
 {
 public:
@@ -171,8 +189,8 @@ private:
 
   Future<double> _registry_size_bytes()
   {
-    if (variable.isSome()) {
-      return variable.get().get().ByteSize();
+    if (current.isSome()) {
+      return current.get().ByteSize();
     }
 
     return Failure("Not recovered yet");
@@ -181,23 +199,80 @@ private:
   // Continuations.
   void _recover(
       const MasterInfo& info,
-      const Future<Variable<Registry> >& recovery);
+      const Future<Registry>& recovery);
   void __recover(const Future<bool>& recover);
   Future<bool> _apply(Owned<Operation> operation);
 
+  // Fetches the 'registry' and 'registry_journal' variables, and the
+  // snapshot of the journal (if any), and expunges the snapshots left
+  // behind. Returns the registry they hold.
+  Future<Registry> fetch();
+  Future<Registry> _fetch(const Variable<Registry::Journal>& journal);
+  Future<Registry> __fetch(const Variable<Registry>& variable);
+  Future<Registry> ___fetch(const Variable<Registry>& snapshot);
+
   // Helper for updating state (performing store).
   void update();
   void _update(
-      const Future<Option<Variable<Registry> > >& store,
+      const Future<bool>& store,
+      const Registry& registry,
       deque<Owned<Operation> > operations);
 
+  // Stores the registry as a whole in the 'registry' variable.
+  // Returns false if the variable (or the journal, if the registry
+  // was stored in the journal format so far) has been changed by
+  // another master.
+  Future<bool> store(const Registry& registry);
+  Future<bool> _store(const Option<Variable<Registry> >& variable);
+  Future<bool> __store(const Option<Variable<Registry::Journal> >& journal);
+
+  // Appends the changes to the journal, or stores a new snapshot of
+  // the registry if the journal is full (see 'compact()'). Returns
+  // false if the journal has been changed by another master.
+  Future<bool> append(const Registry& registry, const Registry::Delta& delta);
+  Future<bool> _append(const Option<Variable<Registry::Journal> >& journal);
+
+  // Stores the registry as a new snapshot, then replaces the journal
+  // with an empty one for the new snapshot. Only the latter is
+  // subject to the version check of the journal, since no other
+  // master knows of the new snapshot variable.
+  Future<bool> compact(const Registry& registry);
+  Future<bool> _compact(
+      const string& name,
+      const Registry& registry,
+      const Variable<Registry>& snapshot);
+  Future<bool> __compact(
+      const string& name,
+      const Option<Variable<Registry> >& snapshot);
+  Future<bool> ___compact(
+      const Variable<Registry>& snapshot,
+      const Option<Variable<Registry::Journal> >& journal);
+
+  // Expunges the snapshots that the journal does not refer to, then
+  // returns the fetched registry. These are left behind if a master
+  // fails over after storing a new snapshot but before switching the
+  // journal over to it (see 'compact()').
+  Future<Registry> expunge(const Registry& registry);
+  Future<Registry> _expunge(const Registry& registry, const set<string>& names);
+  Future<bool> __expunge(const Variable<Registry>& snapshot);
+
   // Fails all pending operations and transitions the Registrar
   // into an error state in which all subsequent operations will fail.
   // This ensures we don't attempt to re-acquire log leadership by
   // performing more State storage operations.
   void abort(const string& message);
 
+  // The latest registry, i.e., as it was last stored.
+  Option<Registry> current;
+
+  // The 'registry' variable, i.e., the registry stored as a whole.
   Option<Variable<Registry> > variable;
+
+  // The 'registry_journal' variable and the snapshot it refers to
+  // (if any), see --registry_max_journal_entries.
+  Option<Variable<Registry::Journal> > journal;
+  Option<Variable<Registry> > snapshot;
+
   deque<Owned<Operation> > operations;
   bool updating; // Used to signify fetching (recovering) or storing.
 
@@ -227,6 +302,78 @@ Future<T> timeout(
 }
 
 
+// Returns the changes from 'before' to 'after', given the IDs of the
+// slaves in each.
+// NOTE: A slave that is removed and admitted again within the same
+// batch of operations is not part of the changes, which is fine since
+// slave IDs are never reused.
+Registry::Delta diff(
+    const Registry& before,
+    const hashset<SlaveID>& beforeIDs,
+    const Registry& after,
+    const hashset<SlaveID>& afterIDs)
+{
+  Registry::Delta delta;
+
+  // NOTE: The master is not initialized before the first recovery.
+  if (before.master().SerializePartialAsString() !=
+      after.master().SerializePartialAsString()) {
+    delta.mutable_master()->CopyFrom(after.master());
+  }
+
+  foreach (const SlaveID& slaveId, beforeIDs) {
+    if (!afterIDs.contains(slaveId)) {
+      delta.add_removed()->CopyFrom(slaveId);
+    }
+  }
+
+  // Slaves are admitted at the end of the registry, so the order of
+  // the slaves is kept when the changes are applied.
+  foreach (const Registry::Slave& slave, after.slaves().slaves()) {
+    if (!beforeIDs.contains(slave.info().id())) {
+      delta.add_admitted()->CopyFrom(slave);
+    }
+  }
+
+  return delta;
+}
+
+
+// Applies the changes to the registry, see 'diff()'.
+void patch(const Registry::Delta& delta, Registry* registry)
+{
+  if (delta.has_master()) {
+    registry->mutable_master()->CopyFrom(delta.master());
+  }
+
+  if (delta.removed_size() > 0) {
+    hashset<SlaveID> removed;
+    foreach (const SlaveID& slaveId, delta.removed()) {
+      removed.insert(slaveId);
+    }
+
+    // Remove the slaves while keeping the order of the others.
+    google::protobuf::RepeatedPtrField<Registry::Slave>* slaves =
+      registry->mutable_slaves()->mutable_slaves();
+
+    int size = 0;
+    for (int i = 0; i < slaves->size(); i++) {
+      if (!removed.contains(slaves->Get(i).info().id())) {
+        slaves->SwapElements(i, size++);
+      }
+    }
+
+    while (slaves->size() > size) {
+      slaves->RemoveLast();
+    }
+  }
+
+  foreach (const Registry::Slave& slave, delta.admitted()) {
+    registry->mutable_slaves()->add_slaves()->CopyFrom(slave);
+  }
+}
+
+
 // Helper for failing a deque of operations.
 void fail(deque<Owned<Operation> >* operations, const string& message)
 {
@@ -243,8 +390,8 @@ Future<Response> RegistrarProcess::registry(const Request& request)
 {
   JSON::Object result;
 
-  if (variable.isSome()) {
-    result = JSON::Protobuf(variable.get().get());
+  if (current.isSome()) {
+    result = JSON::Protobuf(current.get());
   }
 
   return OK(result, request.query.get("jsonp"));
@@ -313,10 +460,10 @@ Future<Registry> RegistrarProcess::recover(const MasterInfo& info)
     LOG(INFO) << "Recovering registrar";
 
     metrics.state_fetch.start();
-    state->fetch<Registry>("registry")
+    fetch()
       .after(flags.registry_fetch_timeout,
              lambda::bind(
-                 &timeout<Variable<Registry> >,
+                 &timeout<Registry>,
                  "fetch",
                  flags.registry_fetch_timeout,
                  lambda::_1))
@@ -331,7 +478,7 @@ Future<Registry> RegistrarProcess::recover(const MasterInfo& info)
 
 void RegistrarProcess::_recover(
     const MasterInfo& info,
-    const Future<Variable<Registry> >& recovery)
+    const Future<Registry>& recovery)
 {
   updating = false;
 
@@ -344,11 +491,11 @@ void RegistrarProcess::_recover(
     Duration elapsed = metrics.state_fetch.stop();
 
     LOG(INFO) << "Successfully fetched the registry"
-              << " (" << Bytes(recovery.get().get().ByteSize()) << ")"
+              << " (" << Bytes(recovery.get().ByteSize()) << ")"
               << " in " << elapsed;
 
     // Save the registry.
-    variable = recovery.get();
+    current = recovery.get();
 
     // Perform the Recover operation to add the new MasterInfo.
     Owned<Operation> operation(new Recover(info));
@@ -375,11 +522,11 @@ void RegistrarProcess::__recover(const Future<bool>& recover)
   } else {
     LOG(INFO) << "Successfully recovered registrar";
 
-    // At this point _update() has updated 'variable' to contain
+    // At this point _update() has updated 'current' to contain
     // the Registry with the latest MasterInfo.
     // Set the promise and un-gate any pending operations.
-    CHECK_SOME(variable);
-    recovered.get()->set(variable.get().get());
+    CHECK_SOME(current);
+    recovered.get()->set(current.get());
   }
 }
 
@@ -401,7 +548,7 @@ Future<bool> RegistrarProcess::_apply(Owned<Operation> operation)
     return Failure(error.get());
   }
 
-  CHECK_SOME(variable);
+  CHECK_SOME(current);
 
   operations.push_back(operation);
   Future<bool> future = operation->future();
@@ -420,7 +567,7 @@ void RegistrarProcess::update()
 
   CHECK(!updating);
   CHECK_NONE(error);
-  CHECK_SOME(variable);
+  CHECK_SOME(current);
 
   // Time how long it takes to apply the operations.
   Stopwatch stopwatch;
@@ -429,7 +576,7 @@ void RegistrarProcess::update()
   updating = true;
 
   // Create a snapshot of the current registry.
-  Registry registry = variable.get().get();
+  Registry registry = current.get();
 
   // Create the 'slaveIDs' accumulator.
   hashset<SlaveID> slaveIDs;
@@ -437,6 +584,11 @@ void RegistrarProcess::update()
     slaveIDs.insert(slave.info().id());
   }
 
+  // The slaves before the operations are needed to determine the
+  // changes that are appended to the journal.
+  const bool journaling = flags.registry_max_journal_entries > 0;
+  const hashset<SlaveID> before = journaling ? slaveIDs : hashset<SlaveID>();
+
   foreach (Owned<Operation> operation, operations) {
     // No need to process the result of the operation.
     (*operation)(&registry, &slaveIDs, flags.registry_strict);
@@ -447,14 +599,19 @@ void RegistrarProcess::update()
 
   // Perform the store, and time the operation.
   metrics.state_store.start();
-  state->store(variable.get().mutate(registry))
+
+  Future<bool> future = journaling
+    ? append(registry, diff(current.get(), before, registry, slaveIDs))
+    : store(registry);
+
+  future
     .after(flags.registry_store_timeout,
            lambda::bind(
-               &timeout<Option<Variable<Registry> > >,
+               &timeout<bool>,
                "store",
                flags.registry_store_timeout,
                lambda::_1))
-    .onAny(defer(self(), &Self::_update, lambda::_1, operations));
+    .onAny(defer(self(), &Self::_update, lambda::_1, registry, operations));
 
   // Clear the operations, _update will transition the Promises!
   operations.clear();
@@ -462,13 +619,14 @@ void RegistrarProcess::update()
 
 
 void RegistrarProcess::_update(
-    const Future<Option<Variable<Registry> > >& store,
+    const Future<bool>& store,
+    const Registry& registry,
     deque<Owned<Operation> > applied)
 {
   updating = false;
 
   // Abort if the storage operation did not succeed.
-  if (!store.isReady() || store.get().isNone()) {
+  if (!store.isReady() || !store.get()) {
     string message = "Failed to update 'registry': ";
 
     if (store.isFailed()) {
@@ -489,7 +647,7 @@ void RegistrarProcess::_update(
 
   LOG(INFO) << "Successfully updated the 'registry' in " << elapsed;
 
-  variable = store.get().get();
+  current = registry;
 
   // Remove the operations.
   while (!applied.empty()) {
@@ -505,6 +663,246 @@ void RegistrarProcess::_update(
 }
 
 
+Future<Registry> RegistrarProcess::fetch()
+{
+  return state->fetch<Registry::Journal>(JOURNAL)
+    .then(defer(self(), &Self::_fetch, lambda::_1))
+    .then(defer(self(), &Self::expunge, lambda::_1));
+}
+
+
+Future<Registry> RegistrarProcess::_fetch(
+    const Variable<Registry::Journal>& journal)
+{
+  this->journal = journal;
+
+  // NOTE: The 'registry' variable is needed even if the registry is
+  // stored in the journal format, in case it needs to be stored as a
+  // whole again (i.e., if --registry_max_journal_entries is 0).
+  return state->fetch<Registry>(REGISTRY)
+    .then(defer(self(), &Self::__fetch, lambda::_1));
+}
+
+
+Future<Registry> RegistrarProcess::__fetch(const Variable<Registry>& variable)
+{
+  this->variable = variable;
+
+  if (!journal.get().get().has_snapshot()) {
+    return variable.get();
+  }
+
+  return state->fetch<Registry>(journal.get().get().snapshot())
+    .then(defer(self(), &Self::___fetch, lambda::_1));
+}
+
+
+Future<Registry> RegistrarProcess::___fetch(const Variable<Registry>& snapshot)
+{
+  this->snapshot = snapshot;
+
+  const Registry::Journal journal = this->journal.get().get();
+
+  LOG(INFO) << "Replaying " << journal.deltas_size() << " changes to the"
+            << " registry from the journal";
+
+  Registry registry = snapshot.get();
+  foreach (const Registry::Delta& delta, journal.deltas()) {
+    patch(delta, &registry);
+  }
+
+  return registry;
+}
+
+
+Future<Registry> RegistrarProcess::expunge(const Registry& registry)
+{
+  // NOTE: No snapshot is stored while recovering, so all of the other
+  // snapshots are orphaned.
+  return state->names()
+    .then(defer(self(), &Self::_expunge, registry, lambda::_1));
+}
+
+
+Future<Registry> RegistrarProcess::_expunge(
+    const Registry& registry,
+    const set<string>& names)
+{
+  CHECK_SOME(journal);
+
+  list<Future<bool>> expunged;
+
+  foreach (const string& name, names) {
+    if (strings::startsWith(name, SNAPSHOT) &&
+        name != journal.get().get().snapshot()) {
+      LOG(INFO) << "Expunging the orphaned registry snapshot '" << name << "'";
+
+      expunged.push_back(state->fetch<Registry>(name)
+        .then(defer(self(), &Self::__expunge, lambda::_1)));
+    }
+  }
+
+  // Failing to expunge a snapshot only leaves it behind, so the
+  // registry is recovered either way.
+  return await(expunged)
+    .then([=]() { return registry; });
+}
+
+
+Future<bool> RegistrarProcess::__expunge(const Variable<Registry>& snapshot)
+{
+  return state->expunge(snapshot);
+}
+
+
+Future<bool> RegistrarProcess::store(const Registry& registry)
+{
+  CHECK_SOME(variable);
+
+  return state->store(variable.get().mutate(registry))
+    .then(defer(self(), &Self::_store, lambda::_1));
+}
+
+
+Future<bool> RegistrarProcess::_store(
+    const Option<Variable<Registry> >& variable)
+{
+  if (variable.isNone()) {
+    return false; // Version mismatch.
+  }
+
+  this->variable = variable;
+
+  CHECK_SOME(journal);
+
+  // Clear the journal if the registry was stored in the journal
+  // format so far, so that the 'registry' variable is recovered.
+  if (journal.get().get().has_snapshot()) {
+    return state->store(journal.get().mutate(Registry::Journal()))
+      .then(defer(self(), &Self::__store, lambda::_1));
+  }
+
+  return true;
+}
+
+
+Future<bool> RegistrarProcess::__store(
+    const Option<Variable<Registry::Journal> >& journal)
+{
+  if (journal.isNone()) {
+    return false; // Version mismatch.
+  }
+
+  this->journal = journal;
+
+  // The snapshot is not needed anymore.
+  if (snapshot.isSome()) {
+    state->expunge(snapshot.get());
+    snapshot = None();
+  }
+
+  return true;
+}
+
+
+Future<bool> RegistrarProcess::append(
+    const Registry& registry,
+    const Registry::Delta& delta)
+{
+  CHECK_SOME(journal);
+
+  Registry::Journal journal = this->journal.get().get();
+
+  // Store a new snapshot once the journal is full, or when it would
+  // be larger than the registry itself. This bounds the size of both
+  // the journal and the changes that are replayed during recovery.
+  if (!journal.has_snapshot() ||
+      journal.deltas_size() >= (int) flags.registry_max_journal_entries ||
+      journal.ByteSize() + delta.ByteSize() >= registry.ByteSize()) {
+    return compact(registry);
+  }
+
+  journal.add_deltas()->CopyFrom(delta);
+
+  return state->store(this->journal.get().mutate(journal))
+    .then(defer(self(), &Self::_append, lambda::_1));
+}
+
+
+Future<bool> RegistrarProcess::_append(
+    const Option<Variable<Registry::Journal> >& journal)
+{
+  if (journal.isNone()) {
+    return false; // Version mismatch.
+  }
+
+  this->journal = journal;
+
+  return true;
+}
+
+
+Future<bool> RegistrarProcess::compact(const Registry& registry)
+{
+  const string name = SNAPSHOT + UUID::random().toString();
+
+  return state->fetch<Registry>(name)
+    .then(defer(self(), &Self::_compact, name, registry, lambda::_1));
+}
+
+
+Future<bool> RegistrarProcess::_compact(
+    const string& name,
+    const Registry& registry,
+    const Variable<Registry>& snapshot)
+{
+  return state->store(snapshot.mutate(registry))
+    .then(defer(self(), &Self::__compact, name, lambda::_1));
+}
+
+
+Future<bool> RegistrarProcess::__compact(
+    const string& name,
+    const Option<Variable<Registry> >& snapshot)
+{
+  if (snapshot.isNone()) {
+    return false; // Version mismatch.
+  }
+
+  CHECK_SOME(journal);
+
+  Registry::Journal journal;
+  journal.set_snapshot(name);
+
+  return state->store(this->journal.get().mutate(journal))
+    .then(defer(self(), &Self::___compact, snapshot.get(), lambda::_1));
+}
+
+
+Future<bool> RegistrarProcess::___compact(
+    const Variable<Registry>& snapshot,
+    const Option<Variable<Registry::Journal> >& journal)
+{
+  if (journal.isNone()) {
+    // Another master has changed the journal, the new snapshot is
+    // not referenced by it.
+    state->expunge(snapshot);
+    return false; // Version mismatch.
+  }
+
+  this->journal = journal;
+
+  // The previous snapshot is not needed anymore.
+  if (this->snapshot.isSome()) {
+    state->expunge(this->snapshot.get());
+  }
+
+  this->snapshot = snapshot;
+
+  return true;
+}
+
+
 void RegistrarProcess::abort(const string& message)
 {
   error = Error(message);
@@ -0,0 +1,1545 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+
+#include <mesos/resources.hpp>
+#include <mesos/type_utils.hpp>
+
+#include <process/defer.hpp>
+#include <process/dispatch.hpp>
+#include <process/help.hpp>
+#include <process/id.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/json.hpp>
+#include <stout/lambda.hpp>
+#include <stout/numify.hpp>
+#include <stout/result.hpp>
+#include <stout/stringify.hpp>
+
+#include "common/attributes.hpp"
+#include "common/http.hpp"
+
+#include "master/constants.hpp"
+#include "master/master.hpp"
+#include "master/replica.hpp"
+
+using process::DESCRIPTION;
+using process::Future;
+using process::HELP;
+using process::TLDR;
+using process::USAGE;
+
+using process::http::BadRequest;
+using process::http::OK;
+using process::http::Pipe;
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+// Pull in model overrides from common.
+using mesos::internal::model;
+
+// Pull in definitions from process.
+using process::http::Response;
+using process::http::Request;
+
+// The shared records of a snapshot, see 'Snapshot'.
+typedef std::shared_ptr<const Snapshot::Framework> FrameworkRecord;
+typedef std::shared_ptr<const StateResponse::Slave> SlaveRecord;
+
+
+// Returns a JSON object modeled on an Offer.
+JSON::Object model(const Offer& offer)
+{
+  JSON::Object object;
+  object.values["id"] = offer.id().value();
+  object.values["framework_id"] = offer.framework_id().value();
+  object.values["slave_id"] = offer.slave_id().value();
+  object.values["resources"] = model(offer.resources());
+  return object;
+}
+
+
+// Returns a JSON object summarizing some important fields in a
+// Framework.
+JSON::Object summarize(const StateResponse::Framework& framework)
+{
+  JSON::Object object;
+  object.values["id"] = framework.info().id().value();
+  object.values["name"] = framework.info().name();
+
+  // Omit pid for http frameworks.
+  if (framework.has_pid()) {
+    object.values["pid"] = framework.pid();
+  }
+
+  // TODO(bmahler): Use these in the webui.
+  object.values["used_resources"] =
+    model(Resources(framework.used_resources()));
+  object.values["offered_resources"] =
+    model(Resources(framework.offered_resources()));
+
+  {
+      JSON::Array array;
+      array.values.reserve(framework.info().capabilities_size());
+      foreach (const FrameworkInfo::Capability& capability,
+               framework.info().capabilities()) {
+        array.values.push_back(
+              FrameworkInfo::Capability::Type_Name(capability.type()));
+      }
+      object.values["capabilities"] = std::move(array);
+  }
+
+  object.values["hostname"] = framework.info().hostname();
+  object.values["webui_url"] = framework.info().webui_url();
+
+  return object;
+}
+
+
+// Returns a JSON object modeled on an executor of a Framework.
+static JSON::Object model(const StateResponse::Framework::Executor& executor)
+{
+  JSON::Object object = model(executor.info());
+  object.values["slave_id"] = executor.slave_id().value();
+  return object;
+}
+
+
+// Returns a JSON array of the models of the elements.
+template <typename T>
+static JSON::Array array(const google::protobuf::RepeatedPtrField<T>& elements)
+{
+  JSON::Array array;
+  array.values.reserve(elements.size()); // MESOS-2353.
+
+  foreach (const T& element, elements) {
+    array.values.push_back(model(element));
+  }
+
+  return array;
+}
+
+
+// Returns a JSON array of the models of the shared tasks.
+static JSON::Array array(const vector<std::shared_ptr<const Task>>& tasks)
+{
+  JSON::Array array;
+  array.values.reserve(tasks.size()); // MESOS-2353.
+
+  foreach (const std::shared_ptr<const Task>& task, tasks) {
+    array.values.push_back(model(*task));
+  }
+
+  return array;
+}
+
+
+// Returns a JSON object modeled on a Framework, but without its
+// tasks, completed tasks, offers and executors.
+static JSON::Object describe(const StateResponse::Framework& framework)
+{
+  JSON::Object object = summarize(framework);
+
+  // Add additional fields to those generated by 'summarize'.
+  object.values["user"] = framework.info().user();
+  object.values["failover_timeout"] = framework.info().failover_timeout();
+  object.values["checkpoint"] = framework.info().checkpoint();
+  object.values["role"] = framework.info().role();
+  object.values["registered_time"] = framework.registered_time();
+  object.values["unregistered_time"] = framework.unregistered_time();
+  object.values["active"] = framework.active();
+
+  // TODO(bmahler): Consider deprecating this in favor of the split
+  // used and offered resources added in 'summarize'.
+  object.values["resources"] =
+    model(Resources(framework.used_resources()) +
+          Resources(framework.offered_resources()));
+
+  // TODO(benh): Consider making reregisteredTime an Option.
+  if (framework.has_reregistered_time()) {
+    object.values["reregistered_time"] = framework.reregistered_time();
+  }
+
+  return object;
+}
+
+
+// Returns a JSON object modeled on a Framework.
+JSON::Object model(const StateResponse::Framework& framework)
+{
+  JSON::Object object = describe(framework);
+
+  object.values["tasks"] = array(framework.tasks());
+  object.values["completed_tasks"] = array(framework.completed_tasks());
+  object.values["offers"] = array(framework.offers());
+  object.values["executors"] = array(framework.executors());
+
+  return object;
+}
+
+
+// Returns a JSON object modeled on a Framework of a snapshot.
+JSON::Object model(const Snapshot::Framework& record)
+{
+  const StateResponse::Framework& framework = record.framework;
+
+  JSON::Object object = describe(framework);
+
+  object.values["tasks"] = array(record.tasks);
+  object.values["completed_tasks"] = array(record.completedTasks);
+  object.values["offers"] = array(framework.offers());
+  object.values["executors"] = array(framework.executors());
+
+  return object;
+}
+
+
+// Writes the name of a field of a JSON object, preceded by a comma
+// unless it is the first field (in which case 'first' is updated).
+static void field(std::ostream& out, const string& name, bool* first)
+{
+  out << (*first ? "" : ",") << JSON::String(name) << ":";
+  *first = false;
+}
+
+
+// Writes the selected fields of the elements as a JSON array, modeling
+// one element at a time.
+template <typename T>
+static void write(
+    std::ostream& out,
+    const Projection& fields,
+    const google::protobuf::RepeatedPtrField<T>& elements)
+{
+  out << "[";
+
+  bool first = true;
+  foreach (const T& element, elements) {
+    out << (first ? "" : ",") << fields.apply(model(element));
+    first = false;
+  }
+
+  out << "]";
+}
+
+
+// Writes the selected fields of the shared tasks as a JSON array,
+// modeling only the selected fields of one task at a time.
+static void write(
+    std::ostream& out,
+    const Projection& fields,
+    const vector<std::shared_ptr<const Task>>& tasks)
+{
+  out << "[";
+
+  bool first = true;
+  foreach (const std::shared_ptr<const Task>& task, tasks) {
+    out << (first ? "" : ",") << model(*task, fields);
+    first = false;
+  }
+
+  out << "]";
+}
+
+
+// Writes the selected fields of the JSON object modeled on a
+// Framework (see 'model()'). Rather than modeling the whole framework,
+// its tasks, offers and executors are modeled and written one at a
+// time.
+static void write(
+    std::ostream& out,
+    const Projection& fields,
+    const Snapshot::Framework& record)
+{
+  const StateResponse::Framework& framework = record.framework;
+
+  out << "{";
+
+  bool first = true;
+
+  const JSON::Object object = fields.apply(describe(framework));
+
+  foreachpair (const string& name, const JSON::Value& value, object.values) {
+    field(out, name, &first);
+    out << value;
+  }
+
+  if (fields.includes("tasks")) {
+    field(out, "tasks", &first);
+    write(out, fields.nested("tasks"), record.tasks);
+  }
+
+  if (fields.includes("completed_tasks")) {
+    field(out, "completed_tasks", &first);
+    write(out, fields.nested("completed_tasks"), record.completedTasks);
+  }
+
+  if (fields.includes("offers")) {
+    field(out, "offers", &first);
+    write(out, fields.nested("offers"), framework.offers());
+  }
+
+  if (fields.includes("executors")) {
+    field(out, "executors", &first);
+    write(out, fields.nested("executors"), framework.executors());
+  }
+
+  out << "}";
+}
+
+
+// Returns a JSON object summarizing some important fields in a Slave.
+JSON::Object summarize(const StateResponse::Slave& slave)
+{
+  JSON::Object object;
+  object.values["id"] = slave.info().id().value();
+  object.values["pid"] = slave.pid();
+  object.values["hostname"] = slave.info().hostname();
+  object.values["registered_time"] = slave.registered_time();
+
+  if (slave.has_reregistered_time()) {
+    object.values["reregistered_time"] = slave.reregistered_time();
+  }
+
+  const Resources totalResources = slave.resources();
+  object.values["resources"] = model(totalResources);
+  object.values["used_resources"] = model(Resources(slave.used_resources()));
+  object.values["offered_resources"] =
+    model(Resources(slave.offered_resources()));
+  object.values["reserved_resources"] = model(totalResources.reserved());
+  object.values["unreserved_resources"] = model(totalResources.unreserved());
+
+  object.values["attributes"] = model(Attributes(slave.info().attributes()));
+  object.values["active"] = slave.active();
+  return object;
+}
+
+
+// Returns a JSON object modeled after a Slave.
+// For now there are no additional fields being added to those
+// generated by 'summarize'.
+JSON::Object model(const StateResponse::Slave& slave)
+{
+  return summarize(slave);
+}
+
+
+// Returns an OK response with the serialized message as its body.
+static OK serialize(const google::protobuf::Message& message)
+{
+  OK ok(message.SerializeAsString());
+  ok.headers["Content-Type"] = APPLICATION_PROTOBUF;
+  return ok;
+}
+
+
+// Clears the top-level fields of the message that are not selected.
+// NOTE: Only top-level fields are projected for protobuf responses,
+// nested fields are always included.
+static void project(
+    const Projection& fields,
+    google::protobuf::Message* message)
+{
+  const google::protobuf::Descriptor* descriptor = message->GetDescriptor();
+  const google::protobuf::Reflection* reflection = message->GetReflection();
+
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const google::protobuf::FieldDescriptor* field = descriptor->field(i);
+    if (!fields.includes(field->name())) {
+      reflection->ClearField(message, field);
+    }
+  }
+}
+
+
+// Copies the selected fields of the task, named as in its JSON model
+// (e.g., 'id' selects 'task_id'). The required fields are always
+// copied so that the message can be parsed, and nested fields are
+// not projected.
+static void project(const Projection& fields, const Task& task, Task* result)
+{
+  result->set_name(task.name());
+  result->mutable_task_id()->CopyFrom(task.task_id());
+  result->mutable_framework_id()->CopyFrom(task.framework_id());
+  result->mutable_slave_id()->CopyFrom(task.slave_id());
+  result->set_state(task.state());
+
+  if (task.has_executor_id() && fields.includes("executor_id")) {
+    result->mutable_executor_id()->CopyFrom(task.executor_id());
+  }
+
+  if (fields.includes("resources")) {
+    result->mutable_resources()->CopyFrom(task.resources());
+  }
+
+  if (fields.includes("statuses")) {
+    result->mutable_statuses()->CopyFrom(task.statuses());
+  }
+
+  // NOTE: Either both or none of these fields are set.
+  if (task.has_status_update_state() &&
+      fields.includes("status_update_state")) {
+    result->set_status_update_state(task.status_update_state());
+    result->set_status_update_uuid(task.status_update_uuid());
+  }
+
+  if (task.has_labels() && fields.includes("labels")) {
+    result->mutable_labels()->CopyFrom(task.labels());
+  }
+
+  if (task.has_discovery() && fields.includes("discovery")) {
+    result->mutable_discovery()->CopyFrom(task.discovery());
+  }
+}
+
+
+ReadReplica::ReadReplica()
+  : ProcessBase(process::ID::generate("read-replica")),
+    responses(MAX_CACHED_RESPONSES) {}
+
+
+void ReadReplica::publish(const std::shared_ptr<const Snapshot>& snapshot)
+{
+  latest = snapshot;
+}
+
+
+Future<Response> ReadReplica::slaves(const Request& request)
+{
+  return cached(request, &ReadReplica::_slaves);
+}
+
+
+Future<Response> ReadReplica::state(const Request& request)
+{
+  return cached(request, &ReadReplica::_state);
+}
+
+
+Future<Response> ReadReplica::stateSummary(const Request& request)
+{
+  return cached(request, &ReadReplica::_stateSummary);
+}
+
+
+Future<Response> ReadReplica::tasks(const Request& request)
+{
+  return cached(request, &ReadReplica::_tasks);
+}
+
+
+// Wraps the JSON body of the response in a call to the JSONP
+// function 'jsonp', see 'OK(const JSON::Value&, jsonp)'.
+static Response pad(const Response& response, const string& jsonp)
+{
+  if (response.status != OK().status) {
+    return response;
+  }
+
+  Response result = response;
+  result.body = jsonp + "(" + response.body + ");";
+  result.headers["Content-Type"] = "text/javascript";
+  result.headers["Content-Length"] = stringify(result.body.size());
+  return result;
+}
+
+
+Response ReadReplica::tee(
+    const Response& response,
+    const std::shared_ptr<Chunks>& chunks)
+{
+  if (response.type != Response::PIPE) {
+    chunks->done = true;
+    return response;
+  }
+
+  CHECK_SOME(response.reader);
+
+  _tee(response.reader.get(), chunks);
+
+  Response result = response;
+  result.reader = None();
+  return result;
+}
+
+
+void ReadReplica::_tee(
+    Pipe::Reader reader,
+    const std::shared_ptr<Chunks>& chunks)
+{
+  reader.read()
+    .onAny(defer(self(), &ReadReplica::__tee, reader, chunks, lambda::_1));
+}
+
+
+void ReadReplica::__tee(
+    Pipe::Reader reader,
+    const std::shared_ptr<Chunks>& chunks,
+    const Future<string>& data)
+{
+  // A requester's pipe along with its suffix, see 'Chunks'.
+  typedef std::pair<Pipe::Writer, string> Writer;
+
+  if (!data.isReady()) {
+    chunks->done = true;
+    chunks->failure = "Failed to read the response: " +
+      (data.isFailed() ? data.failure() : "discarded");
+
+    foreach (Writer& writer, chunks->writers) {
+      writer.first.fail(chunks->failure.get());
+    }
+
+    chunks->writers.clear();
+    return;
+  }
+
+  if (data.get().empty()) {
+    chunks->done = true;
+
+    foreach (Writer& writer, chunks->writers) {
+      writer.first.write(writer.second);
+      writer.first.close();
+    }
+
+    chunks->writers.clear();
+    return;
+  }
+
+  chunks->data.push_back(data.get());
+
+  // Stop writing to the requesters that have gone away.
+  vector<Writer> writers;
+  writers.reserve(chunks->writers.size());
+
+  foreach (Writer& writer, chunks->writers) {
+    if (writer.first.write(data.get())) {
+      writers.push_back(writer);
+    }
+  }
+
+  chunks->writers = std::move(writers);
+
+  _tee(reader, chunks);
+}
+
+
+Response ReadReplica::replay(
+    const Response& response,
+    const std::shared_ptr<Chunks>& chunks,
+    const Option<string>& jsonp)
+{
+  if (response.type != Response::PIPE) {
+    return jsonp.isSome() ? pad(response, jsonp.get()) : response;
+  }
+
+  Pipe pipe;
+  Pipe::Writer writer = pipe.writer();
+
+  Response result = response;
+  result.reader = pipe.reader();
+
+  string suffix;
+
+  if (jsonp.isSome() && response.status == OK().status) {
+    writer.write(jsonp.get() + "(");
+    suffix = ");";
+    result.headers["Content-Type"] = "text/javascript";
+  }
+
+  foreach (const string& data, chunks->data) {
+    writer.write(data);
+  }
+
+  if (chunks->failure.isSome()) {
+    writer.fail(chunks->failure.get());
+  } else if (chunks->done) {
+    writer.write(suffix);
+    writer.close();
+  } else {
+    chunks->writers.push_back(std::make_pair(writer, suffix));
+  }
+
+  return result;
+}
+
+
+Future<Response> ReadReplica::cached(const Request& request, Render render)
+{
+  // NOTE: The master publishes its first snapshot before it forwards
+  // any requests, see 'Master::initialize()'.
+  CHECK(latest);
+
+  const std::shared_ptr<const Snapshot> snapshot = latest;
+
+  // We cache the responses without the JSONP padding since the
+  // function name is usually different for every request (e.g., for
+  // the webui) and pad them afterwards.
+  Request request_ = request;
+  const Option<string> jsonp = request_.query.get("jsonp");
+  request_.query.erase("jsonp");
+
+  // Responses are rendered differently depending on the negotiated
+  // content-type, so the key is the content-type followed by the path
+  // and the (sorted) query.
+  const ContentType contentType = negotiate(request);
+
+  string key = contentType == ContentType::PROTOBUF
+    ? APPLICATION_PROTOBUF
+    : APPLICATION_JSON;
+
+  key += " " + request_.path;
+
+  const map<string, string> query(
+      request_.query.begin(),
+      request_.query.end());
+
+  foreachpair (const string& name, const string& value, query) {
+    key += "&" + name + "=" + value;
+  }
+
+  Option<CachedResponse> cached = responses.get(key);
+
+  if (cached.isNone() ||
+      cached.get().version != snapshot->version ||
+      cached.get().response.isFailed() ||
+      cached.get().response.isDiscarded() ||
+      cached.get().chunks->failure.isSome()) {
+    CachedResponse entry;
+    entry.version = snapshot->version;
+    entry.chunks.reset(new Chunks());
+    entry.response = (this->*render)(snapshot, request_)
+      .then(defer(self(),
+                  &ReadReplica::tee,
+                  lambda::_1,
+                  entry.chunks));
+
+    responses.put(key, entry);
+
+    cached = entry;
+  }
+
+  return cached.get().response
+    .then(defer(self(),
+                &ReadReplica::replay,
+                lambda::_1,
+                cached.get().chunks,
+                contentType == ContentType::JSON ? jsonp : None()));
+}
+
+
+const string ReadReplica::SLAVES_HELP = HELP(
+    TLDR(
+        "Information about registered slaves."),
+    USAGE(
+        "/master/slaves"),
+    DESCRIPTION(
+        "This endpoint shows information about the slaves registered in",
+        "this master formatted as a JSON object, or as a serialized",
+        "'mesos.internal.SlavesResponse' message if the request accepts",
+        "'application/x-protobuf'."));
+
+
+Future<Response> ReadReplica::_slaves(
+    const std::shared_ptr<const Snapshot>& snapshot,
+    const Request& request)
+{
+  if (negotiate(request) == ContentType::PROTOBUF) {
+    SlavesResponse message;
+
+    foreach (const SlaveRecord& slave, snapshot->slaves) {
+      message.add_slaves()->CopyFrom(*slave);
+    }
+
+    return serialize(message);
+  }
+
+  JSON::Object object;
+
+  {
+    JSON::Array array;
+    array.values.reserve(snapshot->slaves.size()); // MESOS-2353.
+
+    foreach (const SlaveRecord& slave, snapshot->slaves) {
+      array.values.push_back(model(*slave));
+    }
+
+    object.values["slaves"] = std::move(array);
+  }
+
+
+  return OK(object, request.query.get("jsonp"));
+}
+
+
+const string ReadReplica::STATE_HELP = HELP(
+    TLDR(
+        "Information about state of master."),
+    USAGE(
+        "/master/state"),
+    DESCRIPTION(
+        "This endpoint shows information about the frameworks, tasks,",
+        "executors and slaves running in the cluster as a JSON object, or",
+        "as a serialized 'mesos.internal.StateResponse' message if the",
+        "request accepts 'application/x-protobuf'.",
+        "",
+        "Query parameters:",
+        "",
+        ">        framework_id=VALUE   Only include this framework.",
+        ">        role=VALUE           Only include frameworks of this role.",
+        ">        slave_id=VALUE       Only include this slave.",
+        ">        fields=VALUE         Comma separated list of the fields to",
+        ">                             include, nested fields are separated",
+        ">                             by dots (e.g., 'slaves.hostname').",
+        ">                             Only top-level fields are selected",
+        ">                             in protobuf responses."));
+
+
+// The state of streaming /master/state.json, see '_state()'.
+struct ReadReplica::StateStream
+{
+  // The arrays of the state that are streamed, in order.
+  enum Section
+  {
+    SLAVES,
+    FRAMEWORKS,
+    COMPLETED_FRAMEWORKS,
+    ORPHAN_TASKS,
+    UNREGISTERED_FRAMEWORKS,
+    DONE
+  };
+
+  StateStream(
+      const std::shared_ptr<const Snapshot>& _snapshot,
+      const Pipe::Writer& _writer,
+      ContentType _contentType)
+    : snapshot(_snapshot),
+      writer(_writer),
+      contentType(_contentType),
+      section(SLAVES),
+      index(0),
+      first(true),
+      empty(true) {}
+
+  const std::shared_ptr<const Snapshot> snapshot;
+
+  Pipe::Writer writer;
+
+  // For protobuf the stream is a sequence of serialized partial
+  // 'StateResponse' messages, which merge into one when parsed.
+  ContentType contentType;
+
+  Projection fields;
+
+  // Filters of the slaves and frameworks.
+  Option<string> slaveId;
+  Option<string> frameworkId;
+  Option<string> role;
+
+  // The array being streamed, and the index of its next element.
+  Section section;
+  size_t index;
+
+  // Whether no field of the state has been written yet.
+  bool first;
+
+  // Whether no element of the current array has been written yet.
+  bool empty;
+};
+
+
+// Returns true if the framework passes the 'framework_id' and 'role'
+// filters of the request.
+static bool matches(
+    const StateResponse::Framework& framework,
+    const Option<string>& frameworkId,
+    const Option<string>& role)
+{
+  return (frameworkId.isNone() ||
+          framework.info().id().value() == frameworkId.get()) &&
+    (role.isNone() || framework.info().role() == role.get());
+}
+
+
+Future<Response> ReadReplica::_state(
+    const std::shared_ptr<const Snapshot>& snapshot,
+    const Request& request)
+{
+  // Rather than modeling the entire state as a single JSON object
+  // before serializing it, which for large clusters takes seconds and
+  // a lot of memory, we stream the state into a pipe. The slaves,
+  // frameworks and tasks are written one at a time, and we yield
+  // after each batch of them (see '__state()') so that other requests
+  // can be served in between. Fields that are not selected are not
+  // modeled at all.
+  // NOTE: There is no JSONP padding to take care of here, the
+  // responses are padded after they are cached, see 'cached()'.
+  Pipe pipe;
+
+  std::shared_ptr<StateStream> stream(
+      new StateStream(snapshot, pipe.writer(), negotiate(request)));
+
+  if (request.query.contains("fields")) {
+    stream->fields = Projection(request.query.get("fields").get());
+  }
+
+  stream->slaveId = request.query.get("slave_id");
+  stream->frameworkId = request.query.get("framework_id");
+  stream->role = request.query.get("role");
+
+  const Projection& fields = stream->fields;
+
+  const StateResponse& header = snapshot->master;
+
+  if (stream->contentType == ContentType::PROTOBUF) {
+    StateResponse state = header;
+
+    project(fields, &state);
+
+    stream->writer.write(state.SerializeAsString());
+
+    dispatch(self(), &ReadReplica::__state, stream);
+
+    OK ok;
+    ok.type = Response::PIPE;
+    ok.reader = pipe.reader();
+    ok.headers["Content-Type"] = APPLICATION_PROTOBUF;
+
+    return ok;
+  }
+
+  JSON::Object object;
+  object.values["version"] = header.version();
+
+  if (header.has_git_sha()) {
+    object.values["git_sha"] = header.git_sha();
+  }
+
+  if (header.has_git_branch()) {
+    object.values["git_branch"] = header.git_branch();
+  }
+
+  if (header.has_git_tag()) {
+    object.values["git_tag"] = header.git_tag();
+  }
+
+  object.values["build_date"] = header.build_date();
+  object.values["build_time"] = header.build_time();
+  object.values["build_user"] = header.build_user();
+  object.values["start_time"] = header.start_time();
+
+  if (header.has_elected_time()) {
+    object.values["elected_time"] = header.elected_time();
+  }
+
+  object.values["id"] = header.id();
+  object.values["pid"] = header.pid();
+  object.values["hostname"] = header.hostname();
+  object.values["activated_slaves"] = header.activated_slaves();
+  object.values["deactivated_slaves"] = header.deactivated_slaves();
+
+  if (header.has_cluster()) {
+    object.values["cluster"] = header.cluster();
+  }
+
+  if (header.has_leader()) {
+    object.values["leader"] = header.leader();
+  }
+
+  if (header.has_log_dir()) {
+    object.values["log_dir"] = header.log_dir();
+  }
+
+  if (header.has_external_log_file()) {
+    object.values["external_log_file"] = header.external_log_file();
+  }
+
+  if (fields.includes("flags")) {
+    JSON::Object flags;
+    foreach (const Parameter& flag, header.flags()) {
+      flags.values[flag.key()] = flag.value();
+    }
+    object.values["flags"] = std::move(flags);
+  }
+
+  std::ostringstream out;
+
+  out << "{";
+
+  const JSON::Object selected = fields.apply(object);
+
+  foreachpair (const string& name, const JSON::Value& value, selected.values) {
+    field(out, name, &stream->first);
+    out << value;
+  }
+
+  stream->writer.write(out.str());
+
+  dispatch(self(), &ReadReplica::__state, stream);
+
+  OK ok;
+  ok.type = Response::PIPE;
+  ok.reader = pipe.reader();
+  ok.headers["Content-Type"] = "application/json";
+
+  return ok;
+}
+
+
+void ReadReplica::__state(const std::shared_ptr<StateStream>& stream)
+{
+  static const char* NAMES[] = {
+    "slaves",
+    "frameworks",
+    "completed_frameworks",
+    "orphan_tasks",
+    "unregistered_frameworks"
+  };
+
+  const Snapshot& snapshot = *stream->snapshot;
+  const Projection& fields = stream->fields;
+
+  const bool json = stream->contentType == ContentType::JSON;
+
+  // The output of this batch, 'state' is only used for protobuf.
+  std::ostringstream out;
+  StateResponse state;
+
+  // The number of records written in this batch, a framework counts
+  // as many records as it has tasks.
+  size_t records = 0;
+
+  while (stream->section != StateStream::DONE &&
+         records < STATE_STREAM_BATCH_SIZE) {
+    const string name = NAMES[stream->section];
+
+    size_t size = 0;
+    switch (stream->section) {
+      case StateStream::SLAVES:
+        size = snapshot.slaves.size();
+        break;
+      case StateStream::FRAMEWORKS:
+        size = snapshot.frameworks.size();
+        break;
+      case StateStream::COMPLETED_FRAMEWORKS:
+        size = snapshot.completedFrameworks.size();
+        break;
+      case StateStream::ORPHAN_TASKS:
+        size = snapshot.orphanTasks.size();
+        break;
+      case StateStream::UNREGISTERED_FRAMEWORKS:
+        size = snapshot.unregisteredFrameworks.size();
+        break;
+      case StateStream::DONE:
+        break;
+    }
+
+    if (!fields.includes(name) || stream->index == size) {
+      if (json && fields.includes(name)) {
+        if (stream->index == 0) {
+          field(out, name, &stream->first);
+          out << "[";
+        }
+        out << "]";
+      }
+
+      stream->section = StateStream::Section(stream->section + 1);
+      stream->index = 0;
+      stream->empty = true;
+      continue;
+    }
+
+    if (json && stream->index == 0) {
+      field(out, name, &stream->first);
+      out << "[";
+    }
+
+    const size_t index = stream->index++;
+    const Projection nested = fields.nested(name);
+
+    switch (stream->section) {
+      case StateStream::SLAVES: {
+        const StateResponse::Slave& slave = *snapshot.slaves[index];
+
+        if (stream->slaveId.isSome() &&
+            slave.info().id().value() != stream->slaveId.get()) {
+          continue;
+        }
+
+        if (json) {
+          out << (stream->empty ? "" : ",") << nested.apply(model(slave));
+        } else {
+          state.add_slaves()->CopyFrom(slave);
+        }
+
+        records++;
+        break;
+      }
+
+      case StateStream::FRAMEWORKS:
+      case StateStream::COMPLETED_FRAMEWORKS: {
+        const Snapshot::Framework& record =
+          stream->section == StateStream::FRAMEWORKS
+            ? *snapshot.frameworks[index]
+            : *snapshot.completedFrameworks[index];
+
+        if (!matches(record.framework, stream->frameworkId, stream->role)) {
+          continue;
+        }
+
+        if (json) {
+          out << (stream->empty ? "" : ",");
+          write(out, nested, record);
+        } else {
+          StateResponse::Framework* framework =
+            stream->section == StateStream::FRAMEWORKS
+              ? state.add_frameworks()
+              : state.add_completed_frameworks();
+
+          framework->CopyFrom(record.framework);
+
+          foreach (const std::shared_ptr<const Task>& task, record.tasks) {
+            framework->add_tasks()->CopyFrom(*task);
+          }
+
+          foreach (const std::shared_ptr<const Task>& task,
+                   record.completedTasks) {
+            framework->add_completed_tasks()->CopyFrom(*task);
+          }
+        }
+
+        records += 1 + record.tasks.size() + record.completedTasks.size();
+        break;
+      }
+
+      case StateStream::ORPHAN_TASKS: {
+        const Task& task = *snapshot.orphanTasks[index];
+
+        if (json) {
+          out << (stream->empty ? "" : ",") << model(task, nested);
+        } else {
+          state.add_orphan_tasks()->CopyFrom(task);
+        }
+
+        records++;
+        break;
+      }
+
+      case StateStream::UNREGISTERED_FRAMEWORKS: {
+        const FrameworkID& frameworkId =
+          snapshot.unregisteredFrameworks[index];
+
+        if (json) {
+          out << (stream->empty ? "" : ",")
+              << JSON::String(frameworkId.value());
+        } else {
+          state.add_unregistered_frameworks()->CopyFrom(frameworkId);
+        }
+
+        records++;
+        break;
+      }
+
+      case StateStream::DONE:
+        break;
+    }
+
+    stream->empty = false;
+  }
+
+  if (json && stream->section == StateStream::DONE) {
+    out << "}";
+  }
+
+  // NOTE: Empty writes are ignored by the pipe.
+  if (!stream->writer.write(json ? out.str() : state.SerializeAsString())) {
+    // The reader has gone away, no need to continue.
+    return;
+  }
+
+  if (stream->section == StateStream::DONE) {
+    stream->writer.close();
+    return;
+  }
+
+  // Yield before writing the next batch.
+  dispatch(self(), &ReadReplica::__state, stream);
+}
+
+
+// This abstraction has no side-effects. It factors out computing the
+// mapping from 'slaves' to 'frameworks' to answer the questions 'what
+// frameworks are running on a given slave?' and 'what slaves are
+// running the given framework?'.
+class SlaveFrameworkMapping
+{
+public:
+  SlaveFrameworkMapping(const vector<FrameworkRecord>& frameworks)
+  {
+    foreach (const FrameworkRecord& framework, frameworks) {
+      const FrameworkID& frameworkId = framework->framework.info().id();
+
+      foreach (const std::shared_ptr<const Task>& task, framework->tasks) {
+        frameworksToSlaves[frameworkId].insert(task->slave_id());
+        slavesToFrameworks[task->slave_id()].insert(frameworkId);
+      }
+
+      foreach (const std::shared_ptr<const Task>& task,
+               framework->completedTasks) {
+        frameworksToSlaves[frameworkId].insert(task->slave_id());
+        slavesToFrameworks[task->slave_id()].insert(frameworkId);
+      }
+    }
+  }
+
+  const hashset<FrameworkID>& frameworks(const SlaveID& slaveId) const
+  {
+    const auto iterator = slavesToFrameworks.find(slaveId);
+    return iterator != slavesToFrameworks.end() ?
+      iterator->second : hashset<FrameworkID>::EMPTY;
+  }
+
+  const hashset<SlaveID>& slaves(const FrameworkID& frameworkId) const
+  {
+    const auto iterator = frameworksToSlaves.find(frameworkId);
+    return iterator != frameworksToSlaves.end() ?
+      iterator->second : hashset<SlaveID>::EMPTY;
+  }
+
+private:
+  hashmap<SlaveID, hashset<FrameworkID>> slavesToFrameworks;
+  hashmap<FrameworkID, hashset<SlaveID>> frameworksToSlaves;
+};
+
+
+// This abstraction has no side-effects. It factors out the accounting
+// for a 'TaskState' summary. We use this to summarize 'TaskState's
+// for both frameworks as well as slaves.
+struct TaskStateSummary
+{
+  // TODO(jmlvanre): Possibly clean this up as per MESOS-2694.
+  const static TaskStateSummary EMPTY;
+
+  TaskStateSummary()
+    : staging(0),
+      starting(0),
+      running(0),
+      finished(0),
+      killed(0),
+      failed(0),
+      lost(0),
+      error(0) {}
+
+  // Account for the state of the given task.
+  void count(const Task& task)
+  {
+    switch (task.state()) {
+      case TASK_STAGING: { ++staging; break; }
+      case TASK_STARTING: { ++starting; break; }
+      case TASK_RUNNING: { ++running; break; }
+      case TASK_FINISHED: { ++finished; break; }
+      case TASK_KILLED: { ++killed; break; }
+      case TASK_FAILED: { ++failed; break; }
+      case TASK_LOST: { ++lost; break; }
+      case TASK_ERROR: { ++error; break; }
+      // No default case allows for a helpful compiler error if we
+      // introduce a new state.
+    }
+  }
+
+  size_t staging;
+  size_t starting;
+  size_t running;
+  size_t finished;
+  size_t killed;
+  size_t failed;
+  size_t lost;
+  size_t error;
+};
+
+
+const TaskStateSummary TaskStateSummary::EMPTY;
+
+
+// This abstraction has no side-effects. It factors out computing the
+// 'TaskState' summaries for frameworks and slaves. This answers the
+// questions 'How many tasks are in each state for a given framework?'
+// and 'How many tasks are in each state for a given slave?'.
+class TaskStateSummaries
+{
+public:
+  TaskStateSummaries(const vector<FrameworkRecord>& frameworks)
+  {
+    foreach (const FrameworkRecord& framework, frameworks) {
+      const FrameworkID& frameworkId = framework->framework.info().id();
+
+      // NOTE: The pending tasks are included as staging.
+      foreach (const std::shared_ptr<const Task>& task, framework->tasks) {
+        frameworkTaskSummaries[frameworkId].count(*task);
+        slaveTaskSummaries[task->slave_id()].count(*task);
+      }
+
+      foreach (const std::shared_ptr<const Task>& task,
+               framework->completedTasks) {
+        frameworkTaskSummaries[frameworkId].count(*task);
+        slaveTaskSummaries[task->slave_id()].count(*task);
+      }
+    }
+  }
+
+  const TaskStateSummary& framework(const FrameworkID& frameworkId) const
+  {
+    const auto iterator = frameworkTaskSummaries.find(frameworkId);
+    return iterator != frameworkTaskSummaries.end() ?
+      iterator->second : TaskStateSummary::EMPTY;
+  }
+
+  const TaskStateSummary& slave(const SlaveID& slaveId) const
+  {
+    const auto iterator = slaveTaskSummaries.find(slaveId);
+    return iterator != slaveTaskSummaries.end() ?
+      iterator->second : TaskStateSummary::EMPTY;
+  }
+private:
+  hashmap<FrameworkID, TaskStateSummary> frameworkTaskSummaries;
+  hashmap<SlaveID, TaskStateSummary> slaveTaskSummaries;
+};
+
+
+const string ReadReplica::STATESUMMARY_HELP = HELP(
+    TLDR(
+        "Summary of state of all tasks and registered frameworks in cluster."),
+    USAGE(
+        "/master/state-summary"),
+    DESCRIPTION(
+        "This endpoint gives a summary of the state of all tasks and",
+        "registered frameworks in the cluster as a JSON object."));
+
+
+Future<Response> ReadReplica::_stateSummary(
+    const std::shared_ptr<const Snapshot>& snapshot,
+    const Request& request)
+{
+  JSON::Object object;
+
+  object.values["hostname"] = snapshot->master.hostname();
+
+  if (snapshot->master.has_cluster()) {
+    object.values["cluster"] = snapshot->master.cluster();
+  }
+
+  // We use the tasks in the 'Frameworks' struct to compute summaries
+  // for this endpoint. This is done 1) for consistency between the
+  // 'slaves' and 'frameworks' subsections below 2) because we want to
+  // provide summary information for frameworks that are currently
+  // registered 3) the frameworks keep a circular buffer of completed
+  // tasks that we can use to keep a limited view on the history of
+  // recent completed / failed tasks.
+
+  // Generate mappings from 'slave' to 'framework' and reverse.
+  SlaveFrameworkMapping slaveFrameworkMapping(snapshot->frameworks);
+
+  // Generate 'TaskState' summaries for all framework and slave ids.
+  TaskStateSummaries taskStateSummaries(snapshot->frameworks);
+
+  // Model all of the slaves.
+  {
+    JSON::Array array;
+    array.values.reserve(snapshot->slaves.size()); // MESOS-2353.
+
+    foreach (const SlaveRecord& record, snapshot->slaves) {
+      const StateResponse::Slave& slave = *record;
+
+      JSON::Object json = summarize(slave);
+
+      // Add the 'TaskState' summary for this slave.
+      const TaskStateSummary& summary =
+        taskStateSummaries.slave(slave.info().id());
+
+      json.values["TASK_STAGING"] = summary.staging;
+      json.values["TASK_STARTING"] = summary.starting;
+      json.values["TASK_RUNNING"] = summary.running;
+      json.values["TASK_FINISHED"] = summary.finished;
+      json.values["TASK_KILLED"] = summary.killed;
+      json.values["TASK_FAILED"] = summary.failed;
+      json.values["TASK_LOST"] = summary.lost;
+      json.values["TASK_ERROR"] = summary.error;
+
+      // Add the ids of all the frameworks running on this slave.
+      const hashset<FrameworkID>& frameworks =
+        slaveFrameworkMapping.frameworks(slave.info().id());
+
+      JSON::Array frameworkIdArray;
+      frameworkIdArray.values.reserve(frameworks.size()); // MESOS-2353.
+
+      foreach (const FrameworkID& frameworkId, frameworks) {
+        frameworkIdArray.values.push_back(frameworkId.value());
+      }
+
+      json.values["framework_ids"] = std::move(frameworkIdArray);
+
+      array.values.push_back(std::move(json));
+    }
+
+    object.values["slaves"] = std::move(array);
+  }
+
+  // Model all of the frameworks.
+  {
+    JSON::Array array;
+    array.values.reserve(snapshot->frameworks.size()); // MESOS-2353.
+
+    foreach (const FrameworkRecord& record, snapshot->frameworks) {
+      const StateResponse::Framework& framework = record->framework;
+
+      JSON::Object json = summarize(framework);
+
+      // Add the 'TaskState' summary for this framework.
+      const TaskStateSummary& summary =
+        taskStateSummaries.framework(framework.info().id());
+      json.values["TASK_STAGING"] = summary.staging;
+      json.values["TASK_STARTING"] = summary.starting;
+      json.values["TASK_RUNNING"] = summary.running;
+      json.values["TASK_FINISHED"] = summary.finished;
+      json.values["TASK_KILLED"] = summary.killed;
+      json.values["TASK_FAILED"] = summary.failed;
+      json.values["TASK_LOST"] = summary.lost;
+      json.values["TASK_ERROR"] = summary.error;
+
+      // Add the ids of all the slaves running this framework.
+      const hashset<SlaveID>& slaves =
+        slaveFrameworkMapping.slaves(framework.info().id());
+
+      JSON::Array slaveIdArray;
+      slaveIdArray.values.reserve(slaves.size()); // MESOS-2353.
+
+      foreach (const SlaveID& slaveId, slaves) {
+        slaveIdArray.values.push_back(slaveId.value());
+      }
+
+      json.values["slave_ids"] = std::move(slaveIdArray);
+
+      array.values.push_back(std::move(json));
+    }
+
+    object.values["frameworks"] = std::move(array);
+  }
+
+  return OK(object, request.query.get("jsonp"));
+}
+
+
+const string ReadReplica::TASKS_HELP = HELP(
+    TLDR(
+      "Lists tasks from all active frameworks."),
+    USAGE(
+      "/master/tasks.json"),
+    DESCRIPTION(
+      "Lists known tasks, as a serialized 'mesos.internal.TasksResponse'",
+      "message if the request accepts 'application/x-protobuf'.",
+      "",
+      "Query parameters:",
+      "",
+      ">        limit=VALUE          Maximum number of tasks returned "
+      "(default is " + stringify(TASK_LIMIT) + ").",
+      ">        offset=VALUE         Starts task list at offset.",
+      ">        order=(asc|desc)     Ascending or descending sort order "
+      "(default is descending).",
+      ">        framework_id=VALUE   Only lists tasks of this framework.",
+      ">        role=VALUE           Only lists tasks of frameworks of this "
+      "role.",
+      ">        slave_id=VALUE       Only lists tasks on this slave.",
+      ">        state=VALUE          Only lists tasks in this state "
+      "(e.g., TASK_RUNNING).",
+      ">        fields=VALUE         Comma separated list of the fields of "
+      "the tasks to include (e.g., 'id,state,slave_id'). Protobuf "
+      "responses always include the required fields of the tasks, and "
+      "do not project nested fields."
+      ""));
+
+
+struct TaskComparator
+{
+  static bool ascending(const Task* lhs, const Task* rhs)
+  {
+    size_t lhsSize = lhs->statuses().size();
+    size_t rhsSize = rhs->statuses().size();
+
+    if ((lhsSize == 0) && (rhsSize == 0)) {
+      return false;
+    }
+
+    if (lhsSize == 0) {
+      return true;
+    }
+
+    if (rhsSize == 0) {
+      return false;
+    }
+
+    return (lhs->statuses(0).timestamp() < rhs->statuses(0).timestamp());
+  }
+
+  static bool descending(const Task* lhs, const Task* rhs)
+  {
+    size_t lhsSize = lhs->statuses().size();
+    size_t rhsSize = rhs->statuses().size();
+
+    if ((lhsSize == 0) && (rhsSize == 0)) {
+      return false;
+    }
+
+    if (rhsSize == 0) {
+      return true;
+    }
+
+    if (lhsSize == 0) {
+      return false;
+    }
+
+    return (lhs->statuses(0).timestamp() > rhs->statuses(0).timestamp());
+  }
+};
+
+
+Future<Response> ReadReplica::_tasks(
+    const std::shared_ptr<const Snapshot>& snapshot,
+    const Request& request)
+{
+  // Get list options (limit and offset).
+  Result<int> result = numify<int>(request.query.get("limit"));
+  size_t limit = result.isSome() ? result.get() : TASK_LIMIT;
+
+  result = numify<int>(request.query.get("offset"));
+  size_t offset = result.isSome() ? result.get() : 0;
+
+  // TODO(nnielsen): Currently, formatting errors in offset and/or limit
+  // will silently be ignored. This could be reported to the user instead.
+
+  // Get the filters.
+  const Option<string> frameworkId = request.query.get("framework_id");
+  const Option<string> role = request.query.get("role");
+  const Option<string> slaveId = request.query.get("slave_id");
+
+  Option<TaskState> taskState;
+  if (request.query.contains("state")) {
+    TaskState state;
+    if (!TaskState_Parse(request.query.get("state").get(), &state)) {
+      return BadRequest(
+          "Invalid task state '" + request.query.get("state").get() + "'");
+    }
+    taskState = state;
+  }
+
+  Projection fields;
+  if (request.query.contains("fields")) {
+    fields = Projection(request.query.get("fields").get());
+  }
+
+  // Construct framework list with both active and completed framwworks.
+  vector<const Snapshot::Framework*> frameworks;
+  foreach (const FrameworkRecord& framework, snapshot->frameworks) {
+    if (matches(framework->framework, frameworkId, role)) {
+      frameworks.push_back(framework.get());
+    }
+  }
+  foreach (const FrameworkRecord& framework, snapshot->completedFrameworks) {
+    if (matches(framework->framework, frameworkId, role)) {
+      frameworks.push_back(framework.get());
+    }
+  }
+
+  // Returns true if the task passes the 'slave_id' and 'state'
+  // filters.
+  auto filter = [&slaveId, &taskState](const Task& task) {
+    return (slaveId.isNone() || task.slave_id().value() == slaveId.get()) &&
+      (taskState.isNone() || task.state() == taskState.get());
+  };
+
+  // Construct task list with both running and finished tasks.
+  vector<const Task*> tasks;
+  foreach (const Snapshot::Framework* framework, frameworks) {
+    foreach (const std::shared_ptr<const Task>& task, framework->tasks) {
+      if (filter(*task)) {
+        tasks.push_back(task.get());
+      }
+    }
+    foreach (const std::shared_ptr<const Task>& task,
+             framework->completedTasks) {
+      if (filter(*task)) {
+        tasks.push_back(task.get());
+      }
+    }
+  }
+
+  // Sort tasks by task status timestamp. Default order is descending.
+  // The earliest timestamp is chosen for comparison when multiple are present.
+  Option<string> order = request.query.get("order");
+  if (order.isSome() && (order.get() == "asc")) {
+    sort(tasks.begin(), tasks.end(), TaskComparator::ascending);
+  } else {
+    sort(tasks.begin(), tasks.end(), TaskComparator::descending);
+  }
+
+  if (negotiate(request) == ContentType::PROTOBUF) {
+    TasksResponse message;
+
+    size_t end = std::min(offset + limit, tasks.size());
+    for (size_t i = offset; i < end; i++) {
+      project(fields, *tasks[i], message.add_tasks());
+    }
+
+    return serialize(message);
+  }
+
+  JSON::Object object;
+
+  {
+    JSON::Array array;
+    size_t end = std::min(offset + limit, tasks.size());
+    for (size_t i = offset; i < end; i++) {
+      array.values.push_back(model(*tasks[i], fields));
+    }
+
+    object.values["tasks"] = std::move(array);
+  }
+
+  return OK(object, request.query.get("jsonp"));
+}
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
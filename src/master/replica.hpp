@@ -0,0 +1,233 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MASTER_REPLICA_HPP__
+#define __MASTER_REPLICA_HPP__
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+
+#include <process/future.hpp>
+#include <process/http.hpp>
+#include <process/process.hpp>
+
+#include <stout/cache.hpp>
+#include <stout/json.hpp>
+#include <stout/option.hpp>
+
+#include "master/http.pb.h"
+
+#include "messages/messages.hpp"
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+// Forward declarations.
+struct Framework;
+
+
+// An immutable snapshot of the master's state, published by the
+// master to the read replica after each batch of changes (see
+// 'Master::publish()'). Snapshots are shared between the requests
+// that are rendered from them and are never modified once published,
+// so they can be read concurrently. The records of the slaves,
+// frameworks and tasks are shared with the snapshots taken before
+// and after as long as they do not change.
+struct Snapshot
+{
+  // The version of the master's state the snapshot was taken at.
+  uint64_t version;
+
+  // The information about the master and its flags, i.e., all of the
+  // fields of '/master/state.json' other than the ones below.
+  StateResponse master;
+
+  // A framework of the snapshot. Its tasks are kept apart from the
+  // rest of the framework so that they can be shared one at a time:
+  // when a framework changes, the tasks that did not change since the
+  // last snapshot are shared rather than expanded again (see
+  // 'TaskRecord::expand()').
+  struct Framework
+  {
+    // The framework without its tasks and completed tasks.
+    StateResponse::Framework framework;
+
+    // NOTE: The pending tasks are included as staging tasks.
+    std::vector<std::shared_ptr<const Task>> tasks;
+    std::vector<std::shared_ptr<const Task>> completedTasks;
+  };
+
+  std::vector<std::shared_ptr<const StateResponse::Slave>> slaves;
+  std::vector<std::shared_ptr<const Framework>> frameworks;
+  std::vector<std::shared_ptr<const Framework>> completedFrameworks;
+  std::vector<std::shared_ptr<const Task>> orphanTasks;
+  std::vector<FrameworkID> unregisteredFrameworks;
+};
+
+
+// Returns a protobuf message modeled on a Framework, without its
+// tasks and completed tasks (see 'Snapshot::Framework').
+StateResponse::Framework convert(const Framework& framework);
+
+
+// Returns a JSON object modeled on a Framework.
+JSON::Object model(const StateResponse::Framework& framework);
+JSON::Object model(const Snapshot::Framework& framework);
+
+
+// Serves the master's read-only endpoints (e.g., '/master/state.json')
+// from the snapshots of the master's state published by the master.
+// The master forwards the requests to the replica, which renders them
+// on its own actor so that polling these endpoints does not compete
+// with the schedulers and slaves for the master's actor.
+class ReadReplica : public process::Process<ReadReplica>
+{
+public:
+  ReadReplica();
+
+  // Replaces the snapshot that the requests are served from.
+  void publish(const std::shared_ptr<const Snapshot>& snapshot);
+
+  // /master/slaves
+  process::Future<process::http::Response> slaves(
+      const process::http::Request& request);
+
+  // /master/state.json
+  process::Future<process::http::Response> state(
+      const process::http::Request& request);
+
+  // /master/state-summary
+  process::Future<process::http::Response> stateSummary(
+      const process::http::Request& request);
+
+  // /master/tasks.json
+  process::Future<process::http::Response> tasks(
+      const process::http::Request& request);
+
+  const static std::string SLAVES_HELP;
+  const static std::string STATE_HELP;
+  const static std::string STATESUMMARY_HELP;
+  const static std::string TASKS_HELP;
+
+private:
+  typedef process::Future<process::http::Response> (ReadReplica::*Render)(
+      const std::shared_ptr<const Snapshot>& snapshot,
+      const process::http::Request& request);
+
+  // Returns the response rendered by 'render' from the latest
+  // snapshot. Responses are cached until a newer snapshot is
+  // published, and concurrent requests share the response being
+  // rendered.
+  process::Future<process::http::Response> cached(
+      const process::http::Request& request,
+      Render render);
+
+  // Renderers of the endpoints.
+  process::Future<process::http::Response> _slaves(
+      const std::shared_ptr<const Snapshot>& snapshot,
+      const process::http::Request& request);
+
+  process::Future<process::http::Response> _state(
+      const std::shared_ptr<const Snapshot>& snapshot,
+      const process::http::Request& request);
+
+  process::Future<process::http::Response> _stateSummary(
+      const std::shared_ptr<const Snapshot>& snapshot,
+      const process::http::Request& request);
+
+  process::Future<process::http::Response> _tasks(
+      const std::shared_ptr<const Snapshot>& snapshot,
+      const process::http::Request& request);
+
+  // Streams the next batch of slaves, frameworks and tasks of
+  // /master/state.json, see '_state()'.
+  struct StateStream;
+  void __state(const std::shared_ptr<StateStream>& stream);
+
+  // The chunks of a cached streamed (i.e., PIPE) response, which are
+  // read once from the rendered response and replayed to every
+  // requester, including the ones that arrive while it is streamed.
+  struct Chunks
+  {
+    Chunks() : done(false) {}
+
+    std::vector<std::string> data;
+
+    // The requesters that are still being streamed to, along with
+    // the suffix to write before closing their pipe (e.g., to close
+    // the JSONP padding).
+    std::vector<std::pair<process::http::Pipe::Writer, std::string>>
+      writers;
+
+    // Whether all of the chunks were read (or the read failed).
+    bool done;
+    Option<std::string> failure;
+  };
+
+  // Starts reading the chunks of a rendered PIPE response into
+  // 'chunks' and returns the response without its reader.
+  process::http::Response tee(
+      const process::http::Response& response,
+      const std::shared_ptr<Chunks>& chunks);
+
+  void _tee(
+      process::http::Pipe::Reader reader,
+      const std::shared_ptr<Chunks>& chunks);
+
+  void __tee(
+      process::http::Pipe::Reader reader,
+      const std::shared_ptr<Chunks>& chunks,
+      const process::Future<std::string>& data);
+
+  // Returns the cached response for one requester, padded for JSONP
+  // if 'jsonp' is set. A PIPE response gets a new pipe into which the
+  // chunks read so far are written, followed by the remaining ones as
+  // they are read.
+  process::http::Response replay(
+      const process::http::Response& response,
+      const std::shared_ptr<Chunks>& chunks,
+      const Option<std::string>& jsonp);
+
+  // The latest snapshot published by the master.
+  std::shared_ptr<const Snapshot> latest;
+
+  struct CachedResponse
+  {
+    uint64_t version; // Version of the snapshot that was rendered.
+
+    // The response without its body if it is streamed, in which case
+    // the body is cached in 'chunks'.
+    process::Future<process::http::Response> response;
+    std::shared_ptr<Chunks> chunks;
+  };
+
+  Cache<std::string, CachedResponse> responses;
+};
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_REPLICA_HPP__
@@ -0,0 +1,353 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+
+#include <mesos/resources.hpp>
+#include <mesos/type_utils.hpp>
+
+#include <process/clock.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/option.hpp>
+
+#include "common/build.hpp"
+#include "common/protobuf_utils.hpp"
+
+#include "master/master.hpp"
+#include "master/replica.hpp"
+
+using process::Clock;
+
+using std::string;
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+// Returns a protobuf message modeled on a Framework, without its
+// tasks and completed tasks.
+StateResponse::Framework convert(const Framework& framework)
+{
+  StateResponse::Framework message;
+  message.mutable_info()->CopyFrom(framework.info);
+
+  // Omit pid for http frameworks.
+  if (framework.pid.isSome()) {
+    message.set_pid(framework.pid.get());
+  }
+
+  message.set_active(framework.active);
+  message.set_registered_time(framework.registeredTime.secs());
+  message.set_unregistered_time(framework.unregisteredTime.secs());
+
+  if (framework.registeredTime != framework.reregisteredTime) {
+    message.set_reregistered_time(framework.reregisteredTime.secs());
+  }
+
+  message.mutable_used_resources()->CopyFrom(framework.totalUsedResources);
+  message.mutable_offered_resources()->CopyFrom(
+      framework.totalOfferedResources);
+
+  foreach (Offer* offer, framework.offers) {
+    message.add_offers()->CopyFrom(*offer);
+  }
+
+  foreachpair (const SlaveID& slaveId,
+               const auto& executorsMap,
+               framework.executors) {
+    foreachvalue (const ExecutorInfo& executor, executorsMap) {
+      StateResponse::Framework::Executor* executor_ = message.add_executors();
+      executor_->mutable_info()->CopyFrom(executor);
+      executor_->mutable_slave_id()->CopyFrom(slaveId);
+    }
+  }
+
+  return message;
+}
+
+
+// Returns a protobuf message modeled on a Slave.
+StateResponse::Slave convert(const Slave& slave)
+{
+  StateResponse::Slave message;
+  message.mutable_info()->CopyFrom(slave.info);
+  message.mutable_info()->mutable_id()->CopyFrom(slave.id);
+  message.set_pid(slave.pid);
+  message.set_registered_time(slave.registeredTime.secs());
+
+  if (slave.reregisteredTime.isSome()) {
+    message.set_reregistered_time(slave.reregisteredTime.get().secs());
+  }
+
+  message.mutable_resources()->CopyFrom(slave.totalResources);
+  message.mutable_used_resources()->CopyFrom(
+      Resources::sum(slave.usedResources));
+  message.mutable_offered_resources()->CopyFrom(slave.offeredResources);
+  message.set_active(slave.active);
+
+  return message;
+}
+
+
+// Returns the record of a Framework for a snapshot, which shares the
+// expanded tasks with the earlier snapshots (see 'Snapshot::Framework').
+static Snapshot::Framework expand(const Framework& framework)
+{
+  Snapshot::Framework record;
+  record.framework = convert(framework);
+
+  record.tasks.reserve(
+      framework.pendingTasks.size() + framework.tasks.size());
+
+  foreachvalue (const TaskInfo& task, framework.pendingTasks) {
+    record.tasks.push_back(std::shared_ptr<const Task>(
+        new Task(protobuf::createTask(task, TASK_STAGING, framework.id()))));
+  }
+
+  foreachvalue (const TaskRecord* task, framework.tasks) {
+    record.tasks.push_back(task->expand());
+  }
+
+  record.completedTasks.reserve(framework.completedTasks.size());
+
+  foreach (const std::shared_ptr<TaskRecord>& task, framework.completedTasks) {
+    record.completedTasks.push_back(task->expand());
+  }
+
+  return record;
+}
+
+
+void Master::changed()
+{
+  ++version;
+
+  if (!publishing) {
+    publishing = true;
+    dispatch(self(), &Master::_publish);
+  }
+}
+
+
+void Master::changed(const FrameworkID& frameworkId)
+{
+  changed();
+  records.frameworks.erase(frameworkId);
+}
+
+
+void Master::changed(const SlaveID& slaveId)
+{
+  changed();
+  records.slaves.erase(slaveId);
+}
+
+
+void Master::publish()
+{
+  if (published && published->version == version) {
+    return;
+  }
+
+  const Duration age = Clock::now() - publishedTime;
+
+  if (age < flags.max_state_staleness) {
+    if (!publishing) {
+      publishing = true;
+      delay(flags.max_state_staleness - age, self(), &Master::_publish);
+    }
+    return;
+  }
+
+  publishedTime = Clock::now();
+
+  dispatch(replica->self(), &ReadReplica::publish, snapshot());
+}
+
+
+void Master::_publish()
+{
+  publishing = false;
+  publish();
+}
+
+
+std::shared_ptr<const Snapshot> Master::snapshot()
+{
+  // Snapshots are immutable, so as long as the state has not changed
+  // the last one is shared.
+  if (published && published->version == version) {
+    return published;
+  }
+
+  std::shared_ptr<Snapshot> snapshot(new Snapshot());
+  snapshot->version = version;
+
+  StateResponse& state = snapshot->master;
+  state.set_version(MESOS_VERSION);
+
+  if (build::GIT_SHA.isSome()) {
+    state.set_git_sha(build::GIT_SHA.get());
+  }
+
+  if (build::GIT_BRANCH.isSome()) {
+    state.set_git_branch(build::GIT_BRANCH.get());
+  }
+
+  if (build::GIT_TAG.isSome()) {
+    state.set_git_tag(build::GIT_TAG.get());
+  }
+
+  state.set_build_date(build::DATE);
+  state.set_build_time(build::TIME);
+  state.set_build_user(build::USER);
+  state.set_start_time(startTime.secs());
+
+  if (electedTime.isSome()) {
+    state.set_elected_time(electedTime.get().secs());
+  }
+
+  state.set_id(info().id());
+  state.set_pid(self());
+  state.set_hostname(info().hostname());
+  state.set_activated_slaves(_slaves_active());
+  state.set_deactivated_slaves(_slaves_inactive());
+
+  if (flags.cluster.isSome()) {
+    state.set_cluster(flags.cluster.get());
+  }
+
+  if (leader.isSome()) {
+    state.set_leader(leader.get().pid());
+  }
+
+  if (flags.log_dir.isSome()) {
+    state.set_log_dir(flags.log_dir.get());
+  }
+
+  if (flags.external_log_file.isSome()) {
+    state.set_external_log_file(flags.external_log_file.get());
+  }
+
+  foreachpair (const string& name, const flags::Flag& flag, flags) {
+    Option<string> value = flag.stringify(flags);
+    if (value.isSome()) {
+      Parameter* parameter = state.add_flags();
+      parameter->set_key(name);
+      parameter->set_value(value.get());
+    }
+  }
+
+  // Rather than converting all of the slaves and frameworks, which
+  // for large clusters means copying every task on the master's
+  // actor, we share the records of the ones that have not changed
+  // since the last snapshot (see 'changed()') and only convert the
+  // others. The records of the removed ones are dropped. The tasks
+  // of the changed frameworks are shared one at a time, so only the
+  // tasks that changed are expanded again (see 'TaskRecord::expand()').
+  typedef std::shared_ptr<const StateResponse::Slave> SlaveRecord;
+  typedef std::shared_ptr<const Snapshot::Framework> FrameworkRecord;
+
+  hashmap<SlaveID, SlaveRecord> slaves_;
+
+  snapshot->slaves.reserve(slaves.registered.size());
+  foreachvalue (const Slave* slave, slaves.registered) {
+    Option<SlaveRecord> record = records.slaves.get(slave->id);
+    if (record.isNone()) {
+      record = SlaveRecord(new StateResponse::Slave(convert(*slave)));
+    }
+
+    snapshot->slaves.push_back(record.get());
+    slaves_[slave->id] = record.get();
+  }
+
+  records.slaves = std::move(slaves_);
+
+  hashmap<FrameworkID, FrameworkRecord> frameworks_;
+
+  snapshot->frameworks.reserve(frameworks.registered.size());
+  foreachvalue (const Framework* framework, frameworks.registered) {
+    Option<FrameworkRecord> record = records.frameworks.get(framework->id());
+    if (record.isNone()) {
+      record = FrameworkRecord(new Snapshot::Framework(expand(*framework)));
+    }
+
+    snapshot->frameworks.push_back(record.get());
+    frameworks_[framework->id()] = record.get();
+  }
+
+  records.frameworks = std::move(frameworks_);
+
+  // NOTE: Completed frameworks do not change, so their records are
+  // only converted once.
+  hashmap<FrameworkID, FrameworkRecord> completedFrameworks;
+
+  snapshot->completedFrameworks.reserve(frameworks.completed.size());
+  foreach (const std::shared_ptr<Framework>& framework,
+           frameworks.completed) {
+    Option<FrameworkRecord> record =
+      records.completedFrameworks.get(framework->id());
+
+    if (record.isNone()) {
+      record = FrameworkRecord(new Snapshot::Framework(expand(*framework)));
+    }
+
+    snapshot->completedFrameworks.push_back(record.get());
+    completedFrameworks[framework->id()] = record.get();
+  }
+
+  records.completedFrameworks = std::move(completedFrameworks);
+
+  // Find the orphan tasks and the frameworks that have not
+  // re-registered (yet) after a master failover. A framework is
+  // listed once, even if it has tasks on several slaves.
+  hashset<FrameworkID> unregisteredFrameworks;
+
+  foreachvalue (const Slave* slave, slaves.registered) {
+    typedef hashmap<TaskID, TaskRecord*> TaskMap;
+    foreachpair (const FrameworkID& frameworkId,
+                 const TaskMap& tasks,
+                 slave->tasks) {
+      if (!frameworks.registered.contains(frameworkId)) {
+        if (!unregisteredFrameworks.contains(frameworkId)) {
+          unregisteredFrameworks.insert(frameworkId);
+          snapshot->unregisteredFrameworks.push_back(frameworkId);
+        }
+
+        foreachvalue (const TaskRecord* task, tasks) {
+          snapshot->orphanTasks.push_back(CHECK_NOTNULL(task)->expand());
+        }
+      }
+    }
+  }
+
+  published = snapshot;
+
+  return published;
+}
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
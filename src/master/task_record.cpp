@@ -0,0 +1,218 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/stringify.hpp>
+#include <stout/synchronized.hpp>
+#include <stout/unreachable.hpp>
+
+#include "master/task_record.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::weak_ptr;
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+namespace {
+
+// The live interned values of a type, by their serialization.
+template <typename T>
+struct Pool
+{
+  std::mutex mutex;
+  hashmap<string, weak_ptr<const T>> values;
+};
+
+
+// NOTE: The pools are never deleted so that values can still be
+// released while the static objects are being destroyed at exit.
+template <typename T>
+Pool<T>* pool()
+{
+  static Pool<T>* pool = new Pool<T>();
+  return pool;
+}
+
+
+string serialize(const google::protobuf::Message& message)
+{
+  return message.SerializeAsString();
+}
+
+
+string serialize(const Resources& resources)
+{
+  // Prefix each resource with its length so that the concatenation
+  // is unambiguous.
+  string result;
+  foreach (const Resource& resource, resources) {
+    const string data = resource.SerializeAsString();
+    result += stringify(data.size()) + ":" + data;
+  }
+  return result;
+}
+
+} // namespace {
+
+
+template <typename T>
+shared_ptr<const T> intern(const T& value)
+{
+  const string key = serialize(value);
+
+  Pool<T>* pool_ = pool<T>();
+
+  synchronized (pool_->mutex) {
+    auto iterator = pool_->values.find(key);
+    if (iterator != pool_->values.end()) {
+      shared_ptr<const T> interned = iterator->second.lock();
+      if (interned) {
+        return interned;
+      }
+    }
+
+    // Remove the value from the pool once the last reference is
+    // dropped, unless it has been interned again in the meantime.
+    shared_ptr<const T> interned(new T(value), [pool_, key](const T* t) {
+      synchronized (pool_->mutex) {
+        auto iterator = pool_->values.find(key);
+        if (iterator != pool_->values.end() && iterator->second.expired()) {
+          pool_->values.erase(iterator);
+        }
+      }
+
+      delete t;
+    });
+
+    pool_->values[key] = interned;
+
+    return interned;
+  }
+
+  UNREACHABLE();
+}
+
+
+template shared_ptr<const FrameworkID> intern(const FrameworkID&);
+template shared_ptr<const SlaveID> intern(const SlaveID&);
+template shared_ptr<const ExecutorID> intern(const ExecutorID&);
+template shared_ptr<const Resources> intern(const Resources&);
+template shared_ptr<const Labels> intern(const Labels&);
+template shared_ptr<const DiscoveryInfo> intern(const DiscoveryInfo&);
+
+
+TaskRecord::TaskRecord(const Task& task)
+  : taskName(task.name()),
+    taskId(task.task_id()),
+    frameworkId(intern(task.framework_id())),
+    slaveId(intern(task.slave_id())),
+    taskState(task.state()),
+    taskResources(intern(Resources(task.resources()))),
+    taskStatuses(task.statuses())
+{
+  if (task.has_executor_id()) {
+    executorId = intern(task.executor_id());
+  }
+
+  if (task.has_status_update_state()) {
+    statusUpdateState = task.status_update_state();
+  }
+
+  if (task.has_status_update_uuid()) {
+    statusUpdateUUID = task.status_update_uuid();
+  }
+
+  if (task.has_labels()) {
+    taskLabels = intern(task.labels());
+  }
+
+  if (task.has_discovery()) {
+    discoveryInfo = intern(task.discovery());
+  }
+}
+
+
+Task TaskRecord::task() const
+{
+  Task task;
+  task.set_name(taskName);
+  task.mutable_task_id()->CopyFrom(taskId);
+  task.mutable_framework_id()->CopyFrom(*frameworkId);
+  task.mutable_slave_id()->CopyFrom(*slaveId);
+  task.set_state(taskState);
+  task.mutable_resources()->CopyFrom(*taskResources);
+  task.mutable_statuses()->CopyFrom(taskStatuses);
+
+  if (executorId.isSome()) {
+    task.mutable_executor_id()->CopyFrom(*executorId.get());
+  }
+
+  if (statusUpdateState.isSome()) {
+    task.set_status_update_state(statusUpdateState.get());
+  }
+
+  if (statusUpdateUUID.isSome()) {
+    task.set_status_update_uuid(statusUpdateUUID.get());
+  }
+
+  if (taskLabels.isSome()) {
+    task.mutable_labels()->CopyFrom(*taskLabels.get());
+  }
+
+  if (discoveryInfo.isSome()) {
+    task.mutable_discovery()->CopyFrom(*discoveryInfo.get());
+  }
+
+  return task;
+}
+
+
+shared_ptr<const Task> TaskRecord::expand() const
+{
+  if (!expanded) {
+    expanded.reset(new Task(task()));
+  }
+
+  return expanded;
+}
+
+
+Option<bool> TaskRecord::health() const
+{
+  // The statuses only keep the most recent status for each state,
+  // so the last status is either terminal (where health is
+  // irrelevant) or the latest RUNNING status.
+  if (taskStatuses.size() > 0 &&
+      taskStatuses.Get(taskStatuses.size() - 1).has_healthy()) {
+    return taskStatuses.Get(taskStatuses.size() - 1).healthy();
+  }
+
+  return None();
+}
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,171 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MASTER_TASK_RECORD_HPP__
+#define __MASTER_TASK_RECORD_HPP__
+
+#include <memory>
+#include <string>
+
+#include <google/protobuf/repeated_field.h>
+
+#include <mesos/mesos.hpp>
+#include <mesos/resources.hpp>
+
+#include <stout/option.hpp>
+
+#include "messages/messages.hpp"
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+// Returns an immutable copy of 'value' that is shared with all of the
+// other live copies of equal values (i.e., values with the same
+// serialization). The copy is released along with its last reference.
+// Used to deduplicate the parts of tasks that are the same across the
+// tasks of a framework, a slave or a job. Thread-safe.
+template <typename T>
+std::shared_ptr<const T> intern(const T& value);
+
+
+// The master's representation of a task. Holds the same information
+// as the 'Task' protobuf but shares the IDs, resources, labels and
+// discovery info with the other tasks that have the same values (see
+// 'intern()'), as these usually repeat across the tasks of a job. The
+// record is expanded into a 'Task' when it is serialized, e.g., for
+// the state endpoints or a framework's completed tasks archive.
+//
+// The accessors mirror the ones of the 'Task' protobuf.
+class TaskRecord
+{
+public:
+  explicit TaskRecord(const Task& task);
+
+  // Expands the record into a 'Task' protobuf.
+  Task task() const;
+
+  // Returns the record expanded into a 'Task' protobuf, which is
+  // shared with the earlier callers until the record changes. Used
+  // for the master's snapshots, so that only the tasks that changed
+  // since the last snapshot are expanded again.
+  std::shared_ptr<const Task> expand() const;
+
+  // Returns the health of the task according to its latest status,
+  // see 'protobuf::getTaskHealth()'.
+  Option<bool> health() const;
+
+  const std::string& name() const { return taskName; }
+  const TaskID& task_id() const { return taskId; }
+  const FrameworkID& framework_id() const { return *frameworkId; }
+  const SlaveID& slave_id() const { return *slaveId; }
+
+  bool has_executor_id() const { return executorId.isSome(); }
+  const ExecutorID& executor_id() const { return *executorId.get(); }
+
+  TaskState state() const { return taskState; }
+  void set_state(TaskState state)
+  {
+    expanded.reset();
+    taskState = state;
+  }
+
+  const Resources& resources() const { return *taskResources; }
+
+  const google::protobuf::RepeatedPtrField<TaskStatus>& statuses() const
+  {
+    return taskStatuses;
+  }
+
+  const TaskStatus& statuses(int index) const
+  {
+    return taskStatuses.Get(index);
+  }
+
+  int statuses_size() const { return taskStatuses.size(); }
+
+  TaskStatus* add_statuses()
+  {
+    expanded.reset();
+    return taskStatuses.Add();
+  }
+
+  google::protobuf::RepeatedPtrField<TaskStatus>* mutable_statuses()
+  {
+    expanded.reset();
+    return &taskStatuses;
+  }
+
+  TaskStatus* mutable_statuses(int index)
+  {
+    expanded.reset();
+    return taskStatuses.Mutable(index);
+  }
+
+  bool has_status_update_state() const { return statusUpdateState.isSome(); }
+  TaskState status_update_state() const { return statusUpdateState.get(); }
+
+  void set_status_update_state(TaskState state)
+  {
+    expanded.reset();
+    statusUpdateState = state;
+  }
+
+  bool has_status_update_uuid() const { return statusUpdateUUID.isSome(); }
+
+  const std::string& status_update_uuid() const
+  {
+    return statusUpdateUUID.get();
+  }
+
+  void set_status_update_uuid(const std::string& uuid)
+  {
+    expanded.reset();
+    statusUpdateUUID = uuid;
+  }
+
+  bool has_labels() const { return taskLabels.isSome(); }
+  const Labels& labels() const { return *taskLabels.get(); }
+
+  bool has_discovery() const { return discoveryInfo.isSome(); }
+  const DiscoveryInfo& discovery() const { return *discoveryInfo.get(); }
+
+private:
+  std::string taskName;
+  TaskID taskId;
+  std::shared_ptr<const FrameworkID> frameworkId;
+  std::shared_ptr<const SlaveID> slaveId;
+  Option<std::shared_ptr<const ExecutorID>> executorId;
+  TaskState taskState;
+  std::shared_ptr<const Resources> taskResources;
+  google::protobuf::RepeatedPtrField<TaskStatus> taskStatuses;
+  Option<TaskState> statusUpdateState;
+  Option<std::string> statusUpdateUUID;
+  Option<std::shared_ptr<const Labels>> taskLabels;
+  Option<std::shared_ptr<const DiscoveryInfo>> discoveryInfo;
+
+  // The expanded record, see 'expand()'. Reset by the mutators.
+  mutable std::shared_ptr<const Task> expanded;
+};
+
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_TASK_RECORD_HPP__
@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -350,7 +351,7 @@ Option<Error> validateResourceUsage(
 
   // Validate if resources needed by the task (and its executor in
   // case the executor is new) are available.
-  Resources total = taskResources;
+  Resources total = std::move(taskResources);
   if (!slave->hasExecutor(framework->id(), task.executor().executor_id())) {
     total += executorResources;
   }
@@ -386,13 +387,17 @@ Option<Error> validateResources(const TaskInfo& task)
 
   // A task and its executor can either use non-revocable resources
   // or revocable resources of a given name but not both.
-  foreach (const string& name, total.names()) {
-    Resources resources = total.get(name);
-    if (!resources.revocable().empty() &&
-        resources != resources.revocable()) {
+  hashmap<string, bool> revocable;
+  foreach (const Resource& resource, total) {
+    const bool isRevocable = Resources::isRevocable(resource);
+
+    if (revocable.contains(resource.name()) &&
+        revocable[resource.name()] != isRevocable) {
       return Error("Task (and its executor, if exists) uses both revocable and"
-                   " non-revocable " + name);
+                   " non-revocable " + resource.name());
     }
+
+    revocable[resource.name()] = isRevocable;
   }
 
   error = resource::validateUniquePersistenceID(total);
@@ -419,15 +424,23 @@ Option<Error> validate(
   // executed does matter! For example, 'validateResourceUsage'
   // assumes that ExecutorInfo is valid which is verified by
   // 'validateExecutorInfo'.
+  //
+  // NOTE: We bind references since 'lambda::bind' would otherwise
+  // copy the task (and the offered resources) for each validator.
   vector<lambda::function<Option<Error>(void)>> validators = {
-    lambda::bind(internal::validateTaskID, task),
-    lambda::bind(internal::validateUniqueTaskID, task, framework),
-    lambda::bind(internal::validateSlaveID, task, slave),
-    lambda::bind(internal::validateExecutorInfo, task, framework, slave),
+    lambda::bind(internal::validateTaskID, std::cref(task)),
+    lambda::bind(internal::validateUniqueTaskID, std::cref(task), framework),
+    lambda::bind(internal::validateSlaveID, std::cref(task), slave),
+    lambda::bind(
+        internal::validateExecutorInfo, std::cref(task), framework, slave),
     lambda::bind(internal::validateCheckpoint, framework, slave),
-    lambda::bind(internal::validateResources, task),
+    lambda::bind(internal::validateResources, std::cref(task)),
     lambda::bind(
-        internal::validateResourceUsage, task, framework, slave, offered)
+        internal::validateResourceUsage,
+        std::cref(task),
+        framework,
+        slave,
+        std::cref(offered))
   };
 
   // TODO(benh): Add a validateHealthCheck function.
@@ -555,9 +568,9 @@ Option<Error> validate(
   CHECK_NOTNULL(framework);
 
   vector<lambda::function<Option<Error>(void)>> validators = {
-    lambda::bind(validateUniqueOfferID, offerIds),
-    lambda::bind(validateFramework, offerIds, master, framework),
-    lambda::bind(validateSlave, offerIds, master)
+    lambda::bind(validateUniqueOfferID, std::cref(offerIds)),
+    lambda::bind(validateFramework, std::cref(offerIds), master, framework),
+    lambda::bind(validateSlave, std::cref(offerIds), master)
   };
 
   foreach (const lambda::function<Option<Error>(void)>& validator, validators) {
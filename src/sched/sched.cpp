@@ -200,6 +200,10 @@ protected:
         &StatusUpdateMessage::update,
         &StatusUpdateMessage::pid);
 
+    install<StatusUpdatesMessage>(
+        &SchedulerProcess::statusUpdates,
+        &StatusUpdatesMessage::updates);
+
     install<LostSlaveMessage>(
         &SchedulerProcess::lostSlave,
         &LostSlaveMessage::slave_id);
@@ -946,6 +950,19 @@ protected:
     }
   }
 
+  void statusUpdates(
+      const UPID& from,
+      const vector<StatusUpdateMessage>& messages)
+  {
+    VLOG(2) << "Received " << messages.size() << " batched status updates";
+
+    // Each update is handled (and acknowledged) as if it had been
+    // sent on its own, see 'statusUpdate()' above.
+    foreach (const StatusUpdateMessage& message, messages) {
+      statusUpdate(from, message.update(), UPID(message.pid()));
+    }
+  }
+
   void lostSlave(const UPID& from, const SlaveID& slaveId)
   {
     if (!running) {
@@ -1234,6 +1251,23 @@ protected:
     send(master.get().pid(), call);
   }
 
+  void suppressOffers()
+  {
+    if (!connected) {
+      VLOG(1) << "Ignoring suppress offers message as master is disconnected";
+      return;
+    }
+
+    Call call;
+
+    CHECK(framework.has_id());
+    call.mutable_framework_id()->CopyFrom(framework.id());
+    call.set_type(Call::SUPPRESS);
+
+    CHECK_SOME(master);
+    send(master.get().pid(), call);
+  }
+
   void acknowledgeStatusUpdate(
       const TaskStatus& status)
   {
@@ -1928,6 +1962,22 @@ Status MesosSchedulerDriver::reviveOffers()
 }
 
 
+Status MesosSchedulerDriver::suppressOffers()
+{
+  synchronized (mutex) {
+    if (status != DRIVER_RUNNING) {
+      return status;
+    }
+
+    CHECK(process != NULL);
+
+    dispatch(process, &SchedulerProcess::suppressOffers);
+
+    return status;
+  }
+}
+
+
 Status MesosSchedulerDriver::acknowledgeStatusUpdate(
     const TaskStatus& taskStatus)
 {
@@ -52,6 +52,7 @@
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
 #include <stout/flags.hpp>
+#include <stout/foreach.hpp>
 #include <stout/ip.hpp>
 #include <stout/lambda.hpp>
 #include <stout/nothing.hpp>
@@ -259,6 +260,11 @@ public:
         break;
       }
 
+      case Call::SUPPRESS: {
+        send(master.get(), call);
+        break;
+      }
+
       case Call::KILL: {
         if (!call.has_kill()) {
           drop(call, "Expecting 'kill' to be present");
@@ -330,6 +336,7 @@ protected:
     install<ResourceOffersMessage>(&MesosProcess::receive);
     install<RescindResourceOfferMessage>(&MesosProcess::receive);
     install<StatusUpdateMessage>(&MesosProcess::receive);
+    install<StatusUpdatesMessage>(&MesosProcess::receive);
     install<LostSlaveMessage>(&MesosProcess::receive);
     install<ExitedExecutorMessage>(&MesosProcess::receive);
     install<ExecutorToFrameworkMessage>(&MesosProcess::receive);
@@ -577,6 +584,15 @@ protected:
     receive(from, protobuf::scheduler::event(message));
   }
 
+  void receive(const UPID& from, const StatusUpdatesMessage& message)
+  {
+    // The UPDATE events are queued together and hence usually handed
+    // to the 'received' callback in a single invocation.
+    foreach (const StatusUpdateMessage& update, message.updates()) {
+      receive(from, protobuf::scheduler::event(update));
+    }
+  }
+
   void receive(const UPID& from, const LostSlaveMessage& message)
   {
     receive(from, protobuf::scheduler::event(message));
@@ -44,6 +44,7 @@
 #include "mesos/mesos.hpp"
 #include "mesos/resources.hpp"
 
+#include "slave/http.pb.h"
 #include "slave/slave.hpp"
 
 
@@ -166,6 +167,54 @@ JSON::Object model(const Framework& framework)
 }
 
 
+// Returns the protobuf message of an executor for the
+// 'application/x-protobuf' response of '/state.json'.
+static StateResponse::Executor convert(const Executor& executor)
+{
+  StateResponse::Executor message;
+  message.mutable_info()->CopyFrom(executor.info);
+  message.mutable_container_id()->CopyFrom(executor.containerId);
+  message.set_directory(executor.directory);
+  message.mutable_resources()->CopyFrom(executor.resources);
+
+  foreach (Task* task, executor.launchedTasks.values()) {
+    message.add_tasks()->CopyFrom(*task);
+  }
+
+  foreach (const TaskInfo& task, executor.queuedTasks.values()) {
+    message.add_queued_tasks()->CopyFrom(task);
+  }
+
+  foreach (const std::shared_ptr<Task>& task, executor.completedTasks) {
+    message.add_completed_tasks()->CopyFrom(*task);
+  }
+
+  // NOTE: As for JSON, we add 'terminatedTasks' to 'completed_tasks'.
+  foreach (Task* task, executor.terminatedTasks.values()) {
+    message.add_completed_tasks()->CopyFrom(*task);
+  }
+
+  return message;
+}
+
+
+static StateResponse::Framework convert(const Framework& framework)
+{
+  StateResponse::Framework message;
+  message.mutable_info()->CopyFrom(framework.info);
+
+  foreachvalue (Executor* executor, framework.executors) {
+    message.add_executors()->CopyFrom(convert(*executor));
+  }
+
+  foreach (const Owned<Executor>& executor, framework.completedExecutors) {
+    message.add_completed_executors()->CopyFrom(convert(*executor));
+  }
+
+  return message;
+}
+
+
 void Slave::Http::log(const Request& request)
 {
   Option<string> userAgent = request.headers.get("User-Agent");
@@ -205,11 +254,17 @@ const string Slave::Http::STATE_HELP = HELP(
         "/state.json"),
     DESCRIPTION(
         "This endpoint shows information about the frameworks, executors",
-        "and the slave's master as a JSON object."));
+        "and the slave's master as a JSON object, or as a serialized",
+        "'mesos.internal.slave.StateResponse' message if the request",
+        "accepts 'application/x-protobuf'."));
 
 
 Future<Response> Slave::Http::state(const Request& request) const
 {
+  if (negotiate(request) == ContentType::PROTOBUF) {
+    return _state();
+  }
+
   JSON::Object object;
   object.values["version"] = MESOS_VERSION;
 
@@ -274,6 +329,71 @@ Future<Response> Slave::Http::state(const Request& request) const
   return OK(object, request.query.get("jsonp"));
 }
 
+
+Response Slave::Http::_state() const
+{
+  StateResponse state;
+  state.set_version(MESOS_VERSION);
+
+  if (build::GIT_SHA.isSome()) {
+    state.set_git_sha(build::GIT_SHA.get());
+  }
+
+  if (build::GIT_BRANCH.isSome()) {
+    state.set_git_branch(build::GIT_BRANCH.get());
+  }
+
+  if (build::GIT_TAG.isSome()) {
+    state.set_git_tag(build::GIT_TAG.get());
+  }
+
+  state.set_build_date(build::DATE);
+  state.set_build_time(build::TIME);
+  state.set_build_user(build::USER);
+  state.set_start_time(slave->startTime.secs());
+  state.set_id(slave->info.id().value());
+  state.set_pid(slave->self());
+  state.set_hostname(slave->info.hostname());
+  state.mutable_resources()->CopyFrom(slave->info.resources());
+  state.mutable_attributes()->CopyFrom(slave->info.attributes());
+
+  if (slave->master.isSome()) {
+    Try<string> hostname = net::getHostname(slave->master.get().address.ip);
+    if (hostname.isSome()) {
+      state.set_master_hostname(hostname.get());
+    }
+  }
+
+  if (slave->flags.log_dir.isSome()) {
+    state.set_log_dir(slave->flags.log_dir.get());
+  }
+
+  if (slave->flags.external_log_file.isSome()) {
+    state.set_external_log_file(slave->flags.external_log_file.get());
+  }
+
+  foreachpair (const string& name, const flags::Flag& flag, slave->flags) {
+    Option<string> value = flag.stringify(slave->flags);
+    if (value.isSome()) {
+      Parameter* parameter = state.add_flags();
+      parameter->set_key(name);
+      parameter->set_value(value.get());
+    }
+  }
+
+  foreachvalue (Framework* framework, slave->frameworks) {
+    state.add_frameworks()->CopyFrom(convert(*framework));
+  }
+
+  foreach (const Owned<Framework>& framework, slave->completedFrameworks) {
+    state.add_completed_frameworks()->CopyFrom(convert(*framework));
+  }
+
+  OK ok(state.SerializeAsString());
+  ok.headers["Content-Type"] = APPLICATION_PROTOBUF;
+  return ok;
+}
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
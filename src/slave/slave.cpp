@@ -28,6 +28,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <mesos/type_utils.hpp>
@@ -1349,9 +1350,14 @@ void Slave::runTask(
     }
   }
 
-  // Run the task after the unschedules are done.
-  unschedule.onAny(
-      defer(self(), &Self::_runTask, lambda::_1, frameworkInfo, task));
+  // Run the task after the unschedules are done. We are done with
+  // our copies of the task and framework info, so we move them.
+  unschedule.onAny(defer(
+      self(),
+      &Self::_runTask,
+      lambda::_1,
+      std::move(frameworkInfo),
+      std::move(task)));
 }
 
 
@@ -410,6 +410,9 @@ private:
     static const std::string STATE_HELP;
 
   private:
+    // Returns the state as a serialized protobuf message.
+    process::http::Response _state() const;
+
     Slave* slave;
   };
 
@@ -0,0 +1,209 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include <glog/logging.h>
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <mesos/resources.hpp>
+
+#include <stout/gtest.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
+
+using mesos::Resources;
+
+using std::cout;
+using std::endl;
+using std::string;
+
+using testing::WithParamInterface;
+
+// This binary replaces the global allocation functions in order to
+// count heap allocations, which is why these benchmarks are not part
+// of the mesos tests. The replacements only forward to 'malloc' and
+// 'free' unless an 'AllocationCounter' is in scope.
+static std::atomic<std::atomic<uint64_t>*> counter(NULL);
+
+
+static void* allocate(size_t size)
+{
+  std::atomic<uint64_t>* allocations = counter.load();
+  if (allocations != NULL) {
+    ++(*allocations);
+  }
+
+  // NOTE: 'malloc(0)' may return NULL, but 'operator new' must
+  // return a unique pointer.
+  return malloc(size == 0 ? 1 : size);
+}
+
+
+void* operator new (size_t size)
+{
+  void* pointer = allocate(size);
+  if (pointer == NULL) {
+    throw std::bad_alloc();
+  }
+
+  return pointer;
+}
+
+
+void* operator new[] (size_t size)
+{
+  void* pointer = allocate(size);
+  if (pointer == NULL) {
+    throw std::bad_alloc();
+  }
+
+  return pointer;
+}
+
+
+void* operator new (size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size);
+}
+
+
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size);
+}
+
+
+void operator delete (void* pointer) noexcept
+{
+  free(pointer);
+}
+
+
+void operator delete[] (void* pointer) noexcept
+{
+  free(pointer);
+}
+
+
+void operator delete (void* pointer, const std::nothrow_t&) noexcept
+{
+  free(pointer);
+}
+
+
+void operator delete[] (void* pointer, const std::nothrow_t&) noexcept
+{
+  free(pointer);
+}
+
+
+// Counts the allocations made through 'operator new' by all threads
+// while an instance is in scope.
+class AllocationCounter
+{
+public:
+  AllocationCounter() : allocations(0)
+  {
+    std::atomic<uint64_t>* previous = NULL;
+    CHECK(counter.compare_exchange_strong(previous, &allocations))
+      << "Allocations are already being counted";
+  }
+
+  ~AllocationCounter()
+  {
+    counter.store(NULL);
+  }
+
+  uint64_t count() const
+  {
+    return allocations.load();
+  }
+
+private:
+  std::atomic<uint64_t> allocations;
+};
+
+
+int main(int argc, char** argv)
+{
+  // Initialize Google Mock/Test.
+  testing::InitGoogleMock(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
+
+
+class Resources_BENCHMARK_Test : public WithParamInterface<size_t>,
+                                 public ::testing::Test {};
+
+
+// The resources benchmark tests are parameterized by the number of
+// roles.
+INSTANTIATE_TEST_CASE_P(
+    ResourceCount,
+    Resources_BENCHMARK_Test,
+    ::testing::Values(10U, 100U, 1000U));
+
+
+// Measures the heap allocations made when parsing the resources of a
+// task and checking that an offer with reservations for many roles
+// contains them, as done for each task launched by the master.
+TEST_P(Resources_BENCHMARK_Test, Allocations)
+{
+  const size_t roleCount = GetParam();
+  const size_t iterations = 1000;
+
+  Resources offered = Resources::parse(
+      "cpus:16;mem:65536;disk:1048576;ports:[31000-32000]").get();
+
+  for (size_t i = 0; i < roleCount; i++) {
+    const string role = "role" + stringify(i);
+
+    offered += Resources::parse(
+        "cpus(" + role + "):1;mem(" + role + "):128").get();
+  }
+
+  const string text = "cpus:0.5;mem:256;disk:512;ports:[31000-31010]";
+
+  uint64_t count = 0;
+
+  Stopwatch watch;
+  watch.start();
+
+  {
+    AllocationCounter counter;
+
+    for (size_t i = 0; i < iterations; i++) {
+      Resources task = Resources::parse(text).get();
+      EXPECT_TRUE(offered.contains(task));
+    }
+
+    count = counter.count();
+  }
+
+  cout << "Parsed and checked task resources against an offer with "
+       << roleCount << " roles " << iterations << " times in "
+       << watch.elapsed() << " with " << count << " allocations" << endl;
+}
@@ -184,3 +184,77 @@ TEST(HTTP, ModelRoleResources)
   ASSERT_SOME(expected);
   EXPECT_EQ(expected.get(), object);
 }
+
+
+// This test ensures that projections select the (nested) fields of
+// objects, including the objects in arrays.
+TEST(HTTPTest, Projection)
+{
+  Try<JSON::Value> value = JSON::parse(
+      "{"
+      "  \"id\":\"master\","
+      "  \"hostname\":\"localhost\","
+      "  \"slaves\":"
+      "  ["
+      "    {\"id\":\"s1\",\"hostname\":\"host1\",\"active\":true},"
+      "    {\"id\":\"s2\",\"hostname\":\"host2\",\"active\":false}"
+      "  ],"
+      "  \"flags\":{\"quorum\":\"1\",\"work_dir\":\"/tmp\"}"
+      "}");
+
+  ASSERT_SOME(value);
+
+  // All fields are selected by default.
+  EXPECT_EQ(value.get(), Projection().apply(value.get()));
+
+  Projection projection("id,slaves.hostname,flags");
+
+  EXPECT_TRUE(projection.includes("id"));
+  EXPECT_TRUE(projection.includes("slaves"));
+  EXPECT_TRUE(projection.includes("flags"));
+  EXPECT_FALSE(projection.includes("hostname"));
+
+  EXPECT_TRUE(projection.nested("slaves").includes("hostname"));
+  EXPECT_FALSE(projection.nested("slaves").includes("id"));
+  EXPECT_TRUE(projection.nested("flags").includes("quorum"));
+
+  Try<JSON::Value> expected = JSON::parse(
+      "{"
+      "  \"id\":\"master\","
+      "  \"slaves\":"
+      "  ["
+      "    {\"hostname\":\"host1\"},"
+      "    {\"hostname\":\"host2\"}"
+      "  ],"
+      "  \"flags\":{\"quorum\":\"1\",\"work_dir\":\"/tmp\"}"
+      "}");
+
+  ASSERT_SOME(expected);
+  EXPECT_EQ(expected.get(), projection.apply(value.get()));
+
+  // An empty projection selects no fields.
+  EXPECT_EQ(JSON::Object(), Projection("").apply(value.get()));
+}
+
+
+// This test ensures that the content-type is negotiated based on the
+// order of the media types in the 'Accept' header.
+TEST(HTTPTest, Negotiate)
+{
+  process::http::Request request;
+
+  // JSON is the default.
+  EXPECT_EQ(ContentType::JSON, negotiate(request));
+
+  request.headers["Accept"] = "*/*";
+  EXPECT_EQ(ContentType::JSON, negotiate(request));
+
+  request.headers["Accept"] = APPLICATION_PROTOBUF;
+  EXPECT_EQ(ContentType::PROTOBUF, negotiate(request));
+
+  request.headers["Accept"] = "application/x-protobuf;q=0.9, application/json";
+  EXPECT_EQ(ContentType::PROTOBUF, negotiate(request));
+
+  request.headers["Accept"] = "text/html, application/json, */*";
+  EXPECT_EQ(ContentType::JSON, negotiate(request));
+}
@@ -22,20 +22,24 @@
 #include <iostream>
 #include <string>
 #include <queue>
+#include <tuple>
 #include <vector>
 
 #include <mesos/master/allocator.hpp>
 
+#include <process/check.hpp>
 #include <process/clock.hpp>
 #include <process/future.hpp>
 #include <process/gtest.hpp>
 #include <process/shared.hpp>
 #include <process/queue.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
 #include <stout/gtest.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
+#include <stout/json.hpp>
 #include <stout/os.hpp>
 #include <stout/stopwatch.hpp>
 #include <stout/utils.hpp>
@@ -63,6 +67,7 @@ using std::cout;
 using std::endl;
 using std::queue;
 using std::string;
+using std::tuple;
 using std::vector;
 
 using testing::WithParamInterface;
@@ -1052,6 +1057,409 @@ TEST_F(HierarchicalAllocatorTest, Whitelist)
 }
 
 
+// Checks that declined resources are filtered until the filter
+// expires, independently of the order in which filters are installed.
+TEST_F(HierarchicalAllocatorTest, FilterExpiry)
+{
+  Clock::pause();
+
+  initialize(vector<string>{});
+
+  hashmap<FrameworkID, Resources> EMPTY;
+
+  SlaveInfo slave1 = createSlaveInfo("cpus:1;mem:512");
+  allocator->addSlave(slave1.id(), slave1, slave1.resources(), EMPTY);
+
+  SlaveInfo slave2 = createSlaveInfo("cpus:1;mem:512");
+  allocator->addSlave(slave2.id(), slave2, slave2.resources(), EMPTY);
+
+  FrameworkInfo framework = createFrameworkInfo("*");
+  allocator->addFramework(
+      framework.id(), framework, hashmap<SlaveID, Resources>());
+
+  Future<Allocation> allocation = queue.get();
+  AWAIT_READY(allocation);
+  EXPECT_EQ(2u, allocation.get().resources.size());
+
+  // Decline slave2 for a shorter duration than slave1 so that the
+  // filter installed last expires first.
+  Filters filters;
+  filters.set_refuse_seconds(10);
+  allocator->recoverResources(
+      framework.id(), slave1.id(), slave1.resources(), filters);
+
+  filters.set_refuse_seconds(5);
+  allocator->recoverResources(
+      framework.id(), slave2.id(), slave2.resources(), filters);
+
+  allocation = queue.get();
+
+  Clock::advance(flags.allocation_interval);
+  Clock::settle();
+
+  // Both slaves are filtered.
+  ASSERT_TRUE(allocation.isPending());
+
+  Clock::advance(Seconds(4));
+
+  AWAIT_READY(allocation);
+  EXPECT_EQ(framework.id(), allocation.get().frameworkId);
+  EXPECT_EQ(1u, allocation.get().resources.size());
+  EXPECT_TRUE(allocation.get().resources.contains(slave2.id()));
+
+  allocation = queue.get();
+
+  Clock::advance(Seconds(4));
+  Clock::settle();
+
+  // Slave1 is still filtered.
+  ASSERT_TRUE(allocation.isPending());
+
+  Clock::advance(Seconds(1));
+
+  AWAIT_READY(allocation);
+  EXPECT_EQ(framework.id(), allocation.get().frameworkId);
+  EXPECT_EQ(1u, allocation.get().resources.size());
+  EXPECT_TRUE(allocation.get().resources.contains(slave1.id()));
+}
+
+
+// Checks that a framework that suppressed offers is not offered
+// resources until it revives offers.
+TEST_F(HierarchicalAllocatorTest, SuppressOffers)
+{
+  Clock::pause();
+
+  initialize(vector<string>{});
+
+  hashmap<FrameworkID, Resources> EMPTY;
+
+  SlaveInfo slave = createSlaveInfo("cpus:1;mem:512");
+  allocator->addSlave(slave.id(), slave, slave.resources(), EMPTY);
+
+  FrameworkInfo framework = createFrameworkInfo("*");
+  allocator->addFramework(
+      framework.id(), framework, hashmap<SlaveID, Resources>());
+
+  Future<Allocation> allocation = queue.get();
+  AWAIT_READY(allocation);
+  EXPECT_EQ(framework.id(), allocation.get().frameworkId);
+
+  allocator->suppressOffers(framework.id());
+
+  // Decline the offer without a filter, the resources would be
+  // offered again in the next allocation if not for the suppression.
+  allocator->recoverResources(
+      framework.id(), slave.id(), slave.resources(), None());
+
+  allocation = queue.get();
+
+  Clock::advance(flags.allocation_interval);
+  Clock::settle();
+
+  ASSERT_TRUE(allocation.isPending());
+
+  // Deactivation lifts the suppression, but a framework that
+  // suppresses offers while inactive is not offered resources when it
+  // gets activated.
+  allocator->deactivateFramework(framework.id());
+  allocator->suppressOffers(framework.id());
+  allocator->activateFramework(framework.id());
+
+  Clock::advance(flags.allocation_interval);
+  Clock::settle();
+
+  ASSERT_TRUE(allocation.isPending());
+
+  allocator->reviveOffers(framework.id());
+
+  AWAIT_READY(allocation);
+  EXPECT_EQ(framework.id(), allocation.get().frameworkId);
+  EXPECT_EQ(slave.resources(), Resources::sum(allocation.get().resources));
+}
+
+
+// Checks that when batch allocations are sharded across workers the
+// slaves are still divided fairly between the frameworks.
+TEST_F(HierarchicalAllocatorTest, ShardedAllocation)
+{
+  Clock::pause();
+
+  delete allocator;
+  allocator = CHECK_NOTNULL(HierarchicalDRFAllocator::create(2).get());
+
+  initialize(vector<string>{});
+
+  FrameworkInfo framework1 = createFrameworkInfo("*");
+  allocator->addFramework(
+      framework1.id(), framework1, hashmap<SlaveID, Resources>());
+
+  FrameworkInfo framework2 = createFrameworkInfo("*");
+  allocator->addFramework(
+      framework2.id(), framework2, hashmap<SlaveID, Resources>());
+
+  hashmap<FrameworkID, Resources> EMPTY;
+
+  for (int i = 0; i < 4; i++) {
+    SlaveInfo slave = createSlaveInfo("cpus:2;mem:1024");
+    allocator->addSlave(slave.id(), slave, slave.resources(), EMPTY);
+  }
+
+  // The slaves are allocated as they are added, wait for those
+  // allocations and then recover the resources so that all the
+  // slaves get allocated by the next (sharded) batch allocation.
+  size_t offered = 0;
+  while (offered < 4) {
+    Future<Allocation> allocation = queue.get();
+    AWAIT_READY(allocation);
+
+    offered += allocation.get().resources.size();
+
+    foreachpair (const SlaveID& slaveId,
+                 const Resources& resources,
+                 allocation.get().resources) {
+      allocator->recoverResources(
+          allocation.get().frameworkId, slaveId, resources, None());
+    }
+  }
+
+  Clock::settle();
+  Clock::advance(flags.allocation_interval);
+
+  hashmap<FrameworkID, size_t> slaves;
+  for (int i = 0; i < 2; i++) {
+    Future<Allocation> allocation = queue.get();
+    AWAIT_READY(allocation);
+
+    slaves[allocation.get().frameworkId] = allocation.get().resources.size();
+  }
+
+  EXPECT_EQ(2u, slaves[framework1.id()]);
+  EXPECT_EQ(2u, slaves[framework2.id()]);
+}
+
+
+// Checks that a sharded allocation still favors the frameworks with
+// the lowest shares, rather than giving each worker's slaves to a
+// different framework.
+TEST_F(HierarchicalAllocatorTest, ShardedAllocationUnequalShares)
+{
+  Clock::pause();
+
+  delete allocator;
+  allocator = CHECK_NOTNULL(HierarchicalDRFAllocator::create(2).get());
+
+  initialize(vector<string>{});
+
+  hashmap<FrameworkID, Resources> EMPTY;
+
+  FrameworkInfo framework1 = createFrameworkInfo("*");
+  allocator->addFramework(
+      framework1.id(), framework1, hashmap<SlaveID, Resources>());
+
+  // framework1 keeps all of slave1, which gives it a share of 0.8
+  // once the other slaves are added.
+  SlaveInfo slave1 = createSlaveInfo("cpus:8;mem:4096");
+  allocator->addSlave(slave1.id(), slave1, slave1.resources(), EMPTY);
+
+  Future<Allocation> allocation = queue.get();
+  AWAIT_READY(allocation);
+  EXPECT_EQ(framework1.id(), allocation.get().frameworkId);
+
+  FrameworkInfo framework2 = createFrameworkInfo("*");
+  allocator->addFramework(
+      framework2.id(), framework2, hashmap<SlaveID, Resources>());
+
+  // Keep the other slaves from being allocated as they are added, so
+  // that they are allocated by the next (sharded) batch allocation,
+  // one by each worker.
+  hashset<string> whitelist;
+  whitelist.insert(slave1.hostname());
+  allocator->updateWhitelist(whitelist);
+
+  for (int i = 0; i < 2; i++) {
+    SlaveInfo slave = createSlaveInfo("cpus:1;mem:512");
+    allocator->addSlave(slave.id(), slave, slave.resources(), EMPTY);
+  }
+
+  allocator->updateWhitelist(None());
+
+  Clock::settle();
+  Clock::advance(flags.allocation_interval);
+
+  // framework2 has the lower share even after it has been allocated
+  // both slaves, so both workers allocate to it.
+  allocation = queue.get();
+  AWAIT_READY(allocation);
+  EXPECT_EQ(framework2.id(), allocation.get().frameworkId);
+  EXPECT_EQ(2u, allocation.get().resources.size());
+
+  // There should be no allocation to framework1.
+  allocation = queue.get();
+
+  Clock::settle();
+
+  EXPECT_TRUE(allocation.isPending());
+}
+
+
+// Checks that the allocator exposes metrics about the offers it makes
+// and the filters it checks.
+TEST_F(HierarchicalAllocatorTest, Metrics)
+{
+  Clock::pause();
+
+  initialize(vector<string>{"role1"});
+
+  hashmap<FrameworkID, Resources> EMPTY;
+
+  SlaveInfo slave = createSlaveInfo("cpus:2;mem:1024;disk:0;gpus:1");
+  allocator->addSlave(slave.id(), slave, slave.resources(), EMPTY);
+
+  FrameworkInfo framework = createFrameworkInfo("role1");
+  allocator->addFramework(
+      framework.id(), framework, hashmap<SlaveID, Resources>());
+
+  Future<Allocation> allocation = queue.get();
+  AWAIT_READY(allocation);
+
+  // Decline the offer so that the next allocation is filtered.
+  Filters filters;
+  filters.set_refuse_seconds(10);
+  allocator->recoverResources(
+      framework.id(), slave.id(), slave.resources(), filters);
+
+  Clock::advance(flags.allocation_interval);
+  Clock::settle();
+
+  JSON::Object metrics = Metrics();
+
+  EXPECT_EQ(1u, metrics.values["allocator/offers"]);
+  EXPECT_EQ(1u, metrics.values["allocator/roles/role1/offers"]);
+  EXPECT_EQ(2u, metrics.values["allocator/roles/role1/cpus_offered_total"]);
+  EXPECT_EQ(1024u, metrics.values["allocator/roles/role1/mem_offered_total"]);
+  EXPECT_EQ(1u, metrics.values["allocator/roles/role1/gpus_offered_total"]);
+
+  // Only the resources that have been offered to the role have a
+  // gauge.
+  EXPECT_EQ(
+      0u, metrics.values.count("allocator/roles/role1/disk_offered_total"));
+  EXPECT_EQ(0u, metrics.values["allocator/roles/*/offers"]);
+
+  EXPECT_EQ(2u, metrics.values["allocator/filter_checks"]);
+  EXPECT_EQ(1u, metrics.values["allocator/filtered"]);
+
+  EXPECT_EQ(1u, metrics.values.count("allocator/allocation_run_ms"));
+  EXPECT_EQ(1u, metrics.values.count("allocator/allocation_sort_time_ms"));
+  EXPECT_EQ(1u, metrics.values.count("allocator/event_queue_dispatches"));
+}
+
+
+// Checks that an allocation only looks at the slaves that have
+// resources available to offer.
+TEST_F(HierarchicalAllocatorTest, SkipFullyAllocatedSlaves)
+{
+  Clock::pause();
+
+  initialize(vector<string>{});
+
+  hashmap<FrameworkID, Resources> EMPTY;
+
+  FrameworkInfo framework = createFrameworkInfo("*");
+  allocator->addFramework(
+      framework.id(), framework, hashmap<SlaveID, Resources>());
+
+  SlaveInfo slave1 = createSlaveInfo("cpus:2;mem:1024");
+  allocator->addSlave(slave1.id(), slave1, slave1.resources(), EMPTY);
+
+  SlaveInfo slave2 = createSlaveInfo("cpus:2;mem:1024");
+  allocator->addSlave(slave2.id(), slave2, slave2.resources(), EMPTY);
+
+  // The slaves might be offered together since allocations are batched.
+  size_t offered = 0;
+  while (offered < 2) {
+    Future<Allocation> allocation = queue.get();
+    AWAIT_READY(allocation);
+
+    offered += allocation.get().resources.size();
+  }
+
+  // Both slaves are fully allocated.
+  Clock::advance(flags.allocation_interval);
+  Clock::settle();
+
+  JSON::Object metrics = Metrics();
+  EXPECT_EQ(0u, metrics.values["allocator/allocation_batch_slaves"]);
+
+  // Recovering a part of the resources makes slave1 allocatable again.
+  allocator->recoverResources(
+      framework.id(),
+      slave1.id(),
+      Resources::parse("cpus:1;mem:512").get(),
+      None());
+
+  Future<Allocation> allocation = queue.get();
+
+  Clock::advance(flags.allocation_interval);
+
+  AWAIT_READY(allocation);
+  EXPECT_EQ(1u, allocation.get().resources.size());
+  EXPECT_TRUE(allocation.get().resources.contains(slave1.id()));
+
+  Clock::settle();
+
+  metrics = Metrics();
+  EXPECT_EQ(1u, metrics.values["allocator/allocation_batch_slaves"]);
+}
+
+
+// Checks that the allocations triggered by events are batched when
+// an allocation batch interval is specified.
+TEST_F(HierarchicalAllocatorTest, BatchedAllocations)
+{
+  Clock::pause();
+
+  const Duration batchInterval = Milliseconds(100);
+
+  delete allocator;
+  allocator = CHECK_NOTNULL(
+      HierarchicalDRFAllocator::create(0, batchInterval).get());
+
+  initialize(vector<string>{});
+
+  hashmap<FrameworkID, Resources> EMPTY;
+
+  // The first allocation is performed right away.
+  SlaveInfo slave1 = createSlaveInfo("cpus:2;mem:1024");
+  allocator->addSlave(slave1.id(), slave1, slave1.resources(), EMPTY);
+
+  Clock::settle();
+
+  FrameworkInfo framework = createFrameworkInfo("*");
+  allocator->addFramework(
+      framework.id(), framework, hashmap<SlaveID, Resources>());
+
+  // The framework is added within the interval, so it has to wait
+  // for the next allocation, along with the slaves added meanwhile.
+  SlaveInfo slave2 = createSlaveInfo("cpus:2;mem:1024");
+  allocator->addSlave(slave2.id(), slave2, slave2.resources(), EMPTY);
+
+  SlaveInfo slave3 = createSlaveInfo("cpus:2;mem:1024");
+  allocator->addSlave(slave3.id(), slave3, slave3.resources(), EMPTY);
+
+  Future<Allocation> allocation = queue.get();
+
+  Clock::settle();
+  EXPECT_TRUE(allocation.isPending());
+
+  Clock::advance(batchInterval);
+
+  AWAIT_READY(allocation);
+  EXPECT_EQ(framework.id(), allocation.get().frameworkId);
+  EXPECT_EQ(3u, allocation.get().resources.size());
+}
+
+
 class HierarchicalAllocator_BENCHMARK_Test
   : public HierarchicalAllocatorTestBase,
     public WithParamInterface<size_t>
@@ -1136,6 +1544,491 @@ TEST_P(HierarchicalAllocator_BENCHMARK_Test, AddAndUpdateSlave)
   cout << "Updated " << slaveCount << " slaves in " << watch.elapsed() << endl;
 }
 
+
+class HierarchicalAllocatorFilters_BENCHMARK_Test
+  : public HierarchicalAllocatorTestBase,
+    public WithParamInterface<size_t>
+{};
+
+
+// The offer filter benchmark tests are parameterized by the number of
+// frameworks.
+INSTANTIATE_TEST_CASE_P(
+    FrameworkCount,
+    HierarchicalAllocatorFilters_BENCHMARK_Test,
+    ::testing::Values(10U, 50U, 100U, 200U));
+
+
+// Measures the duration of batch allocations when every framework has
+// declined every slave, i.e., there is a filter for each framework
+// and slave pair.
+TEST_P(HierarchicalAllocatorFilters_BENCHMARK_Test, DeclineOffers)
+{
+  Clock::pause();
+
+  const size_t slaveCount = 1000;
+  const size_t frameworkCount = GetParam();
+
+  Filters filters;
+  filters.set_refuse_seconds(Hours(1).secs());
+
+  // Number of slaves declined. This is used to determine the
+  // termination condition.
+  atomic<size_t> declined(0);
+
+  // Decline all offers, which installs a filter for each slave.
+  auto offerCallback = [this, &declined, &filters](
+      const FrameworkID& frameworkId,
+      const hashmap<SlaveID, Resources>& resources) {
+    foreachpair (const SlaveID& slaveId, const Resources& offered, resources) {
+      allocator->recoverResources(frameworkId, slaveId, offered, filters);
+    }
+
+    declined += resources.size();
+  };
+
+  initialize({}, master::Flags(), offerCallback);
+
+  for (size_t i = 0; i < frameworkCount; i++) {
+    FrameworkInfo framework = createFrameworkInfo("*");
+    allocator->addFramework(framework.id(), framework, {});
+  }
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < slaveCount; i++) {
+    SlaveInfo slave = createSlaveInfo(
+        "cpus:2;mem:1024;disk:4096;ports:[31000-32000]");
+    allocator->addSlave(slave.id(), slave, slave.resources(), {});
+  }
+
+  // Each batch allocation offers every slave to one of the frameworks
+  // that has not declined it yet.
+  size_t cycles = 0;
+  while (declined.load() < slaveCount * frameworkCount) {
+    Clock::advance(flags.allocation_interval);
+    Clock::settle();
+    cycles++;
+  }
+
+  cout << "Declined " << slaveCount << " slaves by " << frameworkCount
+       << " frameworks in " << cycles << " allocations which took "
+       << watch.elapsed() << endl;
+
+  watch.start(); // Reset.
+
+  // Now every slave is filtered for every framework.
+  Clock::advance(flags.allocation_interval);
+  Clock::settle();
+
+  cout << "Allocation with " << slaveCount * frameworkCount
+       << " filters took " << watch.elapsed() << endl;
+
+  EXPECT_EQ(slaveCount * frameworkCount, declined.load());
+}
+
+
+class HierarchicalAllocatorWorkers_BENCHMARK_Test
+  : public HierarchicalAllocatorTestBase,
+    public WithParamInterface<size_t>
+{
+protected:
+  HierarchicalAllocatorWorkers_BENCHMARK_Test()
+  {
+    // Replace the allocator created by the base with one that uses
+    // the parameterized number of workers.
+    delete allocator;
+    allocator = CHECK_NOTNULL(
+        HierarchicalDRFAllocator::create(GetParam()).get());
+  }
+};
+
+
+// The sharded allocation benchmark tests are parameterized by the
+// number of allocator workers, where 0 means serial allocation.
+INSTANTIATE_TEST_CASE_P(
+    WorkerCount,
+    HierarchicalAllocatorWorkers_BENCHMARK_Test,
+    ::testing::Values(0U, 1U, 2U, 4U, 8U));
+
+
+// Measures the duration of batch allocations of all the slaves.
+TEST_P(HierarchicalAllocatorWorkers_BENCHMARK_Test, BatchAllocation)
+{
+  Clock::pause();
+
+  const size_t slaveCount = 20000;
+  const size_t frameworkCount = 200;
+  const size_t cycles = 5;
+
+  initialize({});
+
+  for (size_t i = 0; i < frameworkCount; i++) {
+    FrameworkInfo framework = createFrameworkInfo("*");
+    allocator->addFramework(framework.id(), framework, {});
+  }
+
+  for (size_t i = 0; i < slaveCount; i++) {
+    SlaveInfo slave = createSlaveInfo(
+        "cpus:2;mem:1024;disk:4096;ports:[31000-32000]");
+    allocator->addSlave(slave.id(), slave, slave.resources(), {});
+  }
+
+  // Waits until all slaves have been offered and returns the
+  // allocations.
+  auto offers = [this, slaveCount]() {
+    vector<Allocation> allocations;
+
+    size_t offered = 0;
+    while (offered < slaveCount) {
+      Future<Allocation> allocation = queue.get();
+      allocation.await();
+
+      CHECK_READY(allocation);
+
+      offered += allocation.get().resources.size();
+      allocations.push_back(allocation.get());
+    }
+
+    return allocations;
+  };
+
+  vector<Allocation> allocations = offers();
+
+  Duration total = Duration::zero();
+
+  for (size_t i = 0; i < cycles; i++) {
+    // Recover all the resources so that the next batch allocation
+    // has to allocate every slave again.
+    foreach (const Allocation& allocation, allocations) {
+      foreachpair (const SlaveID& slaveId,
+                   const Resources& resources,
+                   allocation.resources) {
+        allocator->recoverResources(
+            allocation.frameworkId, slaveId, resources, None());
+      }
+    }
+
+    Clock::settle();
+
+    Stopwatch watch;
+    watch.start();
+
+    Clock::advance(flags.allocation_interval);
+
+    allocations = offers();
+
+    total += watch.elapsed();
+  }
+
+  cout << "Allocated " << slaveCount << " slaves to " << frameworkCount
+       << " frameworks using " << GetParam() << " workers in "
+       << total / cycles << " per cycle on average" << endl;
+}
+
+
+// The large-scale allocator benchmark tests are parameterized by the
+// number of slaves and the number of frameworks. Each test sets up a
+// scenario and then measures a number of batch allocations, printing
+// the results as a JSON object on a single line (prefixed with
+// 'BENCHMARK ') so that they can be collected and compared.
+class HierarchicalAllocatorScale_BENCHMARK_Test
+  : public HierarchicalAllocatorTestBase,
+    public WithParamInterface<tuple<size_t, size_t>>
+{
+protected:
+  HierarchicalAllocatorScale_BENCHMARK_Test()
+    : slaveCount(std::get<0>(GetParam())),
+      frameworkCount(std::get<1>(GetParam())),
+      offered(0) {}
+
+  typedef lambda::function<
+      void(const FrameworkID&, const hashmap<SlaveID, Resources>&)>
+    OfferCallback;
+
+  // Initializes the allocator with the given roles and weights, the
+  // allocator calls 'respond' for each offer after counting it.
+  void initialize(
+      const hashmap<string, double>& weights,
+      const OfferCallback& respond)
+  {
+    RoleInfo info;
+    info.set_name("*");
+    roles["*"] = info;
+
+    foreachpair (const string& role, double weight, weights) {
+      info.set_name(role);
+      info.set_weight(weight);
+      roles[role] = info;
+    }
+
+    allocator->initialize(
+        flags.allocation_interval,
+        [this, respond](
+            const FrameworkID& frameworkId,
+            const hashmap<SlaveID, Resources>& resources) {
+          offered += resources.size();
+          respond(frameworkId, resources);
+        },
+        roles);
+  }
+
+  // Adds the frameworks, assigning the roles in a round-robin
+  // fashion. Every 'revocable'-th framework opts in for revocable
+  // resources (none if 0).
+  void addFrameworks(const vector<string>& names, size_t revocable = 0)
+  {
+    for (size_t i = 0; i < frameworkCount; i++) {
+      FrameworkInfo framework = createFrameworkInfo(names[i % names.size()]);
+
+      if (revocable > 0 && i % revocable == 0) {
+        framework.add_capabilities()->set_type(
+            FrameworkInfo::Capability::REVOCABLE_RESOURCES);
+      }
+
+      allocator->addFramework(framework.id(), framework, {});
+    }
+  }
+
+  void addSlaves()
+  {
+    for (size_t i = 0; i < slaveCount; i++) {
+      SlaveInfo slave = createSlaveInfo(
+          "cpus:24;mem:4096;disk:4096;ports:[31000-32000]");
+
+      allocator->addSlave(slave.id(), slave, slave.resources(), {});
+
+      slaveIds.push_back(slave.id());
+    }
+  }
+
+  // Performs 'cycles' batch allocations and prints the results.
+  void measure(const string& scenario, size_t cycles)
+  {
+    // Wait for the allocations triggered while setting up.
+    Clock::settle();
+
+    const size_t before = offered.load();
+
+    vector<Duration> durations;
+
+    Stopwatch total;
+    total.start();
+
+    for (size_t i = 0; i < cycles; i++) {
+      Stopwatch watch;
+      watch.start();
+
+      Clock::advance(flags.allocation_interval);
+      Clock::settle();
+
+      durations.push_back(watch.elapsed());
+    }
+
+    const Duration elapsed = total.elapsed();
+    const size_t offers = offered.load() - before;
+
+    std::sort(durations.begin(), durations.end());
+
+    JSON::Object result;
+    result.values["benchmark"] = scenario;
+    result.values["slaves"] = slaveCount;
+    result.values["frameworks"] = frameworkCount;
+    result.values["cycles"] = cycles;
+    result.values["cycle_ms_mean"] = (elapsed / cycles).ms();
+    result.values["cycle_ms_min"] = durations.front().ms();
+    result.values["cycle_ms_max"] = durations.back().ms();
+    result.values["offers"] = offers;
+    result.values["offers_per_second"] = offers / elapsed.secs();
+
+    Result<os::Process> process = os::process(getpid());
+    if (process.isSome() && process.get().rss.isSome()) {
+      result.values["rss_bytes"] = process.get().rss.get().bytes();
+    }
+
+    cout << "BENCHMARK " << stringify(result) << endl;
+  }
+
+  const size_t slaveCount;
+  const size_t frameworkCount;
+
+  vector<SlaveID> slaveIds;
+
+  // Number of slaves offered so far.
+  atomic<size_t> offered;
+};
+
+
+INSTANTIATE_TEST_CASE_P(
+    SlaveAndFrameworkCount,
+    HierarchicalAllocatorScale_BENCHMARK_Test,
+    ::testing::Values(
+        std::make_tuple(1000U, 100U),
+        std::make_tuple(5000U, 500U),
+        std::make_tuple(10000U, 1000U),
+        std::make_tuple(50000U, 5000U)));
+
+
+// Frameworks decline every offer with a long lived filter, so each
+// allocation has to check the filters of more and more frameworks.
+TEST_P(HierarchicalAllocatorScale_BENCHMARK_Test, DeclineOffers)
+{
+  Clock::pause();
+
+  Filters filters;
+  filters.set_refuse_seconds(Days(1).secs());
+
+  initialize(
+      hashmap<string, double>(),
+      [this, filters](
+          const FrameworkID& frameworkId,
+          const hashmap<SlaveID, Resources>& resources) {
+        foreachpair (const SlaveID& slaveId,
+                     const Resources& offered,
+                     resources) {
+          allocator->recoverResources(frameworkId, slaveId, offered, filters);
+        }
+      });
+
+  addFrameworks({"*"});
+  addSlaves();
+
+  measure("DeclineOffers", 10);
+}
+
+
+// Frameworks return all offered resources right away without
+// filtering them, so that each allocation has to allocate every slave.
+TEST_P(HierarchicalAllocatorScale_BENCHMARK_Test, RecoverResources)
+{
+  Clock::pause();
+
+  initialize(
+      hashmap<string, double>(),
+      [this](
+          const FrameworkID& frameworkId,
+          const hashmap<SlaveID, Resources>& resources) {
+        foreachpair (const SlaveID& slaveId,
+                     const Resources& offered,
+                     resources) {
+          allocator->recoverResources(frameworkId, slaveId, offered, None());
+        }
+      });
+
+  addFrameworks({"*"});
+  addSlaves();
+
+  measure("RecoverResources", 10);
+}
+
+
+// Like 'RecoverResources', but with frameworks in many roles that
+// have different weights, and with half of the resources reserved.
+TEST_P(HierarchicalAllocatorScale_BENCHMARK_Test, WeightedRoles)
+{
+  Clock::pause();
+
+  // Ten frameworks per role.
+  const size_t roleCount = std::max<size_t>(1, frameworkCount / 10);
+
+  hashmap<string, double> weights;
+  vector<string> names;
+  for (size_t i = 0; i < roleCount; i++) {
+    const string role = "role" + stringify(i);
+    weights[role] = 1 + (i % 5);
+    names.push_back(role);
+  }
+
+  initialize(
+      weights,
+      [this](
+          const FrameworkID& frameworkId,
+          const hashmap<SlaveID, Resources>& resources) {
+        foreachpair (const SlaveID& slaveId,
+                     const Resources& offered,
+                     resources) {
+          allocator->recoverResources(frameworkId, slaveId, offered, None());
+        }
+      });
+
+  addFrameworks(names);
+
+  for (size_t i = 0; i < slaveCount; i++) {
+    const string& role = names[i % names.size()];
+
+    SlaveInfo slave = createSlaveInfo(
+        "cpus:12;mem:2048;disk:2048;ports:[31000-31500];"
+        "cpus(" + role + "):12;mem(" + role + "):2048;"
+        "disk(" + role + "):2048;ports(" + role + "):[31501-32000]");
+
+    allocator->addSlave(slave.id(), slave, slave.resources(), {});
+  }
+
+  measure("WeightedRoles", 10);
+}
+
+
+// Like 'RecoverResources', but the slaves also have oversubscribed
+// resources which only some of the frameworks accept.
+TEST_P(HierarchicalAllocatorScale_BENCHMARK_Test, RevocableResources)
+{
+  Clock::pause();
+
+  initialize(
+      hashmap<string, double>(),
+      [this](
+          const FrameworkID& frameworkId,
+          const hashmap<SlaveID, Resources>& resources) {
+        foreachpair (const SlaveID& slaveId,
+                     const Resources& offered,
+                     resources) {
+          allocator->recoverResources(frameworkId, slaveId, offered, None());
+        }
+      });
+
+  // Every other framework accepts revocable resources.
+  addFrameworks({"*"}, 2);
+  addSlaves();
+
+  Resources oversubscribed = createRevocableResources("cpus", "12");
+
+  foreach (const SlaveID& slaveId, slaveIds) {
+    allocator->updateSlave(slaveId, oversubscribed);
+  }
+
+  measure("RevocableResources", 10);
+}
+
+
+// Frameworks hold on to the resources of nine out of ten slaves, and
+// return the resources of the others right away. This is what a busy
+// cluster looks like, where most of the slaves are fully allocated.
+TEST_P(HierarchicalAllocatorScale_BENCHMARK_Test, FullyAllocated)
+{
+  Clock::pause();
+
+  initialize(
+      hashmap<string, double>(),
+      [this](
+          const FrameworkID& frameworkId,
+          const hashmap<SlaveID, Resources>& resources) {
+        foreachpair (const SlaveID& slaveId,
+                     const Resources& offered,
+                     resources) {
+          if (std::hash<string>()(slaveId.value()) % 10 == 0) {
+            allocator->recoverResources(
+                frameworkId, slaveId, offered, None());
+          }
+        }
+      });
+
+  addFrameworks({"*"});
+  addSlaves();
+
+  measure("FullyAllocated", 10);
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -21,6 +21,7 @@
 #include <gmock/gmock.h>
 
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -40,18 +41,26 @@
 #include <process/metrics/counter.hpp>
 #include <process/metrics/metrics.hpp>
 
+#include <stout/base64.hpp>
 #include <stout/json.hpp>
 #include <stout/net.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
 #include <stout/strings.hpp>
 #include <stout/try.hpp>
+#include <stout/uuid.hpp>
 
 #include "common/build.hpp"
+#include "common/http.hpp"
 #include "common/protobuf_utils.hpp"
 
+#include "master/archiver.hpp"
 #include "master/flags.hpp"
+#include "master/http.pb.h"
 #include "master/master.hpp"
+#include "master/task_record.hpp"
 
 #include "slave/constants.hpp"
 #include "slave/gc.hpp"
@@ -65,7 +74,9 @@
 #include "tests/mesos.hpp"
 #include "tests/utils.hpp"
 
+using mesos::internal::master::Archiver;
 using mesos::internal::master::Master;
+using mesos::internal::master::TaskRecord;
 
 using mesos::internal::master::allocator::MesosAllocatorProcess;
 
@@ -81,6 +92,7 @@ using process::Future;
 using process::PID;
 using process::Promise;
 
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -632,6 +644,108 @@ TEST_F(MasterTest, StatusUpdateAck)
 }
 
 
+// This test verifies that the master coalesces the status updates
+// for a framework with the BATCHED_STATUS_UPDATES capability and
+// that the scheduler driver handles each of the batched updates.
+TEST_F(MasterTest, BatchedStatusUpdates)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  Try<PID<Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+
+  Try<PID<Slave>> slave = StartSlave(&exec);
+  ASSERT_SOME(slave);
+
+  FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.add_capabilities()->set_type(
+      FrameworkInfo::Capability::BATCHED_STATUS_UPDATES);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, frameworkInfo, master.get(), DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .Times(1);
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  Resources resources = Resources::parse("cpus:1;mem:256").get();
+
+  TaskInfo task1;
+  task1.set_name("");
+  task1.mutable_task_id()->set_value("1");
+  task1.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
+  task1.mutable_resources()->MergeFrom(resources);
+  task1.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+  TaskInfo task2 = task1;
+  task2.mutable_task_id()->set_value("2");
+
+  EXPECT_CALL(exec, registered(_, _, _, _))
+    .Times(1);
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillRepeatedly(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  // Pause the clock so that the batch is only sent once we advance
+  // the clock past the batch interval.
+  Clock::pause();
+
+  Future<StatusUpdateMessage> update1 =
+    FUTURE_PROTOBUF(StatusUpdateMessage(), _, Eq(master.get()));
+  Future<StatusUpdateMessage> update2 =
+    FUTURE_PROTOBUF(StatusUpdateMessage(), _, Eq(master.get()));
+
+  Future<StatusUpdatesMessage> batch =
+    FUTURE_PROTOBUF(StatusUpdatesMessage(), Eq(master.get()), _);
+
+  Future<TaskStatus> status1;
+  Future<TaskStatus> status2;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status1))
+    .WillOnce(FutureArg<1>(&status2));
+
+  driver.launchTasks(offers.get()[0].id(), {task1, task2});
+
+  AWAIT_READY(update1);
+  AWAIT_READY(update2);
+
+  Clock::settle();
+  EXPECT_TRUE(batch.isPending());
+
+  Clock::advance(masterFlags.status_update_batch_interval);
+
+  AWAIT_READY(batch);
+  ASSERT_EQ(2, batch.get().updates_size());
+
+  AWAIT_READY(status1);
+  EXPECT_EQ(TASK_RUNNING, status1.get().state());
+
+  AWAIT_READY(status2);
+  EXPECT_EQ(TASK_RUNNING, status2.get().state());
+
+  Clock::resume();
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
 TEST_F(MasterTest, RecoverResources)
 {
   Try<PID<Master>> master = StartMaster();
@@ -749,6 +863,78 @@ TEST_F(MasterTest, RecoverResources)
 }
 
 
+// This test verifies that a framework that suppressed offers does
+// not receive any, even for resources that are not filtered, until it
+// revives offers.
+TEST_F(MasterTest, SuppressOffers)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  Try<PID<Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  Try<PID<Slave>> slave = StartSlave();
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers));
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  Future<Nothing> suppressOffers =
+    FUTURE_DISPATCH(_, &MesosAllocatorProcess::suppressOffers);
+
+  driver.suppressOffers();
+
+  AWAIT_READY(suppressOffers);
+
+  Clock::pause();
+
+  // The declined resources are not filtered, but they are not offered
+  // to the framework again while it suppresses offers.
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .Times(0);
+
+  Future<Nothing> recoverResources =
+    FUTURE_DISPATCH(_, &MesosAllocatorProcess::recoverResources);
+
+  Filters filters;
+  filters.set_refuse_seconds(0);
+
+  driver.declineOffer(offers.get()[0].id(), filters);
+
+  AWAIT_READY(recoverResources);
+
+  Clock::advance(masterFlags.allocation_interval);
+  Clock::settle();
+
+  // Reviving offers lifts the suppression.
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers));
+
+  driver.reviveOffers();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  Clock::resume();
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
 TEST_F(MasterTest, FrameworkMessage)
 {
   Try<PID<Master>> master = StartMaster();
@@ -2821,128 +3007,120 @@ TEST_F(MasterTest, StateEndpoint)
 }
 
 
-TEST_F(MasterTest, StateSummaryEndpoint)
+// This test ensures that the master streams its state, one framework
+// at a time, and that the result is a well formed JSON object (or
+// JSONP callback), also when it is replayed from the cache.
+TEST_F(MasterTest, StateEndpointStreaming)
 {
-  master::Flags flags = CreateMasterFlags();
-
-  flags.hostname = "localhost";
-  flags.cluster = "test-cluster";
-
-  Try<PID<Master>> master = StartMaster(flags);
+  Try<PID<Master>> master = StartMaster();
   ASSERT_SOME(master);
 
-  MockExecutor exec(DEFAULT_EXECUTOR_ID);
-
-  Try<PID<Slave>> slave = StartSlave(&exec);
-  ASSERT_SOME(slave);
-
-  MockScheduler sched;
-  MesosSchedulerDriver driver(
-      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
-
-  EXPECT_CALL(sched, registered(&driver, _, _))
-    .Times(1);
-
-  Future<vector<Offer> > offers;
-  EXPECT_CALL(sched, resourceOffers(&driver, _))
-    .WillOnce(FutureArg<1>(&offers))
-    .WillRepeatedly(Return()); // Ignore subsequent offers.
-
-  driver.start();
+  MockScheduler sched1;
+  MesosSchedulerDriver driver1(
+      &sched1, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
 
-  AWAIT_READY(offers);
-  EXPECT_NE(0u, offers.get().size());
+  Future<Nothing> registered1;
+  EXPECT_CALL(sched1, registered(&driver1, _, _))
+    .WillOnce(FutureSatisfy(&registered1));
 
-  TaskID taskId;
-  taskId.set_value("1");
+  driver1.start();
 
-  TaskInfo task;
-  task.set_name("");
-  task.mutable_task_id()->MergeFrom(taskId);
-  task.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
-  task.mutable_resources()->MergeFrom(offers.get()[0].resources());
-  task.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+  AWAIT_READY(registered1);
 
-  EXPECT_CALL(exec, registered(_, _, _, _))
-    .Times(1);
+  MockScheduler sched2;
+  MesosSchedulerDriver driver2(
+      &sched2, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
 
-  EXPECT_CALL(exec, launchTask(_, _))
-    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+  Future<Nothing> registered2;
+  EXPECT_CALL(sched2, registered(&driver2, _, _))
+    .WillOnce(FutureSatisfy(&registered2));
 
-  Future<TaskStatus> status;
-  EXPECT_CALL(sched, statusUpdate(&driver, _))
-    .WillOnce(FutureArg<1>(&status));
+  driver2.start();
 
-  driver.launchTasks(offers.get()[0].id(), {task});
+  AWAIT_READY(registered2);
 
-  AWAIT_READY(status);
-  EXPECT_EQ(TASK_RUNNING, status.get().state());
+  Future<process::http::Response> response =
+    process::http::get(master.get(), "state.json");
 
-  EXPECT_CALL(exec, killTask(_, _))
-    .WillOnce(SendStatusUpdateFromTaskID(TASK_KILLED));
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
 
-  EXPECT_CALL(sched, statusUpdate(&driver, _))
-    .WillOnce(FutureArg<1>(&status));
+  EXPECT_SOME_EQ(
+      "chunked",
+      response.get().headers.get("Transfer-Encoding"));
 
-  driver.killTask(taskId);
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
 
-  AWAIT_READY(status);
-  EXPECT_EQ(TASK_KILLED, status.get().state());
+  JSON::Object state = parse.get();
 
-  EXPECT_CALL(exec, shutdown(_))
-    .Times(AtMost(1));
+  ASSERT_TRUE(state.values["frameworks"].is<JSON::Array>());
+  EXPECT_EQ(2u, state.values["frameworks"].as<JSON::Array>().values.size());
 
-  Future<process::http::Response> response =
-    process::http::get(master.get(), "state-summary");
+  // The state has not changed, so this response is replayed from the
+  // cache (with the JSONP padding), and still streamed.
+  response = process::http::get(master.get(), "state.json", "jsonp=callback");
 
   AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
 
   EXPECT_SOME_EQ(
-      "application/json",
+      "chunked",
+      response.get().headers.get("Transfer-Encoding"));
+
+  EXPECT_SOME_EQ(
+      "text/javascript",
       response.get().headers.get("Content-Type"));
 
-  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response.get().body);
-  ASSERT_SOME(parse);
+  string body = response.get().body;
 
-  JSON::Object state = parse.get();
+  ASSERT_TRUE(strings::startsWith(body, "callback("));
+  ASSERT_TRUE(strings::endsWith(body, ");"));
 
-  EXPECT_EQ(flags.hostname.get(), state.values["hostname"]);
+  body = strings::remove(body, "callback(", strings::PREFIX);
+  body = strings::remove(body, ");", strings::SUFFIX);
 
-  EXPECT_EQ(flags.cluster.get(), state.values["cluster"]);
+  parse = JSON::parse<JSON::Object>(body);
+  ASSERT_SOME(parse);
 
-  ASSERT_TRUE(state.values["slaves"].is<JSON::Array>());
-  ASSERT_EQ(1u, state.values["slaves"].as<JSON::Array>().values.size());
-  ASSERT_SOME_EQ(0u, state.find<JSON::Number>("slaves[0].TASK_RUNNING"));
-  ASSERT_SOME_EQ(1u, state.find<JSON::Number>("slaves[0].TASK_KILLED"));
+  EXPECT_EQ(state.values["frameworks"], parse.get().values["frameworks"]);
 
-  ASSERT_TRUE(state.values["frameworks"].is<JSON::Array>());
-  ASSERT_EQ(1u, state.values["frameworks"].as<JSON::Array>().values.size());
-  ASSERT_SOME_EQ(0u, state.find<JSON::Number>("frameworks[0].TASK_RUNNING"));
-  ASSERT_SOME_EQ(1u, state.find<JSON::Number>("frameworks[0].TASK_KILLED"));
+  driver1.stop();
+  driver1.join();
 
-  driver.stop();
-  driver.join();
+  driver2.stop();
+  driver2.join();
 
   Shutdown();
 }
 
 
-// This test ensures that the web UI and capabilities of a framework
-// are included in the state.json endpoint, if provided by the
-// framework.
-TEST_F(MasterTest, FrameworkWebUIUrlandCapabilities)
+// This test ensures that a cached state is served until it is older
+// than --max_state_staleness, even though the master state changed.
+TEST_F(MasterTest, StateEndpointStaleness)
 {
-  Try<PID<Master>> master = StartMaster();
+  master::Flags flags = CreateMasterFlags();
+  flags.max_state_staleness = Minutes(1);
+
+  Clock::pause();
+
+  Try<PID<Master>> master = StartMaster(flags);
   ASSERT_SOME(master);
 
-  FrameworkInfo framework = DEFAULT_FRAMEWORK_INFO;
-  framework.set_webui_url("http://localhost:8080/");
-  auto capabilityType = FrameworkInfo::Capability::REVOCABLE_RESOURCES;
-  framework.add_capabilities()->set_type(capabilityType);
+  Future<process::http::Response> response =
+    process::http::get(master.get(), "state.json");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  JSON::Object state = parse.get();
+
+  ASSERT_TRUE(state.values["frameworks"].is<JSON::Array>());
+  EXPECT_TRUE(state.values["frameworks"].as<JSON::Array>().values.empty());
 
   MockScheduler sched;
   MesosSchedulerDriver driver(
-      &sched, framework, master.get(), DEFAULT_CREDENTIAL);
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
 
   Future<Nothing> registered;
   EXPECT_CALL(sched, registered(&driver, _, _))
@@ -2952,14 +3130,555 @@ TEST_F(MasterTest, FrameworkWebUIUrlandCapabilities)
 
   AWAIT_READY(registered);
 
-  Future<process::http::Response> masterState =
-    process::http::get(master.get(), "state.json");
-  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, masterState);
+  // The cached state does not include the framework yet.
+  response = process::http::get(master.get(), "state.json");
 
-  Try<JSON::Object> parse = JSON::parse<JSON::Object>(masterState.get().body);
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  parse = JSON::parse<JSON::Object>(response.get().body);
   ASSERT_SOME(parse);
 
-  // We need a mutable copy of parse to use [].
+  state = parse.get();
+
+  ASSERT_TRUE(state.values["frameworks"].is<JSON::Array>());
+  EXPECT_TRUE(state.values["frameworks"].as<JSON::Array>().values.empty());
+
+  Clock::advance(flags.max_state_staleness + Seconds(1));
+
+  response = process::http::get(master.get(), "state.json");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  state = parse.get();
+
+  ASSERT_TRUE(state.values["frameworks"].is<JSON::Array>());
+  EXPECT_EQ(1u, state.values["frameworks"].as<JSON::Array>().values.size());
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+
+  Clock::resume();
+}
+
+
+// This test verifies that the state endpoint, which is served from
+// snapshots of the master's state, reflects the changes made through
+// other endpoints right away.
+TEST_F(MasterTest, StateEndpointAfterTeardown)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  driver.start();
+
+  AWAIT_READY(frameworkId);
+
+  Future<process::http::Response> response =
+    process::http::get(master.get(), "state.json");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  JSON::Object state = parse.get();
+
+  ASSERT_TRUE(state.values["frameworks"].is<JSON::Array>());
+  EXPECT_EQ(1u, state.values["frameworks"].as<JSON::Array>().values.size());
+
+  hashmap<string, string> headers;
+  headers["Authorization"] = "Basic " +
+    base64::encode(DEFAULT_CREDENTIAL.principal() +
+                   ":" + DEFAULT_CREDENTIAL.secret());
+
+  response = process::http::post(
+      master.get(),
+      "teardown",
+      headers,
+      "frameworkId=" + frameworkId.get().value());
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  response = process::http::get(master.get(), "state.json");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  state = parse.get();
+
+  ASSERT_TRUE(state.values["frameworks"].is<JSON::Array>());
+  EXPECT_TRUE(state.values["frameworks"].as<JSON::Array>().values.empty());
+
+  ASSERT_TRUE(state.values["completed_frameworks"].is<JSON::Array>());
+  EXPECT_EQ(
+      1u,
+      state.values["completed_frameworks"].as<JSON::Array>().values.size());
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
+// This test ensures that the tasks endpoint reflects the status
+// updates of a task, i.e., that the snapshots do not share the record
+// of a framework once its tasks changed.
+TEST_F(MasterTest, TasksEndpointAfterStatusUpdate)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+
+  Try<PID<Slave>> slave = StartSlave(&exec);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskInfo task = createTask(offers.get()[0], "", DEFAULT_EXECUTOR_ID);
+
+  ExecutorDriver* execDriver;
+  EXPECT_CALL(exec, registered(_, _, _, _))
+    .WillOnce(SaveArg<0>(&execDriver));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> runningStatus;
+  Future<TaskStatus> finishedStatus;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&runningStatus))
+    .WillOnce(FutureArg<1>(&finishedStatus));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(runningStatus);
+  EXPECT_EQ(TASK_RUNNING, runningStatus.get().state());
+
+  Future<process::http::Response> response =
+    process::http::get(master.get(), "tasks.json");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  EXPECT_SOME_EQ(
+      "TASK_RUNNING",
+      parse.get().find<JSON::String>("tasks[0].state"));
+
+  TaskStatus status = runningStatus.get();
+  status.set_state(TASK_FINISHED);
+
+  execDriver->sendStatusUpdate(status);
+
+  AWAIT_READY(finishedStatus);
+  EXPECT_EQ(TASK_FINISHED, finishedStatus.get().state());
+
+  response = process::http::get(master.get(), "tasks.json");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  EXPECT_SOME_EQ(
+      "TASK_FINISHED",
+      parse.get().find<JSON::String>("tasks[0].state"));
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
+// This test ensures that the state and tasks endpoints only include
+// the requested frameworks and fields.
+TEST_F(MasterTest, StateEndpointFilters)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockScheduler sched1;
+  MesosSchedulerDriver driver1(
+      &sched1, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId1;
+  EXPECT_CALL(sched1, registered(&driver1, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId1));
+
+  driver1.start();
+
+  AWAIT_READY(frameworkId1);
+
+  MockScheduler sched2;
+  MesosSchedulerDriver driver2(
+      &sched2, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId2;
+  EXPECT_CALL(sched2, registered(&driver2, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId2));
+
+  driver2.start();
+
+  AWAIT_READY(frameworkId2);
+
+  Future<process::http::Response> response = process::http::get(
+      master.get(),
+      "state.json",
+      "framework_id=" + frameworkId1.get().value() + "&fields=frameworks.id");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  Try<JSON::Value> parse = JSON::parse(response.get().body);
+  ASSERT_SOME(parse);
+
+  Try<JSON::Value> expected = JSON::parse(
+      "{"
+      "  \"frameworks\":"
+      "  ["
+      "    {\"id\":\"" + frameworkId1.get().value() + "\"}"
+      "  ]"
+      "}");
+
+  ASSERT_SOME(expected);
+  EXPECT_EQ(expected.get(), parse.get());
+
+  response = process::http::get(master.get(), "tasks.json", "state=BOGUS");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(
+      process::http::BadRequest().status,
+      response);
+
+  driver1.stop();
+  driver1.join();
+
+  driver2.stop();
+  driver2.join();
+
+  Shutdown();
+}
+
+
+// This test verifies that the state and the tasks are served as
+// protobuf messages to clients that accept 'application/x-protobuf'.
+TEST_F(MasterTest, StateEndpointProtobuf)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+
+  Try<PID<Slave>> slave = StartSlave(&exec);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  Future<vector<Offer> > offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(frameworkId);
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskInfo task = createTask(offers.get()[0], "", DEFAULT_EXECUTOR_ID);
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status.get().state());
+
+  hashmap<string, string> headers;
+  headers["Accept"] = APPLICATION_PROTOBUF;
+
+  Future<process::http::Response> response =
+    process::http::get(master.get(), "state.json", None(), headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(
+      APPLICATION_PROTOBUF,
+      "Content-Type",
+      response);
+
+  StateResponse state;
+  ASSERT_TRUE(state.ParseFromString(response.get().body));
+
+  EXPECT_EQ(MESOS_VERSION, state.version());
+  EXPECT_EQ(1u, state.activated_slaves());
+
+  ASSERT_EQ(1, state.slaves_size());
+  EXPECT_EQ(offers.get()[0].slave_id(), state.slaves(0).info().id());
+
+  ASSERT_EQ(1, state.frameworks_size());
+  EXPECT_EQ(frameworkId.get(), state.frameworks(0).info().id());
+
+  ASSERT_EQ(1, state.frameworks(0).tasks_size());
+  EXPECT_EQ(task.task_id(), state.frameworks(0).tasks(0).task_id());
+  EXPECT_EQ(TASK_RUNNING, state.frameworks(0).tasks(0).state());
+
+  ASSERT_EQ(1, state.frameworks(0).executors_size());
+  EXPECT_EQ(
+      offers.get()[0].slave_id(),
+      state.frameworks(0).executors(0).slave_id());
+
+  response = process::http::get(master.get(), "tasks.json", None(), headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  TasksResponse tasks;
+  ASSERT_TRUE(tasks.ParseFromString(response.get().body));
+
+  ASSERT_EQ(1, tasks.tasks_size());
+  EXPECT_EQ(task.task_id(), tasks.tasks(0).task_id());
+  EXPECT_NE(0, tasks.tasks(0).resources_size());
+
+  // Only the selected fields of the tasks are included, along with
+  // their required fields.
+  response = process::http::get(
+      master.get(), "tasks.json", "fields=id,statuses", headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  ASSERT_TRUE(tasks.ParseFromString(response.get().body));
+
+  ASSERT_EQ(1, tasks.tasks_size());
+  EXPECT_EQ(task.task_id(), tasks.tasks(0).task_id());
+  EXPECT_EQ(TASK_RUNNING, tasks.tasks(0).state());
+  EXPECT_EQ(1, tasks.tasks(0).statuses_size());
+  EXPECT_EQ(0, tasks.tasks(0).resources_size());
+
+  response = process::http::get(
+      master.get(), "tasks.json", "fields=id,statuses.state");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  Try<JSON::Value> parse = JSON::parse(response.get().body);
+  ASSERT_SOME(parse);
+
+  Try<JSON::Value> expected = JSON::parse(
+      "{"
+      "  \"tasks\":"
+      "  ["
+      "    {"
+      "      \"id\":\"" + task.task_id().value() + "\","
+      "      \"statuses\":[{\"state\":\"TASK_RUNNING\"}]"
+      "    }"
+      "  ]"
+      "}");
+
+  ASSERT_SOME(expected);
+  EXPECT_EQ(expected.get(), parse.get());
+
+  // JSON is still served by default.
+  response = process::http::get(master.get(), "tasks.json");
+
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(
+      APPLICATION_JSON,
+      "Content-Type",
+      response);
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
+TEST_F(MasterTest, StateSummaryEndpoint)
+{
+  master::Flags flags = CreateMasterFlags();
+
+  flags.hostname = "localhost";
+  flags.cluster = "test-cluster";
+
+  Try<PID<Master>> master = StartMaster(flags);
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+
+  Try<PID<Slave>> slave = StartSlave(&exec);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .Times(1);
+
+  Future<vector<Offer> > offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskID taskId;
+  taskId.set_value("1");
+
+  TaskInfo task;
+  task.set_name("");
+  task.mutable_task_id()->MergeFrom(taskId);
+  task.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
+  task.mutable_resources()->MergeFrom(offers.get()[0].resources());
+  task.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+  EXPECT_CALL(exec, registered(_, _, _, _))
+    .Times(1);
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status.get().state());
+
+  EXPECT_CALL(exec, killTask(_, _))
+    .WillOnce(SendStatusUpdateFromTaskID(TASK_KILLED));
+
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.killTask(taskId);
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_KILLED, status.get().state());
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  Future<process::http::Response> response =
+    process::http::get(master.get(), "state-summary");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  EXPECT_SOME_EQ(
+      "application/json",
+      response.get().headers.get("Content-Type"));
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  JSON::Object state = parse.get();
+
+  EXPECT_EQ(flags.hostname.get(), state.values["hostname"]);
+
+  EXPECT_EQ(flags.cluster.get(), state.values["cluster"]);
+
+  ASSERT_TRUE(state.values["slaves"].is<JSON::Array>());
+  ASSERT_EQ(1u, state.values["slaves"].as<JSON::Array>().values.size());
+  ASSERT_SOME_EQ(0u, state.find<JSON::Number>("slaves[0].TASK_RUNNING"));
+  ASSERT_SOME_EQ(1u, state.find<JSON::Number>("slaves[0].TASK_KILLED"));
+
+  ASSERT_TRUE(state.values["frameworks"].is<JSON::Array>());
+  ASSERT_EQ(1u, state.values["frameworks"].as<JSON::Array>().values.size());
+  ASSERT_SOME_EQ(0u, state.find<JSON::Number>("frameworks[0].TASK_RUNNING"));
+  ASSERT_SOME_EQ(1u, state.find<JSON::Number>("frameworks[0].TASK_KILLED"));
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
+// This test ensures that the web UI and capabilities of a framework
+// are included in the state.json endpoint, if provided by the
+// framework.
+TEST_F(MasterTest, FrameworkWebUIUrlandCapabilities)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  FrameworkInfo framework = DEFAULT_FRAMEWORK_INFO;
+  framework.set_webui_url("http://localhost:8080/");
+  auto capabilityType = FrameworkInfo::Capability::REVOCABLE_RESOURCES;
+  framework.add_capabilities()->set_type(capabilityType);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, framework, master.get(), DEFAULT_CREDENTIAL);
+
+  Future<Nothing> registered;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureSatisfy(&registered));
+
+  driver.start();
+
+  AWAIT_READY(registered);
+
+  Future<process::http::Response> masterState =
+    process::http::get(master.get(), "state.json");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, masterState);
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(masterState.get().body);
+  ASSERT_SOME(parse);
+
+  // We need a mutable copy of parse to use [].
   JSON::Object masterStateObject = parse.get();
 
   EXPECT_EQ(1u, masterStateObject.values.count("frameworks"));
@@ -3549,6 +4268,249 @@ TEST_F(MasterTest, MasterFailoverLongLivedExecutor)
   Shutdown(); // Must shutdown before 'containerizer' gets deallocated.
 }
 
+// This test verifies that completed tasks and frameworks are archived
+// when --archive_dir is set, even if they are no longer kept in memory.
+TEST_F(MasterTest, ArchivedTasks)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.archive_dir = path::join(os::getcwd(), "archive");
+  masterFlags.max_completed_tasks_per_framework = 0;
+
+  Try<PID<Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+
+  Try<PID<Slave>> slave = StartSlave(&exec);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(frameworkId);
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  // Launch two tasks, so that they can be listed one page at a time.
+  const Resources resources = Resources::parse("cpus:1;mem:128").get();
+
+  TaskInfo task1 = createTask(
+      offers.get()[0].slave_id(), resources, "", DEFAULT_EXECUTOR_ID);
+
+  TaskInfo task2 = createTask(
+      offers.get()[0].slave_id(), resources, "", DEFAULT_EXECUTOR_ID);
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillRepeatedly(SendStatusUpdateFromTask(TASK_FINISHED));
+
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .Times(2);
+
+  // The tasks are archived once their updates are acknowledged.
+  Future<Nothing> addTask1 = FUTURE_DISPATCH(_, &Archiver::addTask);
+  Future<Nothing> addTask2 = FUTURE_DISPATCH(_, &Archiver::addTask);
+
+  driver.launchTasks(offers.get()[0].id(), {task1, task2});
+
+  AWAIT_READY(addTask1);
+  AWAIT_READY(addTask2);
+
+  // The completed task is not kept in memory.
+  Future<process::http::Response> response =
+    process::http::get(master.get(), "tasks.json");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  Result<JSON::Array> tasks = parse.get().find<JSON::Array>("tasks");
+  ASSERT_SOME(tasks);
+  EXPECT_TRUE(tasks.get().values.empty());
+
+  response = process::http::get(
+      master.get(),
+      "archived_tasks",
+      "framework_id=" + frameworkId.get().value());
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  tasks = parse.get().find<JSON::Array>("tasks");
+  ASSERT_SOME(tasks);
+  EXPECT_EQ(2u, tasks.get().values.size());
+
+  // There are no more tasks than the page.
+  EXPECT_NONE(parse.get().find<JSON::Number>("next"));
+
+  // Follow the cursor through pages of a single task.
+  set<string> taskIds;
+  string query = "framework_id=" + frameworkId.get().value() + "&limit=1";
+
+  for (int page = 0; page < 2; page++) {
+    response = process::http::get(master.get(), "archived_tasks", query);
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+    parse = JSON::parse<JSON::Object>(response.get().body);
+    ASSERT_SOME(parse);
+
+    tasks = parse.get().find<JSON::Array>("tasks");
+    ASSERT_SOME(tasks);
+    ASSERT_EQ(1u, tasks.get().values.size());
+
+    Result<JSON::String> id = parse.get().find<JSON::String>("tasks[0].id");
+    ASSERT_SOME(id);
+    taskIds.insert(id.get().value);
+
+    EXPECT_SOME_EQ(
+        JSON::String("TASK_FINISHED"),
+        parse.get().find<JSON::String>("tasks[0].state"));
+
+    Result<JSON::Number> next = parse.get().find<JSON::Number>("next");
+
+    if (page == 0) {
+      ASSERT_SOME(next);
+      query = "framework_id=" + frameworkId.get().value() +
+              "&limit=1&before=" + stringify(next.get().value);
+    } else {
+      // The last page has no cursor.
+      EXPECT_NONE(next);
+    }
+  }
+
+  EXPECT_EQ(set<string>({task1.task_id().value(), task2.task_id().value()}),
+            taskIds);
+
+  // An empty page would never advance the cursor.
+  response = process::http::get(master.get(), "archived_tasks", "limit=0");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::BadRequest().status, response);
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  Future<Nothing> addFramework = FUTURE_DISPATCH(_, &Archiver::addFramework);
+
+  driver.stop();
+  driver.join();
+
+  AWAIT_READY(addFramework);
+
+  response = process::http::get(master.get(), "archived_frameworks");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+
+  parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  EXPECT_SOME_EQ(
+      JSON::String(frameworkId.get().value()),
+      parse.get().find<JSON::String>("frameworks[0].id"));
+
+  Shutdown();
+}
+
+
+// This test verifies that task records expand to the task they were
+// created from and that they share the values that are the same
+// across tasks.
+TEST(TaskRecordTest, Interned)
+{
+  Task task1;
+  task1.set_name("task");
+  task1.mutable_task_id()->set_value("1");
+  task1.mutable_framework_id()->set_value("framework");
+  task1.mutable_executor_id()->set_value("executor");
+  task1.mutable_slave_id()->set_value("slave");
+  task1.set_state(TASK_RUNNING);
+  task1.mutable_resources()->CopyFrom(
+      Resources::parse("cpus:1;mem:128").get());
+  task1.mutable_labels()->add_labels()->CopyFrom(
+      protobuf::createLabel("key", "value"));
+  task1.add_statuses()->set_state(TASK_RUNNING);
+  task1.mutable_statuses(0)->mutable_task_id()->set_value("1");
+  task1.mutable_statuses(0)->set_healthy(true);
+  task1.set_status_update_state(TASK_RUNNING);
+  task1.set_status_update_uuid(UUID::random().toBytes());
+
+  Task task2 = task1;
+  task2.mutable_task_id()->set_value("2");
+  task2.mutable_statuses(0)->mutable_task_id()->set_value("2");
+
+  TaskRecord record1(task1);
+  TaskRecord record2(task2);
+
+  EXPECT_EQ(task1, record1.task());
+  EXPECT_EQ(task2, record2.task());
+
+  EXPECT_SOME_TRUE(record1.health());
+
+  // The values that are the same across the tasks are shared.
+  EXPECT_EQ(&record1.framework_id(), &record2.framework_id());
+  EXPECT_EQ(&record1.executor_id(), &record2.executor_id());
+  EXPECT_EQ(&record1.slave_id(), &record2.slave_id());
+  EXPECT_EQ(&record1.resources(), &record2.resources());
+  EXPECT_EQ(&record1.labels(), &record2.labels());
+
+  // Tasks with different values do not share them.
+  Task task3 = task1;
+  task3.mutable_resources()->CopyFrom(
+      Resources::parse("cpus:2;mem:128").get());
+
+  TaskRecord record3(task3);
+
+  EXPECT_EQ(task3, record3.task());
+  EXPECT_NE(&record1.resources(), &record3.resources());
+  EXPECT_EQ(&record1.framework_id(), &record3.framework_id());
+}
+
+
+// This test verifies that the expanded task of a record is shared
+// until the record changes, so that the master's snapshots only
+// expand the tasks that changed since the last snapshot.
+TEST(TaskRecordTest, Expand)
+{
+  Task task;
+  task.set_name("task");
+  task.mutable_task_id()->set_value("1");
+  task.mutable_framework_id()->set_value("framework");
+  task.mutable_slave_id()->set_value("slave");
+  task.set_state(TASK_STAGING);
+
+  TaskRecord record(task);
+
+  std::shared_ptr<const Task> expanded = record.expand();
+
+  EXPECT_EQ(task, *expanded);
+  EXPECT_EQ(expanded, record.expand());
+
+  record.set_state(TASK_RUNNING);
+  record.add_statuses()->set_state(TASK_RUNNING);
+
+  EXPECT_NE(expanded, record.expand());
+  EXPECT_EQ(record.task(), *record.expand());
+
+  // The earlier expansion is not modified.
+  EXPECT_EQ(task, *expanded);
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -1071,6 +1071,12 @@ ACTION_P(InvokeReviveOffers, allocator)
 }
 
 
+ACTION_P(InvokeSuppressOffers, allocator)
+{
+  allocator->real->suppressOffers(arg0);
+}
+
+
 template <typename T = master::allocator::HierarchicalDRFAllocator>
 mesos::master::allocator::Allocator* createAllocator()
 {
@@ -1182,6 +1188,11 @@ public:
       .WillByDefault(InvokeReviveOffers(this));
     EXPECT_CALL(*this, reviveOffers(_))
       .WillRepeatedly(DoDefault());
+
+    ON_CALL(*this, suppressOffers(_))
+      .WillByDefault(InvokeSuppressOffers(this));
+    EXPECT_CALL(*this, suppressOffers(_))
+      .WillRepeatedly(DoDefault());
   }
 
   virtual ~TestAllocator() {}
@@ -1254,6 +1265,8 @@ public:
 
   MOCK_METHOD1(reviveOffers, void(const FrameworkID&));
 
+  MOCK_METHOD1(suppressOffers, void(const FrameworkID&));
+
   process::Owned<mesos::master::allocator::Allocator> real;
 };
 
@@ -141,6 +141,62 @@ TEST_F(PartitionTest, PartitionedSlave)
 }
 
 
+// This test checks that the health checks of multiple slaves are
+// driven by the same timer, and that all of the partitioned slaves
+// are shut down once they have missed 'max_slave_ping_timeouts'
+// pings.
+TEST_F(PartitionTest, PartitionedSlaves)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  Try<PID<Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  // Drop all the PONGs to simulate the partition of both slaves.
+  DROP_MESSAGES(Eq("PONG"), _, _);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage1 =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), master.get(), _);
+
+  Try<PID<Slave>> slave1 = StartSlave();
+  ASSERT_SOME(slave1);
+
+  AWAIT_READY(slaveRegisteredMessage1);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage2 =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), master.get(), _);
+
+  Try<PID<Slave>> slave2 = StartSlave();
+  ASSERT_SOME(slave2);
+
+  AWAIT_READY(slaveRegisteredMessage2);
+
+  Clock::pause();
+
+  Future<ShutdownMessage> shutdown1 =
+    FUTURE_PROTOBUF(ShutdownMessage(), master.get(), slave1.get());
+  Future<ShutdownMessage> shutdown2 =
+    FUTURE_PROTOBUF(ShutdownMessage(), master.get(), slave2.get());
+
+  // Both slaves were pinged when they registered, so each advance
+  // times out a ping of each slave.
+  for (size_t i = 0; i < masterFlags.max_slave_ping_timeouts; i++) {
+    Clock::advance(masterFlags.slave_ping_timeout);
+    Clock::settle();
+  }
+
+  AWAIT_READY(shutdown1);
+  AWAIT_READY(shutdown2);
+
+  JSON::Object stats = Metrics();
+  EXPECT_EQ(2, stats.values["master/slave_shutdowns_scheduled"]);
+  EXPECT_EQ(2, stats.values["master/slave_shutdowns_completed"]);
+
+  Shutdown();
+
+  Clock::resume();
+}
+
+
 // The purpose of this test is to ensure that when slaves are removed
 // from the master, and then attempt to re-register, we deny the
 // re-registration by sending a ShutdownMessage to the slave.
@@ -158,8 +214,8 @@ TEST_F(PartitionTest, PartitionedSlaveReregistration)
 
   // Allow the master to PING the slave, but drop all PONG messages
   // from the slave. Note that we don't match on the master / slave
-  // PIDs because it's actually the SlaveObserver Process that sends
-  // the pings.
+  // PIDs because it's actually the SlaveHealthChecker Process that
+  // sends the pings.
   Future<Message> ping = FUTURE_MESSAGE(Eq("PING"), _, _);
   DROP_MESSAGES(Eq("PONG"), _, _);
 
@@ -307,8 +363,8 @@ TEST_F(PartitionTest, PartitionedSlaveStatusUpdates)
 
   // Allow the master to PING the slave, but drop all PONG messages
   // from the slave. Note that we don't match on the master / slave
-  // PIDs because it's actually the SlaveObserver Process that sends
-  // the pings.
+  // PIDs because it's actually the SlaveHealthChecker Process that
+  // sends the pings.
   Future<Message> ping = FUTURE_MESSAGE(Eq("PING"), _, _);
   DROP_MESSAGES(Eq("PONG"), _, _);
 
@@ -425,8 +481,8 @@ TEST_F(PartitionTest, PartitionedSlaveExitedExecutor)
 
   // Allow the master to PING the slave, but drop all PONG messages
   // from the slave. Note that we don't match on the master / slave
-  // PIDs because it's actually the SlaveObserver Process that sends
-  // the pings.
+  // PIDs because it's actually the SlaveHealthChecker Process that
+  // sends the pings.
   Future<Message> ping = FUTURE_MESSAGE(Eq("PING"), _, _);
   DROP_MESSAGES(Eq("PONG"), _, _);
 
@@ -21,6 +21,7 @@
 
 #include <gmock/gmock.h>
 
+#include <iostream>
 #include <vector>
 
 #include <mesos/mesos.hpp>
@@ -33,6 +34,10 @@
 #include <process/pid.hpp>
 #include <process/process.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/nothing.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
 #include <stout/uuid.hpp>
 
 #include "common/protobuf_utils.hpp"
@@ -54,14 +59,18 @@ using process::Future;
 using process::PID;
 using process::Promise;
 
+using std::cout;
+using std::endl;
 using std::vector;
 
 using testing::_;
 using testing::An;
 using testing::AtMost;
 using testing::DoAll;
+using testing::InvokeWithoutArgs;
 using testing::Return;
 using testing::SaveArg;
+using testing::WithParamInterface;
 
 namespace mesos {
 namespace internal {
@@ -892,6 +901,234 @@ TEST_F(ReconciliationTest, ReconcileStatusUpdateTaskState)
   Shutdown(); // Must shutdown before the detector gets de-allocated.
 }
 
+
+// This test verifies that the reconciliation replies for a framework
+// with the BATCHED_STATUS_UPDATES capability are packed into a
+// single message, without waiting for the batch interval.
+TEST_F(ReconciliationTest, BatchedReplies)
+{
+  Try<PID<Master> > master = StartMaster();
+  ASSERT_SOME(master);
+
+  FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.add_capabilities()->set_type(
+      FrameworkInfo::Capability::BATCHED_STATUS_UPDATES);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+    &sched, frameworkInfo, master.get(), DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  driver.start();
+
+  // Wait until the framework is registered.
+  AWAIT_READY(frameworkId);
+
+  // Pause the clock to ensure the replies are not held back until
+  // the batch interval elapses.
+  Clock::pause();
+
+  Future<StatusUpdatesMessage> replies =
+    FUTURE_PROTOBUF(StatusUpdatesMessage(), master.get(), _);
+
+  Future<TaskStatus> update1;
+  Future<TaskStatus> update2;
+  Future<TaskStatus> update3;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&update1))
+    .WillOnce(FutureArg<1>(&update2))
+    .WillOnce(FutureArg<1>(&update3));
+
+  vector<TaskStatus> statuses;
+
+  // Create task statuses with random task ids for an unknown slave.
+  for (int i = 0; i < 3; i++) {
+    TaskStatus status;
+    status.mutable_task_id()->set_value(UUID::random().toString());
+    status.set_state(TASK_RUNNING);
+
+    statuses.push_back(status);
+  }
+
+  driver.reconcileTasks(statuses);
+
+  AWAIT_READY(replies);
+  ASSERT_EQ(3, replies.get().updates_size());
+
+  // The replies are in the order of the reconciled tasks.
+  AWAIT_READY(update1);
+  EXPECT_EQ(statuses[0].task_id(), update1.get().task_id());
+  EXPECT_EQ(TASK_LOST, update1.get().state());
+
+  AWAIT_READY(update2);
+  EXPECT_EQ(statuses[1].task_id(), update2.get().task_id());
+  EXPECT_EQ(TASK_LOST, update2.get().state());
+
+  AWAIT_READY(update3);
+  EXPECT_EQ(statuses[2].task_id(), update3.get().task_id());
+  EXPECT_EQ(TASK_LOST, update3.get().state());
+
+  Clock::resume();
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
+// This test verifies that the reconciliation replies are batched
+// even if the master does not batch the status updates it forwards.
+TEST_F(ReconciliationTest, BatchedRepliesWithoutUpdateBatching)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.status_update_batch_interval = Seconds(0);
+
+  Try<PID<Master> > master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.add_capabilities()->set_type(
+      FrameworkInfo::Capability::BATCHED_STATUS_UPDATES);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+    &sched, frameworkInfo, master.get(), DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  driver.start();
+
+  // Wait until the framework is registered.
+  AWAIT_READY(frameworkId);
+
+  Future<StatusUpdatesMessage> replies =
+    FUTURE_PROTOBUF(StatusUpdatesMessage(), master.get(), _);
+
+  Future<TaskStatus> update1;
+  Future<TaskStatus> update2;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&update1))
+    .WillOnce(FutureArg<1>(&update2));
+
+  vector<TaskStatus> statuses;
+
+  // Create task statuses with random task ids for an unknown slave.
+  for (int i = 0; i < 2; i++) {
+    TaskStatus status;
+    status.mutable_task_id()->set_value(UUID::random().toString());
+    status.set_state(TASK_RUNNING);
+
+    statuses.push_back(status);
+  }
+
+  driver.reconcileTasks(statuses);
+
+  AWAIT_READY(replies);
+  EXPECT_EQ(2, replies.get().updates_size());
+
+  AWAIT_READY(update1);
+  AWAIT_READY(update2);
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
+class Reconciliation_BENCHMARK_Test
+  : public MesosTest,
+    public WithParamInterface<size_t> {};
+
+
+// The reconciliation benchmark tests are parameterized by the number
+// of tasks that are reconciled.
+INSTANTIATE_TEST_CASE_P(
+    TaskCount,
+    Reconciliation_BENCHMARK_Test,
+    ::testing::Values(10000U, 100000U, 500000U));
+
+
+// Measures how long it takes until a framework has received the
+// replies to the explicit reconciliation of tasks that are unknown
+// to the master, once with one reply per message and once with
+// batched replies.
+TEST_P(Reconciliation_BENCHMARK_Test, ExplicitUnknownTasks)
+{
+  Try<PID<Master> > master = StartMaster();
+  ASSERT_SOME(master);
+
+  const size_t taskCount = GetParam();
+
+  vector<TaskStatus> statuses;
+  statuses.reserve(taskCount);
+
+  for (size_t i = 0; i < taskCount; i++) {
+    TaskStatus status;
+    status.mutable_task_id()->set_value(stringify(i));
+    status.set_state(TASK_RUNNING);
+
+    statuses.push_back(status);
+  }
+
+  const bool batchedReplies[] = {false, true};
+
+  foreach (bool batched, batchedReplies) {
+    FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+    if (batched) {
+      frameworkInfo.add_capabilities()->set_type(
+          FrameworkInfo::Capability::BATCHED_STATUS_UPDATES);
+    }
+
+    MockScheduler sched;
+    MesosSchedulerDriver driver(
+      &sched, frameworkInfo, master.get(), DEFAULT_CREDENTIAL);
+
+    Future<FrameworkID> frameworkId;
+    EXPECT_CALL(sched, registered(&driver, _, _))
+      .WillOnce(FutureArg<1>(&frameworkId));
+
+    EXPECT_CALL(sched, resourceOffers(&driver, _))
+      .WillRepeatedly(Return()); // Ignore offers.
+
+    driver.start();
+
+    AWAIT_READY(frameworkId);
+
+    // The scheduler callbacks are serialized by the driver.
+    size_t updates = 0;
+    Promise<Nothing> received;
+    EXPECT_CALL(sched, statusUpdate(&driver, _))
+      .WillRepeatedly(InvokeWithoutArgs([&]() {
+        if (++updates == taskCount) {
+          received.set(Nothing());
+        }
+      }));
+
+    Stopwatch watch;
+    watch.start();
+
+    driver.reconcileTasks(statuses);
+
+    AWAIT_READY_FOR(received.future(), Minutes(10));
+
+    cout << "Reconciled " << taskCount << " tasks "
+         << (batched ? "with" : "without") << " batched replies in "
+         << watch.elapsed() << endl;
+
+    driver.stop();
+    driver.join();
+  }
+
+  Shutdown();
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -86,6 +86,7 @@ using state::LogStorage;
 using state::Storage;
 
 using state::protobuf::State;
+using state::protobuf::Variable;
 
 // TODO(xujyan): This class copies code from LogStateTest. It would
 // be nice to find a common location for log related base tests when
@@ -351,6 +352,92 @@ TEST_P(RegistrarTest, Bootstrap)
 }
 
 
+TEST_P(RegistrarTest, Journal)
+{
+  flags.registry_max_journal_entries = 2;
+
+  vector<SlaveInfo> infos;
+  for (int i = 1; i <= 5; i++) {
+    SlaveInfo info;
+    info.set_hostname("localhost");
+    info.mutable_id()->set_value(stringify(i));
+    infos.push_back(info);
+  }
+
+  // Run 1 admits the slaves and removes some of them, which stores a
+  // snapshot whenever the journal is full.
+  {
+    Registrar registrar(flags, state);
+    AWAIT_READY(registrar.recover(master));
+
+    foreach (const SlaveInfo& info, infos) {
+      AWAIT_EQ(true, registrar.apply(Owned<Operation>(new AdmitSlave(info))));
+    }
+
+    AWAIT_EQ(true,
+             registrar.apply(Owned<Operation>(new RemoveSlave(infos[1]))));
+    AWAIT_EQ(true,
+             registrar.apply(Owned<Operation>(new RemoveSlave(infos[3]))));
+  }
+
+  // A snapshot that was stored by a master that failed over before
+  // switching the journal over to it.
+  Future<Variable<Registry>> orphan =
+    state->fetch<Registry>("registry_snapshot_orphan");
+  AWAIT_READY(orphan);
+  AWAIT_READY(state->store(orphan.get().mutate(Registry())));
+
+  // Run 2 replays the journal, and expunges the orphaned snapshot.
+  {
+    Registrar registrar(flags, state);
+
+    Future<Registry> registry = registrar.recover(master);
+    AWAIT_READY(registry);
+
+    ASSERT_EQ(3, registry.get().slaves().slaves().size());
+    EXPECT_EQ(infos[0], registry.get().slaves().slaves(0).info());
+    EXPECT_EQ(infos[2], registry.get().slaves().slaves(1).info());
+    EXPECT_EQ(infos[4], registry.get().slaves().slaves(2).info());
+
+    Future<set<string>> names = state->names();
+    AWAIT_READY(names);
+    EXPECT_EQ(0u, names.get().count("registry_snapshot_orphan"));
+
+    AWAIT_EQ(true,
+             registrar.apply(Owned<Operation>(new RemoveSlave(infos[0]))));
+  }
+
+  flags.registry_max_journal_entries = 0;
+
+  // Run 3 stores the registry as a whole again once journaling is
+  // turned off.
+  {
+    Registrar registrar(flags, state);
+
+    Future<Registry> registry = registrar.recover(master);
+    AWAIT_READY(registry);
+
+    ASSERT_EQ(2, registry.get().slaves().slaves().size());
+    EXPECT_EQ(infos[2], registry.get().slaves().slaves(0).info());
+    EXPECT_EQ(infos[4], registry.get().slaves().slaves(1).info());
+
+    AWAIT_EQ(true,
+             registrar.apply(Owned<Operation>(new RemoveSlave(infos[2]))));
+  }
+
+  // Run 4 recovers the registry that was stored as a whole.
+  {
+    Registrar registrar(flags, state);
+
+    Future<Registry> registry = registrar.recover(master);
+    AWAIT_READY(registry);
+
+    ASSERT_EQ(1, registry.get().slaves().slaves().size());
+    EXPECT_EQ(infos[4], registry.get().slaves().slaves(0).info());
+  }
+}
+
+
 class MockStorage : public Storage
 {
 public:
@@ -400,7 +487,10 @@ TEST_P(RegistrarTest, StoreTimeout)
   Registrar registrar(flags, &state);
 
   EXPECT_CALL(storage, get(_))
-    .WillOnce(Return(None()));
+    .WillRepeatedly(Return(None())); // The journal and the registry.
+
+  EXPECT_CALL(storage, names())
+    .WillRepeatedly(Return(std::set<string>()));
 
   Future<Nothing> set;
   EXPECT_CALL(storage, set(_, _))
@@ -430,7 +520,10 @@ TEST_P(RegistrarTest, Abort)
   Registrar registrar(flags, &state);
 
   EXPECT_CALL(storage, get(_))
-    .WillOnce(Return(None()));
+    .WillRepeatedly(Return(None())); // The journal and the registry.
+
+  EXPECT_CALL(storage, names())
+    .WillRepeatedly(Return(std::set<string>()));
 
   EXPECT_CALL(storage, set(_, _))
     .WillOnce(Return(Future<bool>(true)))              // Recovery.
@@ -447,6 +540,39 @@ TEST_P(RegistrarTest, Abort)
 }
 
 
+// Counts the bytes that are written to the underlying storage.
+class CountingStorage : public Storage
+{
+public:
+  explicit CountingStorage(Storage* _storage)
+    : storage(_storage), written(0) {}
+
+  virtual Future<Option<Entry> > get(const string& name)
+  {
+    return storage->get(name);
+  }
+
+  virtual Future<bool> set(const Entry& entry, const UUID& uuid)
+  {
+    written += entry.value().size();
+    return storage->set(entry, uuid);
+  }
+
+  virtual Future<bool> expunge(const Entry& entry)
+  {
+    return storage->expunge(entry);
+  }
+
+  virtual Future<std::set<string> > names()
+  {
+    return storage->names();
+  }
+
+  Storage* storage;
+  Bytes written;
+};
+
+
 class Registrar_BENCHMARK_Test : public RegistrarTestBase,
                                  public WithParamInterface<size_t>
 {};
@@ -461,7 +587,10 @@ INSTANTIATE_TEST_CASE_P(
 
 TEST_P(Registrar_BENCHMARK_Test, Performance)
 {
-  Registrar registrar(flags, state);
+  CountingStorage counting(storage);
+  State state(&counting);
+
+  Registrar registrar(flags, &state);
   AWAIT_READY(registrar.recover(master));
 
   vector<SlaveInfo> infos;
@@ -506,8 +635,41 @@ TEST_P(Registrar_BENCHMARK_Test, Performance)
   AWAIT_READY_FOR(result, Minutes(5));
   LOG(INFO) << "Readmitted " << slaveCount << " slaves in " << watch.elapsed();
 
+  // Admit a few more slaves one at a time (same as in production) to
+  // measure how many bytes are written per update, first with the
+  // whole registry being stored and then with journaling.
+  const size_t updates = 100;
+
+  counting.written = 0;
+  watch.start();
+  for (size_t i = 0; i < updates; ++i) {
+    SlaveInfo info = infos[0];
+    info.mutable_id()->set_value(
+        std::string("201310101659-2280333834-5050-48574-") + stringify(i));
+    AWAIT_READY(registrar.apply(Owned<Operation>(new AdmitSlave(info))));
+  }
+  cout << "Admitted " << updates << " slaves one at a time in "
+       << watch.elapsed() << ", writing " << counting.written << endl;
+
+  Flags journaling = flags;
+  journaling.registry_max_journal_entries = 50;
+
+  Registrar registrar1(journaling, &state);
+  AWAIT_READY(registrar1.recover(master));
+
+  counting.written = 0;
+  watch.start();
+  for (size_t i = 0; i < updates; ++i) {
+    SlaveInfo info = infos[0];
+    info.mutable_id()->set_value(
+        std::string("201310101700-2280333834-5050-48574-") + stringify(i));
+    AWAIT_READY(registrar1.apply(Owned<Operation>(new AdmitSlave(info))));
+  }
+  cout << "Admitted " << updates << " slaves one at a time with journaling"
+       << " in " << watch.elapsed() << ", writing " << counting.written << endl;
+
   // Recover slaves.
-  Registrar registrar2(flags, state);
+  Registrar registrar2(flags, &state);
   watch.start();
   MasterInfo info;
   info.set_id("master");
@@ -16,26 +16,39 @@
  * limitations under the License.
  */
 
+#include <iostream>
 #include <set>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include <stout/bytes.hpp>
 #include <stout/gtest.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
 
 #include "master/master.hpp"
 
+#include "master/allocator/compact.hpp"
+
 #include "tests/mesos.hpp"
 
 using namespace mesos::internal::master;
 
+using mesos::internal::master::allocator::CompactResources;
+
+using std::cout;
+using std::endl;
 using std::map;
 using std::ostringstream;
 using std::pair;
 using std::set;
 using std::string;
+using std::vector;
+
+using testing::WithParamInterface;
 
 namespace mesos {
 namespace internal {
@@ -1372,6 +1385,350 @@ TEST(RevocableResourceTest, Filter)
   EXPECT_EQ(r1, (r1 + r2).revocable());
 }
 
+
+// This test verifies that arithmetic on resources with many distinct
+// reservations and persistent volumes combines and removes the same
+// Resource objects as arithmetic on a few of them.
+TEST(ResourcesTest, ArithmeticManyResources)
+{
+  Resources reserved;
+  Resources volumes;
+
+  for (int i = 0; i < 100; i++) {
+    const string role = "role" + stringify(i % 10);
+
+    reserved += createReservedResource(
+        "cpus", "1", role, createReservationInfo("principal" + stringify(i)));
+
+    volumes += createDiskResource("1", role, "id" + stringify(i), "path");
+  }
+
+  EXPECT_EQ(100, reserved.end() - reserved.begin());
+  EXPECT_EQ(100, volumes.end() - volumes.begin());
+
+  Resources total = reserved + volumes;
+
+  // Adding the same reservations again merges them.
+  total += reserved;
+  EXPECT_EQ(200, total.end() - total.begin());
+  EXPECT_SOME_EQ(200.0, total.cpus());
+
+  EXPECT_TRUE(total.contains(reserved + reserved + volumes));
+  EXPECT_FALSE(total.contains(reserved + reserved + reserved));
+
+  // Persistent volumes are never merged, and a volume is only
+  // contained once unless it was added twice.
+  EXPECT_FALSE(total.contains(volumes + volumes));
+
+  total += volumes;
+  EXPECT_EQ(300, total.end() - total.begin());
+  EXPECT_TRUE(total.contains(volumes + volumes));
+
+  total -= volumes;
+  EXPECT_EQ(200, total.end() - total.begin());
+
+  total -= reserved;
+  EXPECT_EQ(reserved + volumes, total);
+
+  total -= reserved + volumes;
+  EXPECT_TRUE(total.empty());
+
+  // Subtracting resources that are not present is a no-op.
+  Resources unreserved = Resources::parse("cpus:1;mem:10").get();
+  EXPECT_EQ(unreserved, unreserved - reserved);
+  EXPECT_EQ(reserved, reserved - volumes);
+}
+
+
+// This test verifies that the overloads for rvalues, which work in
+// place, behave like the ones that copy.
+TEST(ResourcesTest, Rvalues)
+{
+  Resources reserved = createReservedResource(
+      "cpus", "2", "role", createReservationInfo("principal"));
+
+  Resources revocable = createRevocableResource("mem", "512", "*", true);
+
+  Resources volume = createDiskResource("64", "role", "id", "path");
+
+  Resources unreserved = Resources::parse("cpus:4;ports:[1-10]").get();
+
+  const Resources total = reserved + revocable + volume + unreserved;
+
+  EXPECT_EQ(total.reserved("role"), Resources(total).reserved("role"));
+  EXPECT_EQ(total.unreserved(), Resources(total).unreserved());
+  EXPECT_EQ(total.revocable(), Resources(total).revocable());
+  EXPECT_EQ(total.persistentVolumes(), Resources(total).persistentVolumes());
+  EXPECT_EQ(total.scalars(), Resources(total).scalars());
+  EXPECT_EQ(total.flatten(), Resources(total).flatten());
+
+  // Flattening combines the reserved and unreserved cpus.
+  EXPECT_EQ(
+      Resources::parse("cpus:6").get(),
+      Resources(total).flatten().get("cpus"));
+
+  EXPECT_EQ(total - volume, Resources(total) - volume);
+  EXPECT_EQ(total + unreserved, Resources(total) + unreserved);
+
+  Resources sum;
+  sum += Resources(reserved);
+  sum += Resources(revocable);
+  sum += Resources(volume);
+  sum += Resources(unreserved);
+  EXPECT_EQ(total, sum);
+
+  Resource cpus = Resources::parse("cpus", "1", "*").get();
+  sum += Resource(cpus);
+  EXPECT_EQ(total + cpus, sum);
+
+  Resources moved = std::move(sum);
+  EXPECT_EQ(total + cpus, moved);
+
+  sum = std::move(moved);
+  EXPECT_EQ(total + cpus, sum);
+}
+
+
+// Checks that the compact resources used internally by the allocator
+// have the same semantics as 'Resources'.
+TEST(CompactResourcesTest, Arithmetic)
+{
+  CompactResources::Index index;
+
+  Resource revocable = Resources::parse("cpus", "2", "*").get();
+  revocable.mutable_revocable();
+
+  Resource volume = Resources::parse("disk", "5", "role1").get();
+  volume.mutable_disk()->mutable_persistence()->set_id("ID");
+  volume.mutable_disk()->mutable_volume()->set_container_path("data");
+
+  Resources reserved = Resources::parse("cpus:1;mem:512").get();
+  reserved = reserved.flatten("role1", createReservationInfo("ops"));
+
+  Resources total = Resources::parse(
+      "cpus:4;mem:1024;disk:100;ports:[31000-32000];"
+      "cpus(role1):2;mem(role1):256").get();
+
+  total += revocable;
+  total += volume;
+  total += reserved;
+
+  Resources allocated = Resources::parse(
+      "cpus:1.5;mem:2048;ports:[31000-31500];cpus(role1):2").get();
+
+  allocated += volume;
+
+  CompactResources compactTotal(&index, total);
+  CompactResources compactAllocated(&index, allocated);
+
+  EXPECT_EQ(total, compactTotal.resources());
+  EXPECT_EQ(allocated, compactAllocated.resources());
+
+  // Subtracting more than is available drops the resource.
+  Resources available = total - allocated;
+  CompactResources compactAvailable = compactTotal - compactAllocated;
+
+  EXPECT_EQ(available, compactAvailable.resources());
+  EXPECT_EQ(total + allocated, (compactTotal + compactAllocated).resources());
+
+  EXPECT_TRUE(compactTotal.contains(compactAvailable));
+  EXPECT_FALSE(compactAvailable.contains(compactTotal));
+  EXPECT_FALSE(compactTotal.contains(compactAllocated));
+
+  EXPECT_EQ(available.unreserved(),
+            compactAvailable.unreserved().resources());
+  EXPECT_EQ(available.reserved("role1"),
+            compactAvailable.reserved("role1").resources());
+  EXPECT_EQ(available.revocable(),
+            compactAvailable.revocable().resources());
+
+  EXPECT_EQ(available.cpus(), compactAvailable.cpus());
+  EXPECT_EQ(available.mem(), compactAvailable.mem());
+
+  EXPECT_EQ(compactTotal,
+            (compactTotal - compactAvailable) + compactAvailable);
+
+  // Default constructed resources take on the index of the others.
+  CompactResources empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(compactTotal, empty + compactTotal);
+  EXPECT_TRUE((empty - compactTotal).empty());
+
+  empty += compactAllocated;
+  EXPECT_EQ(allocated, empty.resources());
+}
+
+
+// Checks that subtracting compact resources updates the quantities
+// by what was actually removed, i.e., that they stay equal to the
+// quantities of the result.
+TEST(CompactResourcesTest, SubtractQuantities)
+{
+  CompactResources::Index index;
+
+  Resource volume = Resources::parse("disk", "5", "role1").get();
+  volume.mutable_disk()->mutable_persistence()->set_id("ID");
+
+  Resources total = Resources::parse(
+      "cpus:4;mem:1024;disk:100;cpus(role1):2").get();
+
+  total += volume;
+
+  // Subtracts more 'mem' than is available, 'gpus' that are not
+  // available at all, and the persistent volume.
+  Resources subtracted = Resources::parse(
+      "cpus:1;mem:2048;cpus(role1):2;gpus:1").get();
+
+  subtracted += volume;
+
+  CompactResources compact(&index, total);
+
+  vector<double> quantities;
+  compact.sum(&quantities);
+
+  compact.subtract(CompactResources(&index, subtracted), &quantities);
+
+  EXPECT_EQ(total - subtracted, compact.resources());
+
+  vector<double> expected;
+  compact.sum(&expected);
+  expected.resize(quantities.size(), 0.0);
+
+  EXPECT_EQ(expected, quantities);
+  EXPECT_EQ(3.0, quantities[index.name("cpus")]);
+  EXPECT_EQ(0.0, quantities[index.name("mem")]);
+  EXPECT_EQ(100.0, quantities[index.name("disk")]);
+}
+
+
+class Resources_BENCHMARK_Test : public WithParamInterface<size_t>,
+                                 public ::testing::Test {};
+
+
+// The resources benchmark tests are parameterized by the number of
+// roles (or persistent volumes).
+INSTANTIATE_TEST_CASE_P(
+    ResourceCount,
+    Resources_BENCHMARK_Test,
+    ::testing::Values(10U, 100U, 1000U));
+
+
+// Measures arithmetic on resources with a static and a dynamic
+// reservation for each role, as on a slave shared by many roles.
+TEST_P(Resources_BENCHMARK_Test, Reserved)
+{
+  const size_t roleCount = GetParam();
+  const size_t iterations = 10000 / roleCount + 1;
+
+  Resources reserved;
+  for (size_t i = 0; i < roleCount; i++) {
+    const string role = "role" + stringify(i);
+
+    reserved += Resources::parse(
+        "cpus(" + role + "):1;mem(" + role + "):128;"
+        "ports(" + role + "):[" + stringify(10000 + i) + "-" +
+        stringify(10000 + i) + "]").get();
+
+    reserved += createReservedResource(
+        "disk", "1024", role, createReservationInfo("principal"));
+  }
+
+  Resources total = reserved + reserved;
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    Resources result = total;
+    result -= reserved;
+    result += reserved;
+    EXPECT_TRUE(result.contains(reserved));
+  }
+
+  cout << "Added, subtracted and checked " << roleCount
+       << " reserved resources " << iterations << " times in "
+       << watch.elapsed() << endl;
+}
+
+
+// Measures arithmetic on resources with many persistent volumes,
+// which can not be merged with each other.
+TEST_P(Resources_BENCHMARK_Test, PersistentVolumes)
+{
+  const size_t volumeCount = GetParam();
+  const size_t iterations = 10000 / volumeCount + 1;
+
+  Resources volumes;
+  for (size_t i = 0; i < volumeCount; i++) {
+    volumes += createDiskResource("64", "role", "id" + stringify(i), "path");
+  }
+
+  Resources total = volumes + Resources::parse("cpus:8;mem:4096").get();
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    Resources result = total;
+    result -= volumes;
+    result += volumes;
+    EXPECT_TRUE(result.contains(volumes));
+  }
+
+  cout << "Added, subtracted and checked " << volumeCount
+       << " persistent volumes " << iterations << " times in "
+       << watch.elapsed() << endl;
+}
+
+
+// Measures arithmetic on highly fragmented port ranges, as on a slave
+// that has run many short tasks with a port each.
+TEST_P(Resources_BENCHMARK_Test, FragmentedPorts)
+{
+  const size_t rangeCount = GetParam();
+  const size_t iterations = 10000 / rangeCount + 1;
+
+  // Every other port is in use, which leaves 'rangeCount' ranges of
+  // a single port each.
+  Value::Ranges available;
+  Value::Ranges used;
+  for (size_t i = 0; i < rangeCount; i++) {
+    Value::Range* range = available.add_range();
+    range->set_begin(31000 + 2 * i);
+    range->set_end(31000 + 2 * i);
+
+    range = used.add_range();
+    range->set_begin(31000 + 2 * i + 1);
+    range->set_end(31000 + 2 * i + 1);
+  }
+
+  Resource ports = Resources::parse("ports", "[31000-31000]", "*").get();
+  ports.mutable_ranges()->CopyFrom(available);
+
+  const Resources total = ports;
+
+  ports.mutable_ranges()->CopyFrom(used);
+
+  const Resources allocated = ports;
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    // The used ports fill the gaps, which coalesces them into a
+    // single range, and subtracting them fragments it again.
+    Resources result = total + allocated;
+    EXPECT_TRUE(result.contains(allocated));
+
+    result -= allocated;
+    EXPECT_EQ(total, result);
+  }
+
+  cout << "Added, checked and subtracted " << rangeCount
+       << " fragmented port ranges " << iterations << " times in "
+       << watch.elapsed() << endl;
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
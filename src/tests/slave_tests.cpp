@@ -37,6 +37,7 @@
 #include <process/pid.hpp>
 #include <process/subprocess.hpp>
 
+#include <stout/hashmap.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
 #include <stout/try.hpp>
@@ -51,6 +52,7 @@
 #include "slave/constants.hpp"
 #include "slave/gc.hpp"
 #include "slave/flags.hpp"
+#include "slave/http.pb.h"
 #include "slave/slave.hpp"
 
 #include "slave/containerizer/fetcher.hpp"
@@ -1186,6 +1188,96 @@ TEST_F(SlaveTest, StateEndpoint)
 }
 
 
+// This test verifies that the state is served as a protobuf message
+// to clients that accept 'application/x-protobuf'.
+TEST_F(SlaveTest, StateEndpointProtobuf)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+
+  Try<PID<Slave>> slave = StartSlave(&exec);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(frameworkId);
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskInfo task = createTask(offers.get()[0], "", DEFAULT_EXECUTOR_ID);
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status.get().state());
+
+  hashmap<string, string> headers;
+  headers["Accept"] = APPLICATION_PROTOBUF;
+
+  Future<process::http::Response> response =
+    process::http::get(slave.get(), "state.json", None(), headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(process::http::OK().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(
+      APPLICATION_PROTOBUF,
+      "Content-Type",
+      response);
+
+  mesos::internal::slave::StateResponse state;
+  ASSERT_TRUE(state.ParseFromString(response.get().body));
+
+  EXPECT_EQ(MESOS_VERSION, state.version());
+  EXPECT_EQ(offers.get()[0].slave_id().value(), state.id());
+  EXPECT_EQ(stringify(slave.get()), state.pid());
+  EXPECT_NE(0, state.flags_size());
+
+  ASSERT_EQ(1, state.frameworks_size());
+  EXPECT_EQ(frameworkId.get(), state.frameworks(0).info().id());
+
+  ASSERT_EQ(1, state.frameworks(0).executors_size());
+  EXPECT_EQ(
+      task.executor().executor_id(),
+      state.frameworks(0).executors(0).info().executor_id());
+
+  ASSERT_EQ(1, state.frameworks(0).executors(0).tasks_size());
+  EXPECT_EQ(
+      task.task_id(),
+      state.frameworks(0).executors(0).tasks(0).task_id());
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
 // This test ensures that when a slave is shutting down, it will not
 // try to re-register with the master.
 TEST_F(SlaveTest, TerminatingSlaveDoesNotReregister)
@@ -21,21 +21,33 @@
 
 #include <gmock/gmock.h>
 
+#include <iostream>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <mesos/resources.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/gtest.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
 
+#include "master/allocator/sorter/drf/incremental.hpp"
 #include "master/allocator/sorter/drf/sorter.hpp"
 
 #include "tests/mesos.hpp"
 
 using mesos::internal::master::allocator::DRFSorter;
+using mesos::internal::master::allocator::IncrementalDRFSorter;
 
+using std::cout;
+using std::endl;
 using std::list;
 using std::string;
+using std::vector;
+
+using testing::WithParamInterface;
 
 namespace mesos {
 namespace internal {
@@ -449,6 +461,279 @@ TEST(SorterTest, RevocableResources)
   EXPECT_EQ("b", sorted.back());
 }
 
+
+// This test ensures that the IncrementalDRFSorter orders its clients
+// exactly like the DRFSorter, across allocations, deactivations,
+// removals and changes to the total resources.
+TEST(SorterTest, IncrementalDRFSorterMatchesDRFSorter)
+{
+  DRFSorter drf;
+  IncrementalDRFSorter incremental;
+
+  SlaveID slaveA;
+  slaveA.set_value("slaveA");
+
+  SlaveID slaveB;
+  slaveB.set_value("slaveB");
+
+  drf.add(slaveA, Resources::parse("cpus:100;mem:1000").get());
+  incremental.add(slaveA, Resources::parse("cpus:100;mem:1000").get());
+
+  for (int i = 0; i < 10; i++) {
+    drf.add(stringify(i), i % 3 + 1);
+    incremental.add(stringify(i), i % 3 + 1);
+  }
+
+  EXPECT_EQ(drf.sort(), incremental.sort());
+
+  for (int i = 0; i < 50; i++) {
+    const string client = stringify((i * 7) % 10);
+    const Resources resources = Resources::parse(
+        "cpus:" + stringify(i % 4 + 1) + ";mem:" + stringify(i % 5)).get();
+
+    drf.allocated(client, slaveA, resources);
+    incremental.allocated(client, slaveA, resources);
+
+    EXPECT_EQ(drf.sort(), incremental.sort());
+
+    if (i % 5 == 0) {
+      drf.unallocated(client, slaveA, resources);
+      incremental.unallocated(client, slaveA, resources);
+
+      EXPECT_EQ(drf.sort(), incremental.sort());
+    }
+  }
+
+  drf.deactivate("3");
+  incremental.deactivate("3");
+
+  EXPECT_EQ(drf.sort(), incremental.sort());
+
+  drf.add(slaveB, Resources::parse("cpus:10;mem:5000").get());
+  incremental.add(slaveB, Resources::parse("cpus:10;mem:5000").get());
+
+  EXPECT_EQ(drf.sort(), incremental.sort());
+
+  drf.activate("3");
+  incremental.activate("3");
+
+  drf.remove("5");
+  incremental.remove("5");
+
+  EXPECT_EQ(drf.sort(), incremental.sort());
+
+  drf.update(slaveA, Resources::parse("cpus:50;mem:1000").get());
+  incremental.update(slaveA, Resources::parse("cpus:50;mem:1000").get());
+
+  EXPECT_EQ(drf.sort(), incremental.sort());
+
+  EXPECT_EQ(drf.count(), incremental.count());
+  EXPECT_EQ(drf.allocation("0"), incremental.allocation("0"));
+  EXPECT_EQ(drf.allocation("0", slaveA), incremental.allocation("0", slaveA));
+  EXPECT_FALSE(incremental.contains("5"));
+}
+
+
+// This test ensures that the IncrementalDRFSorter, which only updates
+// the shares of the clients holding resources whose totals changed,
+// orders its clients like the DRFSorter when slaves are added along
+// with allocations, as done by the hierarchical allocator.
+TEST(SorterTest, IncrementalDRFSorterChangingTotal)
+{
+  DRFSorter drf;
+  IncrementalDRFSorter incremental;
+
+  for (int i = 0; i < 6; i++) {
+    drf.add(stringify(i));
+    incremental.add(stringify(i));
+  }
+
+  // Some clients only get 'cpus', others only 'mem', so that not all
+  // of their shares change along with the totals.
+  const Resources cpus = Resources::parse("cpus:2").get();
+  const Resources mem = Resources::parse("mem:512").get();
+  const Resources both = Resources::parse("cpus:1;mem:256").get();
+
+  for (int i = 0; i < 30; i++) {
+    SlaveID slaveId;
+    slaveId.set_value("slave" + stringify(i));
+
+    const Resources& resources = i % 3 == 0 ? cpus : (i % 3 == 1 ? mem : both);
+    const string client = stringify((i * 5) % 6);
+
+    drf.add(slaveId, resources);
+    incremental.add(slaveId, resources);
+
+    drf.allocated(client, slaveId, resources);
+    incremental.allocated(client, slaveId, resources);
+
+    EXPECT_EQ(drf.sort(), incremental.sort());
+
+    if (i % 4 == 0) {
+      drf.unallocated(client, slaveId, resources);
+      incremental.unallocated(client, slaveId, resources);
+
+      drf.remove(slaveId, resources);
+      incremental.remove(slaveId, resources);
+
+      EXPECT_EQ(drf.sort(), incremental.sort());
+    }
+  }
+}
+
+
+// This test verifies that the ordering returned by 'order()' is not
+// affected by allocations until it is requested again.
+TEST(SorterTest, IncrementalDRFSorterOrder)
+{
+  IncrementalDRFSorter sorter;
+
+  SlaveID slaveId;
+  slaveId.set_value("slaveId");
+
+  sorter.add(slaveId, Resources::parse("cpus:100;mem:100").get());
+
+  sorter.add("a");
+  sorter.add("b");
+  sorter.add("c");
+
+  sorter.allocated("a", slaveId, Resources::parse("cpus:5;mem:5").get());
+  sorter.allocated("b", slaveId, Resources::parse("cpus:1;mem:1").get());
+
+  // shares: a = .05, b = .01, c = 0
+  const vector<IncrementalDRFSorter::Handle>& order = sorter.order();
+  ASSERT_EQ(3u, order.size());
+
+  vector<string> names;
+  foreach (IncrementalDRFSorter::Handle handle, order) {
+    names.push_back(sorter.name(handle));
+
+    // Allocating while iterating must not change the view.
+    sorter.allocated(
+        sorter.name(handle), slaveId, Resources::parse("cpus:10").get());
+  }
+
+  EXPECT_EQ(vector<string>({"c", "b", "a"}), names);
+
+  // shares: a = .15, b = .11, c = .1
+  EXPECT_EQ(list<string>({"c", "b", "a"}), sorter.sort());
+
+  ASSERT_SOME(sorter.handle("b"));
+  EXPECT_EQ("b", sorter.name(sorter.handle("b").get()));
+  EXPECT_NONE(sorter.handle("d"));
+
+  // Handles of removed clients get reused.
+  IncrementalDRFSorter::Handle handle = sorter.handle("b").get();
+  sorter.remove("b");
+  sorter.add("d");
+
+  ASSERT_SOME_EQ(handle, sorter.handle("d"));
+  EXPECT_EQ(list<string>({"d", "c", "a"}), sorter.sort());
+}
+
+
+class Sorter_BENCHMARK_Test : public WithParamInterface<size_t>,
+                              public ::testing::Test {};
+
+
+// The sorter benchmark tests are parameterized by the number of
+// clients.
+INSTANTIATE_TEST_CASE_P(
+    ClientCount,
+    Sorter_BENCHMARK_Test,
+    ::testing::Values(1000U, 3000U, 5000U));
+
+
+// Simulates an allocation cycle as done by the hierarchical
+// allocator for the frameworks of a role: for each slave the clients
+// are sorted, and the client with the lowest share is allocated the
+// whole slave, which is added to the total resources of the sorter
+// at the same time. Half of the clients are already running on other
+// slaves. This compares the DRFSorter with the IncrementalDRFSorter.
+template <typename S, typename F>
+static Duration allocationCycle(
+    S* sorter,
+    const vector<SlaveID>& slaves,
+    const vector<string>& clients,
+    const Resources& resources,
+    const F& lowest)
+{
+  foreach (const string& client, clients) {
+    sorter->add(client);
+  }
+
+  for (size_t i = 0; i < clients.size(); i += 2) {
+    SlaveID slaveId;
+    slaveId.set_value("running" + stringify(i));
+
+    sorter->add(slaveId, resources);
+    sorter->allocated(clients[i], slaveId, resources);
+  }
+
+  Stopwatch watch;
+  watch.start();
+
+  foreach (const SlaveID& slaveId, slaves) {
+    const string client = lowest(sorter);
+
+    sorter->add(slaveId, resources);
+    sorter->allocated(client, slaveId, resources);
+  }
+
+  return watch.elapsed();
+}
+
+
+TEST_P(Sorter_BENCHMARK_Test, AllocationCycle)
+{
+  const size_t clientCount = GetParam();
+  const size_t slaveCount = 1000;
+
+  const Resources resources = Resources::parse("cpus:2;mem:1024").get();
+
+  vector<SlaveID> slaves;
+  for (size_t i = 0; i < slaveCount; i++) {
+    SlaveID slaveId;
+    slaveId.set_value("slave" + stringify(i));
+    slaves.push_back(slaveId);
+  }
+
+  vector<string> clients;
+  for (size_t i = 0; i < clientCount; i++) {
+    clients.push_back("framework" + stringify(i));
+  }
+
+  {
+    DRFSorter sorter;
+
+    Duration elapsed = allocationCycle(
+        &sorter,
+        slaves,
+        clients,
+        resources,
+        [](DRFSorter* sorter) { return sorter->sort().front(); });
+
+    cout << "DRFSorter allocated " << slaveCount << " slaves to "
+         << clientCount << " clients in " << elapsed << endl;
+  }
+
+  {
+    IncrementalDRFSorter sorter;
+
+    Duration elapsed = allocationCycle(
+        &sorter,
+        slaves,
+        clients,
+        resources,
+        [](IncrementalDRFSorter* sorter) {
+          return sorter->name(sorter->order().front());
+        });
+
+    cout << "IncrementalDRFSorter allocated " << slaveCount << " slaves to "
+         << clientCount << " clients in " << elapsed << endl;
+  }
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -16,6 +16,7 @@
  * limitations under the License.
  */
 
+#include <limits>
 #include <sstream>
 #include <string>
 
@@ -102,6 +103,115 @@ TEST(ValuesTest, SetSubtraction)
   EXPECT_EQ(set3, parse("{sda4}").get().set());
 }
 
+
+TEST(ValuesTest, RangesAddition)
+{
+  Value::Ranges ranges = parse("[1-10, 20-30]").get().ranges();
+
+  // Overlapping and adjacent ranges are coalesced.
+  ranges += parse("[5-15, 31-40]").get().ranges();
+
+  EXPECT_EQ(parse("[1-15, 20-40]").get().ranges(), ranges);
+  EXPECT_EQ(2, ranges.range_size());
+
+  // Un-coalesced ranges are equal to their coalesced form,
+  // independent of their order.
+  EXPECT_EQ(
+      parse("[20-40, 1-15]").get().ranges(),
+      parse("[1-5, 30-40, 6-15, 20-29]").get().ranges());
+
+  EXPECT_FALSE(
+      parse("[1-15, 20-40]").get().ranges() ==
+      parse("[1-15, 21-40]").get().ranges());
+}
+
+
+TEST(ValuesTest, RangesSubtraction)
+{
+  Value::Ranges ranges = parse("[1-100]").get().ranges();
+
+  // Subtracting from the middle of a range splits it.
+  ranges -= parse("[10-19, 50-50]").get().ranges();
+
+  EXPECT_EQ(parse("[1-9, 20-49, 51-100]").get().ranges(), ranges);
+
+  // Subtracting ranges that are not contained only removes the
+  // overlapping parts.
+  ranges -= parse("[0-1, 45-55, 100-200]").get().ranges();
+
+  EXPECT_EQ(parse("[2-9, 20-44, 56-99]").get().ranges(), ranges);
+
+  ranges -= parse("[0-1000]").get().ranges();
+
+  EXPECT_EQ(0, ranges.range_size());
+}
+
+
+TEST(ValuesTest, RangesContains)
+{
+  Value::Ranges ranges = parse("[1-9, 20-44, 56-99]").get().ranges();
+
+  EXPECT_TRUE(parse("[1-1, 3-9, 56-99]").get().ranges() <= ranges);
+  EXPECT_TRUE(ranges <= ranges);
+  EXPECT_FALSE(parse("[9-20]").get().ranges() <= ranges);
+  EXPECT_FALSE(parse("[100-100]").get().ranges() <= ranges);
+
+  // Adjacent ranges are coalesced before checking containment.
+  EXPECT_TRUE(
+      parse("[5-15]").get().ranges() <= parse("[1-10, 11-20]").get().ranges());
+}
+
+// This test verifies that ranges ending at the largest value are
+// not dropped by the range arithmetic.
+TEST(ValuesTest, RangesUpperEdge)
+{
+  const uint64_t max = std::numeric_limits<uint64_t>::max();
+
+  Value::Ranges edge;
+  Value::Range* range = edge.add_range();
+  range->set_begin(max - 10);
+  range->set_end(max);
+
+  Value::Ranges ranges = parse("[1-10]").get().ranges();
+  ranges += edge;
+
+  ASSERT_EQ(2, ranges.range_size());
+  EXPECT_EQ(1u, ranges.range(0).begin());
+  EXPECT_EQ(10u, ranges.range(0).end());
+  EXPECT_EQ(max - 10, ranges.range(1).begin());
+  EXPECT_EQ(max, ranges.range(1).end());
+
+  EXPECT_TRUE(edge <= ranges);
+  EXPECT_FALSE(ranges <= parse("[1-10]").get().ranges());
+  EXPECT_FALSE(ranges == parse("[1-10]").get().ranges());
+
+  // Subtracting all but the largest value leaves only that value.
+  Value::Ranges below;
+  range = below.add_range();
+  range->set_begin(0);
+  range->set_end(max - 1);
+
+  ranges -= below;
+
+  ASSERT_EQ(1, ranges.range_size());
+  EXPECT_EQ(max, ranges.range(0).begin());
+  EXPECT_EQ(max, ranges.range(0).end());
+
+  // Adding the adjacent value coalesces it with the largest value.
+  Value::Range* adjacent = below.mutable_range(0);
+  adjacent->set_begin(max - 1);
+
+  ranges += below;
+
+  ASSERT_EQ(1, ranges.range_size());
+  EXPECT_EQ(max - 1, ranges.range(0).begin());
+  EXPECT_EQ(max, ranges.range(0).end());
+
+  ranges -= edge;
+
+  EXPECT_EQ(0, ranges.range_size());
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {